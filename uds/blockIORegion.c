@@ -237,6 +237,27 @@ static int bior_read(IORegion *region,
   return result;
 }
 
+/*****************************************************************************/
+static void bior_readAsync(IORegion  *region,
+                           off_t      offset,
+                           void      *buffer,
+                           size_t     size,
+                           AsyncRead *read)
+{
+  BlockIORegion *bior = asBlockIORegion(region);
+
+  size_t len = size;
+
+  int result = validateIO(bior, offset, size, &len, IO_READ);
+  if (result != UDS_SUCCESS) {
+    read->result = result;
+    read->callback(read);
+    return;
+  }
+
+  readFromRegionAsync(bior->parent, bior->start + offset, buffer, len, read);
+}
+
 /*****************************************************************************/
 static int bior_getBlockSize(IORegion *region, size_t *blockSize)
 {
@@ -322,6 +343,7 @@ int openBlockRegion(IORegion       *parent,
   bior->common.getDataSize  = bior_getDataSize;
   bior->common.getLimit     = bior_getLimit;
   bior->common.read         = bior_read;
+  bior->common.readAsync    = bior_readAsync;
   bior->common.syncContents = bior_syncContents;
   bior->common.write        = bior_write;
   bior->parent    = parent;
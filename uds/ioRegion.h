@@ -26,6 +26,26 @@
 #include "typeDefs.h"
 #include "uds-error.h"
 
+typedef struct asyncRead AsyncRead;
+
+/**
+ * The type of function called when an asynchronous read finishes. It may be
+ * called in interrupt context, so it must not sleep.
+ *
+ * @param read  The finished read
+ **/
+typedef void AsyncReadCallback(AsyncRead *read);
+
+/**
+ * An asynchronous read request, which callers embed in their own structures.
+ **/
+struct asyncRead {
+  /** The function to call when the read finishes */
+  AsyncReadCallback *callback;
+  /** The result of the read, set before the callback is called */
+  int                result;
+};
+
 /**
  * The IORegion type is an abstraction which represents a specific place which
  * can be read or written. There are file-based implementations as well as
@@ -41,6 +61,7 @@ typedef struct ioRegion {
   int (*getDataSize) (struct ioRegion *, off_t *);
   int (*getLimit)    (struct ioRegion *, off_t *);
   int (*read)        (struct ioRegion *, off_t, void *, size_t, size_t *);
+  void (*readAsync)  (struct ioRegion *, off_t, void *, size_t, AsyncRead *);
   int (*syncContents)(struct ioRegion *);
   int (*write)       (struct ioRegion *, off_t, const void *, size_t, size_t);
 } IORegion;
@@ -171,6 +192,36 @@ static INLINE int readFromRegion(IORegion *region,
   return region->read(region, offset, buffer, size, length);
 }
 
+/**
+ * Start reading some data from a region into a buffer without waiting for the
+ * read to finish. Regions which can not read asynchronously do the read
+ * synchronously instead. Either way, the read's callback is called exactly
+ * once, possibly before this function returns, and any error (including an
+ * invalid offset or size) is reported only through the read's result.
+ *
+ * @param region  The IORegion.
+ * @param offset  The offset from which to read; must be aligned to the
+ *                region's block size.
+ * @param buffer  The buffer to read to, which must remain valid until the
+ *                callback is called.
+ * @param size    The size of the data buffer; must be a multiple of the
+ *                block size. The entire buffer is read.
+ * @param read    The read request, with its callback set.
+ **/
+static INLINE void readFromRegionAsync(IORegion  *region,
+                                       off_t      offset,
+                                       void      *buffer,
+                                       size_t     size,
+                                       AsyncRead *read)
+{
+  if (region->readAsync == NULL) {
+    read->result = region->read(region, offset, buffer, size, NULL);
+    read->callback(read);
+    return;
+  }
+  region->readAsync(region, offset, buffer, size, read);
+}
+
 /**
  * Force the region to be written to the backing store, if supported.
  *
@@ -197,6 +197,17 @@ static void lior_bio_init(struct bio *bio, LinuxIORegion *lior, off_t offset)
 #endif
 }
 
+/*****************************************************************************/
+static void lior_bio_issue(struct bio *bio, int rw)
+{
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,8,0)
+  bio->bi_opf = rw;
+  submit_bio(bio);
+#else
+  submit_bio(rw, bio);
+#endif
+}
+
 /*****************************************************************************/
 static int lior_bio_submit(struct bio *bio, int rw)
 {
@@ -206,12 +217,7 @@ static int lior_bio_submit(struct bio *bio, int rw)
   LinuxIOCompletion lioc = { .result = UDS_SUCCESS, .wait = &wait };
   bio->bi_end_io  = lior_endio;
   bio->bi_private = &lioc;
-#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,8,0)
-  bio->bi_opf = rw;
-  submit_bio(bio);
-#else
-  submit_bio(rw, bio);
-#endif
+  lior_bio_issue(bio, rw);
   wait_for_completion(&wait);
   return lioc.result;
 }
@@ -309,6 +315,80 @@ static int lior_read(IORegion *region,
   return result;
 }
 
+/*****************************************************************************/
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,4,0)
+static void lior_asyncEndio(struct bio *bio)
+#else
+static void lior_asyncEndio(struct bio *bio, int err)
+#endif
+{
+  AsyncRead *read = (AsyncRead *) bio->bi_private;
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,13,0)
+  read->result = -blk_status_to_errno(bio->bi_status);
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION(4,4,0)
+  read->result = -bio->bi_error;
+#else
+  read->result = -err;
+#endif
+  bio_put(bio);
+  read->callback(read);
+}
+
+/*****************************************************************************/
+static void lior_readAsync(IORegion  *region,
+                           off_t      offset,
+                           void      *buffer,
+                           size_t     size,
+                           AsyncRead *read)
+{
+  LinuxIORegion *lior = asLinuxIORegion(region);
+  size_t len = size;
+  int result = validateIO(lior, offset, buffer, size, &len, false);
+  if (result != UDS_SUCCESS) {
+    read->result = result;
+    read->callback(read);
+    return;
+  }
+
+  unsigned int bvec_count = (size + PAGE_SIZE - 1) / PAGE_SIZE;
+  if (bvec_count > UIO_MAXIOV) {
+    // Too big for a single bio, so just read it synchronously.
+    read->result = lior_io(lior, offset, buffer, size, READ);
+    read->callback(read);
+    return;
+  }
+
+  struct bio *bio = bio_alloc(GFP_KERNEL, bvec_count);
+  if (IS_ERR(bio)) {
+    read->result = logErrorWithStringError(ENOMEM,
+                                           "cannot allocate a struct bio");
+    read->callback(read);
+    return;
+  }
+  lior_bio_init(bio, lior, offset);
+
+  byte *data = buffer;
+  for (size_t remaining = size; remaining > 0;) {
+    unsigned int ioSize = remaining > PAGE_SIZE ? PAGE_SIZE : remaining;
+    struct page *page = (is_vmalloc_addr(data)
+                         ? vmalloc_to_page(data)
+                         : virt_to_page(data));
+    if (bio_add_page(bio, page, ioSize, offset_in_page(data)) == 0) {
+      // The device won't take the whole buffer in one bio.
+      bio_put(bio);
+      read->result = lior_io(lior, offset, buffer, size, READ);
+      read->callback(read);
+      return;
+    }
+    data      += ioSize;
+    remaining -= ioSize;
+  }
+
+  bio->bi_end_io  = lior_asyncEndio;
+  bio->bi_private = read;
+  lior_bio_issue(bio, READ);
+}
+
 /*****************************************************************************/
 static int lior_getBlockSize(IORegion *region, size_t *blockSize)
 {
@@ -373,6 +453,7 @@ int openLinuxRegion(const char *path, uint64_t size, IORegion **regionPtr)
   lior->common.getDataSize  = lior_getDataSize;
   lior->common.getLimit     = lior_getLimit;
   lior->common.read         = lior_read;
+  lior->common.readAsync    = lior_readAsync;
   lior->common.syncContents = lior_syncContents;
   lior->common.write        = lior_write;
   lior->bdev      = bdev;
@@ -50,6 +50,29 @@ int allocateMemory(size_t size, size_t align, const char *what, void *ptr)
  **/
 void freeMemory(void *ptr);
 
+/**
+ * Allocate a large, page-aligned region which will be used mostly from one
+ * NUMA node. Physically contiguous memory on that node is preferred, since the
+ * kernel maps it with huge pages; if none is available the region falls back
+ * to page-mapped memory on the node. The memory will be zeroed.
+ *
+ * @param size  The size of the region
+ * @param node  The preferred NUMA node, or ANY_MEMORY_NODE
+ * @param what  What is being allocated (for error logging)
+ * @param ptr   A pointer to hold the allocated memory
+ *
+ * @return UDS_SUCCESS or an error code
+ **/
+int allocateLargeMemory(size_t size, int node, const char *what, void *ptr)
+  __attribute__((warn_unused_result));
+
+/**
+ * Free a region allocated by allocateLargeMemory().
+ *
+ * @param ptr  The memory to be freed
+ **/
+void freeLargeMemory(void *ptr);
+
 /**
  * Allocate storage and do a vsprintf into it.  The memory allocation part of
  * this operation is platform dependent.
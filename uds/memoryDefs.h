@@ -23,6 +23,7 @@
 #define LINUX_KERNEL_MEMORY_DEFS_H 1
 
 #include <linux/io.h>  // for PAGE_SIZE
+#include <linux/numa.h>
 
 #include "compiler.h"
 #include "threadRegistry.h"
@@ -43,6 +44,11 @@
 #define ALLOCATE_IO_ALIGNED(COUNT, TYPE, WHAT, PTR) \
   doAllocation(COUNT, sizeof(TYPE), 0, PAGE_SIZE, WHAT, PTR)
 
+/**
+ * The node to pass to allocateLargeMemory() when any NUMA node will do.
+ **/
+#define ANY_MEMORY_NODE NUMA_NO_NODE
+
 /**
  * Allocate one element of the indicated type immediately, failing if the
  * required memory is not immediately available.
@@ -135,6 +141,16 @@ void getMemoryStats(uint64_t *bytesUsed,
                     uint64_t *biosUsed,
                     uint64_t *peakBioCount);
 
+/**
+ * Get the statistics for regions allocated by allocateLargeMemory().
+ *
+ * @param contiguousBytes  A pointer to hold the number of bytes in regions
+ *                         which got physically contiguous memory
+ * @param fallbackBytes    A pointer to hold the number of bytes in regions
+ *                         which fell back to page-mapped memory
+ **/
+void getLargeMemoryStats(uint64_t *contiguousBytes, uint64_t *fallbackBytes);
+
 /**
  * Report stats on any allocated memory that we're tracking.
  *
@@ -88,22 +88,41 @@ typedef struct vmallocBlockInfo {
   struct vmallocBlockInfo *next;
 } VmallocBlockInfo;
 
+// Regions from allocateLargeMemory() are tracked separately, since freeing
+// them requires knowing how they were allocated.
+typedef struct largeBlockInfo {
+  void                  *ptr;
+  size_t                 size;
+  bool                   contiguous;
+  struct largeBlockInfo *next;
+} LargeBlockInfo;
+
 static struct {
   spinlock_t        lock;
   size_t            kmallocBlocks;
   size_t            kmallocBytes;
   size_t            vmallocBlocks;
   size_t            vmallocBytes;
+  size_t            contiguousBytes;
+  size_t            fallbackBytes;
   size_t            peakBytes;
   size_t            bioCount;
   size_t            peakBioCount;
   VmallocBlockInfo *vmallocList;
+  LargeBlockInfo   *largeList;
 } memoryStats __cacheline_aligned;
 
+/*****************************************************************************/
+static size_t getTotalBytes(void)
+{
+  return (memoryStats.kmallocBytes + memoryStats.vmallocBytes
+          + memoryStats.contiguousBytes + memoryStats.fallbackBytes);
+}
+
 /*****************************************************************************/
 static void updatePeakUsage(void)
 {
-  size_t totalBytes = memoryStats.kmallocBytes + memoryStats.vmallocBytes;
+  size_t totalBytes = getTotalBytes();
   if (totalBytes > memoryStats.peakBytes) {
     memoryStats.peakBytes = totalBytes;
   }
@@ -322,6 +341,140 @@ int allocateMemory(size_t size, size_t align, const char *what, void *ptr)
   return UDS_SUCCESS;
 }
 
+/*****************************************************************************/
+static void addLargeBlock(LargeBlockInfo *block)
+{
+  unsigned long flags;
+  spin_lock_irqsave(&memoryStats.lock, flags);
+  block->next = memoryStats.largeList;
+  memoryStats.largeList = block;
+  if (block->contiguous) {
+    memoryStats.contiguousBytes += block->size;
+  } else {
+    memoryStats.fallbackBytes += block->size;
+  }
+  updatePeakUsage();
+  spin_unlock_irqrestore(&memoryStats.lock, flags);
+}
+
+/*****************************************************************************/
+static LargeBlockInfo *removeLargeBlock(void *ptr)
+{
+  LargeBlockInfo *block, **blockPtr;
+  unsigned long flags;
+  spin_lock_irqsave(&memoryStats.lock, flags);
+  for (blockPtr = &memoryStats.largeList;
+       (block = *blockPtr) != NULL;
+       blockPtr = &block->next) {
+    if (block->ptr == ptr) {
+      *blockPtr = block->next;
+      if (block->contiguous) {
+        memoryStats.contiguousBytes -= block->size;
+      } else {
+        memoryStats.fallbackBytes -= block->size;
+      }
+      break;
+    }
+  }
+  spin_unlock_irqrestore(&memoryStats.lock, flags);
+  return block;
+}
+
+/**
+ * Determine whether a large region is small enough to try to get it from the
+ * page allocator as one physically contiguous run of pages.
+ *
+ * @param size  The page-aligned size of the region
+ **/
+static INLINE bool mayBeContiguous(size_t size)
+{
+#ifdef MAX_PAGE_ORDER
+  return get_order(size) <= MAX_PAGE_ORDER;
+#else
+  return get_order(size) < MAX_ORDER;
+#endif
+}
+
+/*****************************************************************************/
+int allocateLargeMemory(size_t size, int node, const char *what, void *ptr)
+{
+  if (ptr == NULL) {
+    return UDS_INVALID_ARGUMENT;
+  }
+  if (size == 0) {
+    *((void **) ptr) = NULL;
+    return UDS_SUCCESS;
+  }
+
+  LargeBlockInfo *block;
+  int result = ALLOCATE(1, LargeBlockInfo, __func__, &block);
+  if (result != UDS_SUCCESS) {
+    return result;
+  }
+
+  bool allocationsRestricted = !allocationsAllowed();
+  unsigned int noioFlags;
+  if (allocationsRestricted) {
+    noioFlags = memalloc_noio_save();
+  }
+
+  size_t  alignedSize = PAGE_ALIGN(size);
+  void   *p           = NULL;
+  if (mayBeContiguous(alignedSize)) {
+    /*
+     * The page allocator's memory lives in the kernel's linear mapping, which
+     * uses huge pages, so a contiguous region needs few TLB entries. Don't try
+     * hard, though: compaction for this is worse than the fallback.
+     */
+    p = alloc_pages_exact_nid(node, alignedSize,
+                              GFP_KERNEL | __GFP_ZERO | __GFP_NOWARN
+                              | __GFP_NORETRY);
+  }
+  block->contiguous = (p != NULL);
+  if (p == NULL) {
+    p = vzalloc_node(alignedSize, node);
+  }
+
+  if (allocationsRestricted) {
+    memalloc_noio_restore(noioFlags);
+  }
+
+  if (p == NULL) {
+    FREE(block);
+    logError("Could not allocate %zu bytes for %s on node %d",
+             size, what, node);
+    return ENOMEM;
+  }
+
+  block->ptr  = p;
+  block->size = alignedSize;
+  addLargeBlock(block);
+  *((void **) ptr) = p;
+  return UDS_SUCCESS;
+}
+
+/*****************************************************************************/
+void freeLargeMemory(void *ptr)
+{
+  if (ptr == NULL) {
+    return;
+  }
+
+  LargeBlockInfo *block = removeLargeBlock(ptr);
+  if (block == NULL) {
+    logInfo("attempting to remove ptr %" PRIptr " not found in large list",
+            ptr);
+    return;
+  }
+
+  if (block->contiguous) {
+    free_pages_exact(ptr, block->size);
+  } else {
+    vfree(ptr);
+  }
+  FREE(block);
+}
+
 /*****************************************************************************/
 void *allocateMemoryNowait(size_t      size,
                            const char *what __attribute__((unused)))
@@ -415,6 +568,10 @@ void memoryExit(void)
                   "vmalloc memory used (%zd bytes in %zd blocks)"
                   " is returned to the kernel",
                   memoryStats.vmallocBytes, memoryStats.vmallocBlocks);
+  ASSERT_LOG_ONLY(memoryStats.largeList == NULL,
+                  "large memory used (%zd contiguous, %zd fallback bytes)"
+                  " is returned to the kernel",
+                  memoryStats.contiguousBytes, memoryStats.fallbackBytes);
   logDebug("%s peak usage %zd bytes", THIS_MODULE->name,
            memoryStats.peakBytes);
 
@@ -456,13 +613,23 @@ void getMemoryStats(uint64_t *bytesUsed,
 {
   unsigned long flags;
   spin_lock_irqsave(&memoryStats.lock, flags);
-  *bytesUsed     = memoryStats.kmallocBytes + memoryStats.vmallocBytes;
+  *bytesUsed     = getTotalBytes();
   *peakBytesUsed = memoryStats.peakBytes;
   *biosUsed      = memoryStats.bioCount;
   *peakBioCount  = memoryStats.peakBioCount;
   spin_unlock_irqrestore(&memoryStats.lock, flags);
 }
 
+/**********************************************************************/
+void getLargeMemoryStats(uint64_t *contiguousBytes, uint64_t *fallbackBytes)
+{
+  unsigned long flags;
+  spin_lock_irqsave(&memoryStats.lock, flags);
+  *contiguousBytes = memoryStats.contiguousBytes;
+  *fallbackBytes   = memoryStats.fallbackBytes;
+  spin_unlock_irqrestore(&memoryStats.lock, flags);
+}
+
 /**********************************************************************/
 void reportMemoryUsage()
 {
@@ -472,17 +639,21 @@ void reportMemoryUsage()
   uint64_t kmallocBytes = memoryStats.kmallocBytes;
   uint64_t vmallocBlocks = memoryStats.vmallocBlocks;
   uint64_t vmallocBytes = memoryStats.vmallocBytes;
+  uint64_t contiguousBytes = memoryStats.contiguousBytes;
+  uint64_t fallbackBytes = memoryStats.fallbackBytes;
+  uint64_t totalBytes = getTotalBytes();
   uint64_t peakUsage = memoryStats.peakBytes;
   uint64_t bioCount = memoryStats.bioCount;
   uint64_t peakBioCount = memoryStats.peakBioCount;
   spin_unlock_irqrestore(&memoryStats.lock, flags);
-  uint64_t totalBytes = kmallocBytes + vmallocBytes;
   logInfo("current module memory tracking"
           " (actual allocation sizes, not requested):");
   logInfo("  %" PRIu64 " bytes in %" PRIu64 " kmalloc blocks",
           kmallocBytes, kmallocBlocks);
   logInfo("  %" PRIu64 " bytes in %" PRIu64 " vmalloc blocks",
           vmallocBytes, vmallocBlocks);
+  logInfo("  %" PRIu64 " bytes in contiguous large regions, %" PRIu64
+          " bytes in page-mapped fallbacks", contiguousBytes, fallbackBytes);
   logInfo("  total %" PRIu64 " bytes, peak usage %" PRIu64 " bytes",
           totalBytes, peakUsage);
   // Someday maybe we could track the size of allocated bios too.
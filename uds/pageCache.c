@@ -57,10 +57,10 @@ int assertPageInCache(PageCache *cache, CachedPage *page)
  * Clear a cache page.  Note: this does not clear readPending - a read could
  * still be pending and the read thread needs to be able to proceed and restart
  * the requests regardless. This page will still be marked invalid, but it
- * won't get reused (see getLeastRecentPage()) until the readPending flag
+ * won't get reused (see getClockVictim()) until the readPending flag
  * is cleared. This is a valid case, e.g. the chapter gets forgotten and
- * replaced with a new one in LRU.  Restarting the requests will lead them to
- * not find the records in the MI.
+ * replaced with a new one in the cache.  Restarting the requests will lead
+ * them to not find the records in the MI.
  *
  * @param cache   the cache
  * @param page    the cached page to clear
@@ -69,7 +69,7 @@ int assertPageInCache(PageCache *cache, CachedPage *page)
 static void clearPage(PageCache *cache, CachedPage *page)
 {
   page->physicalPage = cache->numIndexEntries;
-  WRITE_ONCE(page->lastUsed, 0);
+  WRITE_ONCE(page->referenced, false);
 }
 
 /**
@@ -241,17 +241,10 @@ int findInvalidateAndMakeLeastRecent(PageCache          *cache,
     return UDS_SUCCESS;
   }
 
-  // Invalidate the page and unmap it from the cache.
-  result = invalidatePageInCache(cache, page, reason);
-  if (result != UDS_SUCCESS) {
-    return result;
-  }
-
-  // Move the cached page to the least recently used end of the list
-  // so it will be replaced before any page with valid data.
-  WRITE_ONCE(page->lastUsed, 0);
-
-  return UDS_SUCCESS;
+  // Invalidate the page and unmap it from the cache. This also clears its
+  // reference flag, so the clock hand will replace it as soon as it gets
+  // there.
+  return invalidatePageInCache(cache, page, reason);
 }
 
 /**********************************************************************/
@@ -267,7 +260,6 @@ static int initializePageCache(PageCache      *cache,
   cache->numCacheEntries = chaptersInCache * geometry->recordPagesPerChapter;
   cache->readQueueMaxSize = readQueueMaxSize;
   cache->zoneCount = zoneCount;
-  atomic64_set(&cache->clock, 1);
 
   int result = ALLOCATE(readQueueMaxSize, QueuedRead,
                         "volume read queue", &cache->readQueue);
@@ -281,6 +273,12 @@ static int initializePageCache(PageCache      *cache,
     return result;
   }
 
+  result = ALLOCATE(cache->zoneCount, ZoneCacheCounters,
+                    "page cache zone counters", &cache->zoneCounters);
+  if (result != UDS_SUCCESS) {
+    return result;
+  }
+
   result = ASSERT((cache->numCacheEntries <= VOLUME_CACHE_MAX_ENTRIES),
                   "requested cache size, %u, within limit %u",
                   cache->numCacheEntries, VOLUME_CACHE_MAX_ENTRIES);
@@ -370,6 +368,7 @@ void freePageCache(PageCache *cache)
   FREE(cache->data);
   FREE(cache->cache);
   FREE(cache->searchPendingCounters);
+  FREE(cache->zoneCounters);
   FREE(cache->readQueue);
   FREE(cache);
 }
@@ -399,56 +398,45 @@ int invalidatePageCacheForChapter(PageCache          *cache,
   return UDS_SUCCESS;
 }
 
-/*********************************************************************/
-void makePageMostRecent(PageCache *cache, CachedPage *page)
-{
-  // ASSERTION: We are either a zone thread holding a searchPendingCounter,
-  //            or we are any thread holding the readThreadsMutex.
-  if (atomic64_read(&cache->clock) != READ_ONCE(page->lastUsed)) {
-    WRITE_ONCE(page->lastUsed, atomic64_inc_return(&cache->clock));
-  }
-}
-
 /**
- * Get the least recent valid page from the cache.
+ * Choose a cache page to replace using the clock algorithm. The clock hand
+ * sweeps around the cache, giving each page which has been used since the
+ * last sweep a second chance by clearing its reference flag, and stops at the
+ * first page which is neither referenced nor being read.
  *
  * @param cache    the cache
- * @param pagePtr  a pointer to hold the new page (will be set to NULL
- *                 if the page was not found)
+ * @param pagePtr  a pointer to hold the chosen page
  *
  * @return UDS_SUCCESS or an error code
  **/
 __attribute__((warn_unused_result))
-static int getLeastRecentPage(PageCache *cache, CachedPage **pagePtr)
+static int getClockVictim(PageCache *cache, CachedPage **pagePtr)
 {
-  // We hold the readThreadsMutex.
-  int oldestIndex = 0;
-  // Our first candidate is any page that does have a pending read.  We ensure
-  // above that there are more entries than read threads, so there must be one.
-  for (unsigned int i = 0;; i++) {
-    if (i >= cache->numCacheEntries) {
-      // This should never happen.
-      return ASSERT(false, "oldest page is not NULL");
+  // We hold the readThreadsMutex.  The first sweep clears every reference
+  // flag, so the second must find a page unless every page has a read
+  // pending.  makeVolume ensures that there are more entries than reads in
+  // flight, so that can't happen.
+  for (unsigned int i = 0; i < (2 * cache->numCacheEntries); i++) {
+    CachedPage *page = &cache->cache[cache->clockHand];
+    cache->clockHand = (cache->clockHand + 1) % cache->numCacheEntries;
+    if (page->readPending) {
+      continue;
     }
-    if (!cache->cache[i].readPending) {
-      oldestIndex = i;
-      break;
-    }
-  }
-  // Now find the least recently used page that does not have a pending read.
-  for (unsigned int i = 0; i < cache->numCacheEntries; i++) {
-    if (!cache->cache[i].readPending
-        && (READ_ONCE(cache->cache[i].lastUsed)
-            <= READ_ONCE(cache->cache[oldestIndex].lastUsed))) {
-      oldestIndex = i;
+    if (READ_ONCE(page->referenced)) {
+      WRITE_ONCE(page->referenced, false);
+      continue;
     }
+    *pagePtr = page;
+    return UDS_SUCCESS;
   }
-  *pagePtr = &cache->cache[oldestIndex];
-  return UDS_SUCCESS;
+
+  // This should never happen.
+  return ASSERT(false, "clock victim found");
 }
 
 /***********************************************************************/
 int getPageFromCache(PageCache     *cache,
+                     unsigned int   zoneNumber,
                      unsigned int   physicalPage,
                      int            probeType,
                      CachedPage   **pagePtr)
@@ -473,7 +461,8 @@ int getPageFromCache(PageCache     *cache,
                                  : ((queueIndex != -1)
                                     ? CACHE_RESULT_QUEUED
                                     : CACHE_RESULT_MISS));
-  incrementCacheCounter(&cache->counters, probeType, cacheResult);
+  incrementCacheCounter(&cache->zoneCounters[zoneNumber].counters, probeType,
+                        cacheResult);
 
   if (pagePtr != NULL) {
     *pagePtr = page;
@@ -593,12 +582,12 @@ int selectVictimInCache(PageCache   *cache,
   }
 
   CachedPage *page = NULL;
-  int result = getLeastRecentPage(cache, &page);
+  int result = getClockVictim(cache, &page);
   if (result != UDS_SUCCESS) {
     return result;
   }
 
-  result = ASSERT((page != NULL), "least recent page was not NULL");
+  result = ASSERT((page != NULL), "clock victim was not NULL");
   if (result != UDS_SUCCESS) {
     return result;
   }
@@ -651,7 +640,7 @@ int putPageInCache(PageCache    *cache,
     return result;
   }
 
-  makePageMostRecent(cache, page);
+  markPageReferenced(page);
 
   page->readPending = false;
 
@@ -711,4 +700,7 @@ size_t getPageCacheSize(PageCache *cache)
 void getPageCacheCounters(PageCache *cache, CacheCounters *counters)
 {
   *counters = cache->counters;
+  for (unsigned int i = 0; i < cache->zoneCount; i++) {
+    addCacheCounters(counters, &cache->zoneCounters[i].counters);
+  }
 }
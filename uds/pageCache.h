@@ -40,8 +40,8 @@ typedef struct cachedPage {
   bool              readPending;
   /* if equal to numCacheEntries, the page is invalid */
   unsigned int      physicalPage;
-  /* the value of the volume clock when this page was last used */
-  int64_t           lastUsed;
+  /* whether the page has been used since the clock hand last passed it */
+  bool              referenced;
   /* the cache page data */
   byte             *data;
   /* the chapter index page. This is here, even for record pages */
@@ -94,6 +94,15 @@ typedef struct __attribute__((aligned(CACHE_LINE_BYTES))) {
   atomic64_t atomicValue;
 } SearchPendingCounter;
 
+/**
+ * The probe counters of one zone. Each zone counts its own probes on its own
+ * cache line, so a zone thread searching the cache never writes to memory
+ * which another zone thread is writing.
+ **/
+typedef struct __attribute__((aligned(CACHE_LINE_BYTES))) {
+  CacheCounters counters;
+} ZoneCacheCounters;
+
 typedef struct pageCache {
   // Geometry governing the volume
   const Geometry *geometry;
@@ -113,10 +122,13 @@ typedef struct pageCache {
   // A counter for each zone to keep track of when a search is occurring
   // within that zone.
   SearchPendingCounter *searchPendingCounters;
+  // The probe counters for each zone
+  ZoneCacheCounters    *zoneCounters;
   // Queued reads, as a circular array, with first and last indexes
   QueuedRead     *readQueue;
-  // Cache counters for stats.  This is the first field of a PageCache that is
-  // not constant after the struct is initialized.
+  // Eviction and expiration counters for stats, updated under the
+  // readThreadsMutex.  This is the first field of a PageCache that is not
+  // constant after the struct is initialized.
   CacheCounters   counters;
   /**
    * Entries are enqueued at readQueueLast.
@@ -143,8 +155,8 @@ typedef struct pageCache {
   uint16_t              readQueueLast;
   // The size of the read queue
   unsigned int          readQueueMaxSize;
-  // Page access counter
-  atomic64_t            clock;
+  // The next cache entry to consider for replacement
+  uint16_t              clockHand;
 } PageCache;
 
 /**
@@ -208,14 +220,21 @@ int findInvalidateAndMakeLeastRecent(PageCache          *cache,
                                      bool                mustFind);
 
 /**
- * Make the page the most recent in the cache
+ * Note that a cached page has been used, so that the clock hand will pass
+ * over it once before replacing it. Any zone thread may do this.
  *
- * @param cache   the page cache
- * @param pagePtr the page to make most recent
- *
- * @return UDS_SUCCESS or an error code
+ * @param page  the page which was used
  **/
-void makePageMostRecent(PageCache *cache, CachedPage *pagePtr);
+static INLINE void markPageReferenced(CachedPage *page)
+{
+  // ASSERTION: We are either a zone thread holding a searchPendingCounter,
+  //            or we are any thread holding the readThreadsMutex.
+  // Only write the flag when it changes so that hits on a hot page don't
+  // keep pulling its cache line away from the other zone threads.
+  if (!READ_ONCE(page->referenced)) {
+    WRITE_ONCE(page->referenced, true);
+  }
+}
 
 /**
  * Verifies that a page is in the cache.  This method is only exposed for the
@@ -233,6 +252,7 @@ int assertPageInCache(PageCache *cache, CachedPage *page)
  * Gets a page from the cache.
  *
  * @param [in] cache        the page cache
+ * @param [in] zoneNumber   the zone making the probe, for stats
  * @param [in] physicalPage the page number
  * @param [in] probeType    the type of cache access being done (CacheProbeType
  *                          optionally OR'ed with CACHE_PROBE_IGNORE_FAILURE)
@@ -241,6 +261,7 @@ int assertPageInCache(PageCache *cache, CachedPage *page)
  * @return UDS_SUCCESS or an error code
  **/
 int getPageFromCache(PageCache     *cache,
+                     unsigned int   zoneNumber,
                      unsigned int   physicalPage,
                      int            probeType,
                      CachedPage   **pagePtr)
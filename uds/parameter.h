@@ -61,6 +61,7 @@ struct parameterDefinition {
 
 extern const char * const UDS_PARALLEL_FACTOR;
 extern const char * const UDS_VOLUME_READ_THREADS;
+extern const char * const UDS_VOLUME_READ_DEPTH;
 extern const char * const UDS_PARAMETER_TEST_PARAM;
 
 /**
@@ -84,6 +85,7 @@ extern const char * const UDS_PARAMETER_TEST_PARAM;
 
 extern int defineParallelFactor(ParameterDefinition *pd);
 extern int defineVolumeReadThreads(ParameterDefinition *pd);
+extern int defineVolumeReadDepth(ParameterDefinition *pd);
 extern int setTestParameterDefinitionFunc(int (*func)(ParameterDefinition *))
   __attribute__((warn_unused_result));
 
@@ -104,6 +104,7 @@ static struct kobj_type emptyObjectType = {
 // <dir>/log_level                 UDS_LOG_LEVEL
 // <dir>/parallel_factor           UDS_PARALLEL_FACTOR
 // <dir>/volume_read_threads       UDS_VOLUME_READ_THREADS
+// <dir>/volume_read_depth         UDS_VOLUME_READ_DEPTH
 //
 /**********************************************************************/
 
@@ -204,10 +205,16 @@ static ParameterAttribute volumeReadThreadsAttr = {
   .name = "UDS_VOLUME_READ_THREADS",
 };
 
+static ParameterAttribute volumeReadDepthAttr = {
+  .attr = { .name = "volume_read_depth", .mode = 0600 },
+  .name = "UDS_VOLUME_READ_DEPTH",
+};
+
 static struct attribute *parameterAttrs[] = {
   &logLevelAttr.attr,
   &parallelFactorAttr.attr,
   &volumeReadThreadsAttr.attr,
+  &volumeReadDepthAttr.attr,
   NULL,
 };
 
@@ -110,6 +110,14 @@ extern const UdsParameterValue UDS_PARAM_FALSE;
  *      The number of threads used to read chapters.  Although stored as an
  *      unsigned int, the validation function will accept strings as well.
  *      This parameter affect how local index sessions operate.
+ *
+ * UDS_VOLUME_READ_DEPTH
+ *      UNSIGNED INT    1-256                                   [16]
+ *      STRING          "[number]"
+ *      The maximum number of volume page reads which the read threads will
+ *      have in flight at once.  Although stored as an unsigned int, the
+ *      validation function will accept strings as well.  This parameter
+ *      affect how local index sessions operate.
  **/
 
 /**
@@ -95,6 +95,7 @@ EXPORT_SYMBOL_GPL(udsStringValue);
 EXPORT_SYMBOL_GPL(udsUnsignedValue);
 
 EXPORT_SYMBOL_GPL(allocSprintf);
+EXPORT_SYMBOL_GPL(allocateLargeMemory);
 EXPORT_SYMBOL_GPL(allocateMemory);
 EXPORT_SYMBOL_GPL(allocateMemoryNowait);
 EXPORT_SYMBOL_GPL(assertionFailed);
@@ -113,12 +114,14 @@ EXPORT_SYMBOL_GPL(equalBuffers);
 EXPORT_SYMBOL_GPL(fixedSprintf);
 EXPORT_SYMBOL_GPL(freeBuffer);
 EXPORT_SYMBOL_GPL(freeFunnelQueue);
+EXPORT_SYMBOL_GPL(freeLargeMemory);
 EXPORT_SYMBOL_GPL(freeMemory);
 EXPORT_SYMBOL_GPL(funnelQueuePoll);
 EXPORT_SYMBOL_GPL(getBoolean);
 EXPORT_SYMBOL_GPL(getBufferContents);
 EXPORT_SYMBOL_GPL(getByte);
 EXPORT_SYMBOL_GPL(getBytesFromBuffer);
+EXPORT_SYMBOL_GPL(getLargeMemoryStats);
 EXPORT_SYMBOL_GPL(getMemoryStats);
 EXPORT_SYMBOL_GPL(getUInt16BEFromBuffer);
 EXPORT_SYMBOL_GPL(getUInt16LEFromBuffer);
@@ -21,6 +21,7 @@
 
 #include "volume.h"
 
+#include "atomicDefs.h"
 #include "cacheCounters.h"
 #include "chapterIndex.h"
 #include "compiler.h"
@@ -42,7 +43,8 @@
 
 enum {
   MAX_BAD_CHAPTERS    = 100,   // max number of contiguous bad chapters
-  VOLUME_READ_THREADS = 2      // Number of reader threads
+  VOLUME_READ_THREADS = 2,     // Number of reader threads
+  VOLUME_READ_DEPTH   = 16     // Number of page reads in flight
 };
 
 static const NumericValidationData validRange = {
@@ -50,24 +52,72 @@ static const NumericValidationData validRange = {
   .maxValue = MAX_VOLUME_READ_THREADS,
 };
 
+static const NumericValidationData validDepthRange = {
+  .minValue = 1,
+  .maxValue = MAX_VOLUME_READ_DEPTH,
+};
+
+/**
+ * A page read which a reader thread has started but not yet finished.
+ **/
+typedef struct {
+  /* The asynchronous read of the page data */
+  AsyncRead     read;
+  /* The semaphore of the reader which started the read */
+  Semaphore    *readDone;
+  /* Set once the read has completed, possibly in interrupt context */
+  atomic_t      done;
+  /* Whether this slot holds a read which has not been finished */
+  bool          busy;
+  /* Whether the page was invalidated before the read was started */
+  bool          invalid;
+  /* The reserved read queue entry for the page */
+  unsigned int  queuePos;
+  /* The requests waiting for the page */
+  UdsQueueHead  queuedRequests;
+  /* The page to read */
+  unsigned int  physicalPage;
+  /* The cache page receiving the data */
+  CachedPage   *page;
+} PageRead;
+
+struct pageReader {
+  /* The volume being read */
+  Volume       *volume;
+  /* Released once for each completed read, and to wake the reader */
+  Semaphore     readDone;
+  /* The number of this reader's reads which have not been finished */
+  unsigned int  readsInFlight;
+  /* The number of releases of readDone which have not been consumed */
+  unsigned int  pendingReleases;
+  /* Whether the reader is waiting on readDone */
+  bool          waiting;
+  /* Whether the reader has been woken to start newly queued reads */
+  bool          woken;
+  /* The reads, one for each unit of the volume's read depth */
+  PageRead     *reads;
+};
+
 /**********************************************************************/
-static UdsParameterValue getDefaultReadThreads(void)
+static UdsParameterValue getDefaultValue(const char                  *name,
+                                         const NumericValidationData *range,
+                                         unsigned int                 dflt)
 {
   UdsParameterValue value;
 #if ENVIRONMENT
-  char *env = getenv(UDS_VOLUME_READ_THREADS);
+  char *env = getenv(name);
   if (env != NULL) {
     UdsParameterValue tmp = {
       .type = UDS_PARAM_TYPE_STRING,
       .value.u_string = env,
     };
-    if (validateNumericRange(&tmp, &validRange, &value) == UDS_SUCCESS) {
+    if (validateNumericRange(&tmp, range, &value) == UDS_SUCCESS) {
       return value;
     }
   }
 #endif // ENVIRONMENT
   value.type = UDS_PARAM_TYPE_UNSIGNED_INT;
-  value.value.u_uint = VOLUME_READ_THREADS;
+  value.value.u_uint = dflt;
   return value;
 }
 
@@ -76,7 +126,19 @@ int defineVolumeReadThreads(ParameterDefinition *pd)
 {
   pd->validate       = validateNumericRange;
   pd->validationData = &validRange;
-  pd->currentValue   = getDefaultReadThreads();
+  pd->currentValue   = getDefaultValue(UDS_VOLUME_READ_THREADS, &validRange,
+                                       VOLUME_READ_THREADS);
+  pd->update         = NULL;
+  return UDS_SUCCESS;
+}
+
+/**********************************************************************/
+int defineVolumeReadDepth(ParameterDefinition *pd)
+{
+  pd->validate       = validateNumericRange;
+  pd->validationData = &validDepthRange;
+  pd->currentValue   = getDefaultValue(UDS_VOLUME_READ_DEPTH,
+                                       &validDepthRange, VOLUME_READ_DEPTH);
   pd->update         = NULL;
   return UDS_SUCCESS;
 }
@@ -163,6 +225,33 @@ static void waitForReadQueueNotFull(Volume *volume, Request *request)
   }
 }
 
+/**
+ * Wake a reader which is waiting for its reads to complete, so that it can
+ * start a newly queued read. Idle readers wait on the readThreadsCond instead,
+ * but if every reader is busy, none of them would otherwise notice the new
+ * read until one of its own reads completes.
+ *
+ * @param volume  The volume
+ **/
+static void wakeBusyReader(Volume *volume)
+{
+  // We hold the readThreadsMutex.
+  if ((volume->pageReaders == NULL)
+      || (volume->readsInFlight >= volume->readDepth)) {
+    return;
+  }
+
+  for (unsigned int i = 0; i < volume->numReadThreads; i++) {
+    PageReader *reader = &volume->pageReaders[i];
+    if (reader->waiting && !reader->woken) {
+      reader->woken = true;
+      reader->pendingReleases++;
+      releaseSemaphore(&reader->readDone, NULL);
+      return;
+    }
+  }
+}
+
 /**********************************************************************/
 int enqueuePageRead(Volume *volume, Request *request, int physicalPage)
 {
@@ -186,27 +275,12 @@ int enqueuePageRead(Volume *volume, Request *request, int physicalPage)
   if (result == UDS_QUEUED) {
     /* signal a read thread */
     signalCond(&volume->readThreadsCond);
+    wakeBusyReader(volume);
   }
 
   return result;
 }
 
-/**********************************************************************/
-static INLINE void waitToReserveReadQueueEntry(Volume       *volume,
-                                               unsigned int *queuePos,
-                                               UdsQueueHead *queuedRequests,
-                                               unsigned int *physicalPage,
-                                               bool         *invalid)
-{
-  while (((volume->readerState & READER_STATE_EXIT) == 0)
-         && (((volume->readerState & READER_STATE_STOP) != 0)
-             || !reserveReadQueueEntry(volume->pageCache, queuePos,
-                                       queuedRequests, physicalPage,
-                                       invalid))) {
-    waitCond(&volume->readThreadsCond, &volume->readThreadsMutex);
-  }
-}
-
 /**********************************************************************/
 static int initChapterIndexPage(const Volume     *volume,
                                 byte             *indexPage,
@@ -272,115 +346,273 @@ static int initializeIndexPage(const Volume *volume,
   return result;
 }
 
-/**********************************************************************/
-static void readThreadFunction(void *arg)
+/**
+ * Finish a page read whose data has arrived (or which failed or was
+ * invalidated), putting the page in the cache and restarting the requests
+ * which were waiting for it.
+ *
+ * @param reader  The reader which started the read
+ * @param read    The read to finish
+ **/
+static void finishPageRead(PageReader *reader, PageRead *read)
 {
-  Volume       *volume  = arg;
-  unsigned int  queuePos;
-  UdsQueueHead  queuedRequests;
-  unsigned int  physicalPage;
-  bool          invalid = false;
-
-  logDebug("reader starting");
-  lockMutex(&volume->readThreadsMutex);
-  while (true) {
-    waitToReserveReadQueueEntry(volume, &queuePos, &queuedRequests,
-                                &physicalPage, &invalid);
-    if ((volume->readerState & READER_STATE_EXIT) != 0) {
-      break;
-    }
-
-    volume->busyReaderThreads++;
-
-    bool recordPage = isRecordPage(volume->geometry, physicalPage);
-
-    CachedPage *page = NULL;
-    int result = UDS_SUCCESS;
-    if (!invalid) {
-      // Find a place to put the read queue page we reserved above.
-      result = selectVictimInCache(volume->pageCache, &page);
-      if (result == UDS_SUCCESS) {
-        unlockMutex(&volume->readThreadsMutex);
-        result = readPageToBuffer(volume, physicalPage, page->data);
+  // We hold the readThreadsMutex.
+  Volume       *volume       = reader->volume;
+  unsigned int  physicalPage = read->physicalPage;
+  bool          recordPage   = isRecordPage(volume->geometry, physicalPage);
+  CachedPage   *page         = read->page;
+  bool          invalid      = read->invalid;
+  int           result       = read->read.result;
+
+  if (!invalid && (page != NULL)) {
+    if (result != UDS_SUCCESS) {
+      logWarningWithStringError(result, "Error reading page %u from volume",
+                                physicalPage);
+      cancelPageInCache(volume->pageCache, physicalPage, page);
+    } else if (!volume->pageCache->readQueue[read->queuePos].invalid) {
+      if (!recordPage) {
+        result = initializeIndexPage(volume, physicalPage, page);
         if (result != UDS_SUCCESS) {
-          logWarning("Error reading page %u from volume", physicalPage);
+          logWarning("Error initializing chapter index page");
           cancelPageInCache(volume->pageCache, physicalPage, page);
         }
-        lockMutex(&volume->readThreadsMutex);
-      } else {
-        logWarning("Error selecting cache victim for page read");
       }
 
       if (result == UDS_SUCCESS) {
-        if (!volume->pageCache->readQueue[queuePos].invalid) {
-          if (!recordPage) {
-            result = initializeIndexPage(volume, physicalPage, page);
-            if (result != UDS_SUCCESS) {
-              logWarning("Error initializing chapter index page");
-              cancelPageInCache(volume->pageCache, physicalPage, page);
-            }
-          }
-
-          if (result == UDS_SUCCESS) {
-            result = putPageInCache(volume->pageCache, physicalPage, page);
-            if (result != UDS_SUCCESS) {
-              logWarning("Error putting page %u in cache", physicalPage);
-              cancelPageInCache(volume->pageCache, physicalPage, page);
-            }
-          }
-        } else {
-          logWarning("Page %u invalidated after read", physicalPage);
+        result = putPageInCache(volume->pageCache, physicalPage, page);
+        if (result != UDS_SUCCESS) {
+          logWarning("Error putting page %u in cache", physicalPage);
           cancelPageInCache(volume->pageCache, physicalPage, page);
-          invalid = true;
         }
       }
     } else {
-      logDebug("Requeuing requests for invalid page");
+      logWarning("Page %u invalidated after read", physicalPage);
+      cancelPageInCache(volume->pageCache, physicalPage, page);
+      invalid = true;
     }
+  }
 
-    if (invalid) {
-      result = UDS_SUCCESS;
-      page = NULL;
-    }
+  if (invalid) {
+    result = UDS_SUCCESS;
+    page = NULL;
+  }
 
-    while (!STAILQ_EMPTY(&queuedRequests)) {
-      Request *request = STAILQ_FIRST(&queuedRequests);
-      STAILQ_REMOVE_HEAD(&queuedRequests, link);
+  while (!STAILQ_EMPTY(&read->queuedRequests)) {
+    Request *request = STAILQ_FIRST(&read->queuedRequests);
+    STAILQ_REMOVE_HEAD(&read->queuedRequests, link);
 
-      /*
-       * If we've read in a record page, we're going to do an immediate search,
-       * in an attempt to speed up processing when we requeue the request, so
-       * that it doesn't have to go back into the getRecordFromZone code again.
-       * However, if we've just read in an index page, we don't want to search.
-       * We want the request to be processed again and getRecordFromZone to be
-       * run.  We have added new fields in request to allow the index code to
-       * know whether it can stop processing before getRecordFromZone is called
-       * again.
-       */
-      if ((result == UDS_SUCCESS) && (page != NULL) && recordPage) {
-        if (searchRecordPage(page->data, &request->hash, volume->geometry,
-                             &request->oldMetadata)) {
-          request->slLocation = LOC_IN_DENSE;
-        } else {
-          request->slLocation = LOC_UNAVAILABLE;
-        }
-        request->slLocationKnown = true;
+    /*
+     * If we've read in a record page, we're going to do an immediate search,
+     * in an attempt to speed up processing when we requeue the request, so
+     * that it doesn't have to go back into the getRecordFromZone code again.
+     * However, if we've just read in an index page, we don't want to search.
+     * We want the request to be processed again and getRecordFromZone to be
+     * run.  We have added new fields in request to allow the index code to
+     * know whether it can stop processing before getRecordFromZone is called
+     * again.
+     */
+    if ((result == UDS_SUCCESS) && (page != NULL) && recordPage) {
+      if (searchRecordPage(page->data, &request->hash, volume->geometry,
+                           &request->oldMetadata)) {
+        request->slLocation = LOC_IN_DENSE;
+      } else {
+        request->slLocation = LOC_UNAVAILABLE;
       }
+      request->slLocationKnown = true;
+    }
+
+    // reflect any read failures in the request status
+    request->status = result;
+    restartRequest(request);
+  }
+
+  releaseReadQueueEntry(volume->pageCache, read->queuePos);
+
+  read->busy = false;
+  reader->readsInFlight--;
+  volume->readsInFlight--;
+  broadcastCond(&volume->readThreadsReadDoneCond);
+}
+
+/**
+ * Note that a page read has completed. This may be called in interrupt
+ * context, so it only wakes the reader which started the read.
+ *
+ * @param asyncRead  The completed read
+ **/
+static void handlePageReadDone(AsyncRead *asyncRead)
+{
+  PageRead  *read     = container_of(asyncRead, PageRead, read);
+  Semaphore *readDone = read->readDone;
+  atomic_set_release(&read->done, 1);
+  releaseSemaphore(readDone, NULL);
+}
+
+/**
+ * Reserve the next queued page read, if the volume's read depth permits
+ * another read in flight, and start reading the page without waiting for it.
+ *
+ * @param reader  The reader which will own the read
+ *
+ * @return <code>true</code> if a queued read was reserved
+ **/
+static bool startPageRead(PageReader *reader)
+{
+  // We hold the readThreadsMutex.
+  Volume *volume = reader->volume;
+  if (((volume->readerState & (READER_STATE_EXIT | READER_STATE_STOP)) != 0)
+      || (volume->readsInFlight >= volume->readDepth)) {
+    return false;
+  }
 
-      // reflect any read failures in the request status
-      request->status = result;
-      restartRequest(request);
+  // This reader has fewer reads in flight than the volume, so it must have
+  // an idle slot.
+  PageRead *read = reader->reads;
+  while (read->busy) {
+    read++;
+  }
+
+  if (!reserveReadQueueEntry(volume->pageCache, &read->queuePos,
+                             &read->queuedRequests, &read->physicalPage,
+                             &read->invalid)) {
+    return false;
+  }
+
+  read->busy        = true;
+  read->page        = NULL;
+  read->read.result = UDS_SUCCESS;
+  atomic_set(&read->done, 0);
+  reader->readsInFlight++;
+  volume->readsInFlight++;
+
+  if (read->invalid) {
+    logDebug("Requeuing requests for invalid page");
+    finishPageRead(reader, read);
+    return true;
+  }
+
+  // Find a place to put the read queue page we reserved above.
+  int result = selectVictimInCache(volume->pageCache, &read->page);
+  if (result != UDS_SUCCESS) {
+    logWarning("Error selecting cache victim for page read");
+    read->page        = NULL;
+    read->read.result = result;
+    finishPageRead(reader, read);
+    return true;
+  }
+
+  // The read will release the reader's semaphore once it completes.
+  reader->pendingReleases++;
+  unlockMutex(&volume->readThreadsMutex);
+  readPageToBufferAsync(volume, read->physicalPage, read->page->data,
+                        &read->read);
+  lockMutex(&volume->readThreadsMutex);
+  return true;
+}
+
+/**
+ * Finish each of a reader's reads which has completed.
+ *
+ * @param reader  The reader
+ **/
+static void finishCompletedReads(PageReader *reader)
+{
+  // We hold the readThreadsMutex.
+  for (unsigned int i = 0; i < reader->volume->readDepth; i++) {
+    PageRead *read = &reader->reads[i];
+    if (read->busy && (atomic_read_acquire(&read->done) != 0)) {
+      finishPageRead(reader, read);
+    }
+  }
+}
+
+/**********************************************************************/
+static void readThreadFunction(void *arg)
+{
+  PageReader *reader = arg;
+  Volume     *volume = reader->volume;
+
+  logDebug("reader starting");
+  lockMutex(&volume->readThreadsMutex);
+  while (true) {
+    // Keep as many reads in flight as the read depth allows, rather than
+    // waiting for each one before starting the next.
+    while (startPageRead(reader)) {
+      // Each iteration starts a read.
     }
 
-    releaseReadQueueEntry(volume->pageCache, queuePos);
+    if (reader->readsInFlight == 0) {
+      if ((volume->readerState & READER_STATE_EXIT) != 0) {
+        break;
+      }
+      waitCond(&volume->readThreadsCond, &volume->readThreadsMutex);
+      continue;
+    }
 
-    volume->busyReaderThreads--;
-    broadcastCond(&volume->readThreadsReadDoneCond);
+    reader->waiting = true;
+    unlockMutex(&volume->readThreadsMutex);
+    acquireSemaphore(&reader->readDone, NULL);
+    lockMutex(&volume->readThreadsMutex);
+    reader->waiting = false;
+    reader->woken   = false;
+    reader->pendingReleases--;
+    finishCompletedReads(reader);
   }
   unlockMutex(&volume->readThreadsMutex);
+
+  // Every read has been finished, but a completion may not have released
+  // the semaphore yet. Consume every release still owed so that none can
+  // touch the reader once it has been destroyed.
+  while (reader->pendingReleases > 0) {
+    acquireSemaphore(&reader->readDone, NULL);
+    reader->pendingReleases--;
+  }
   logDebug("reader done");
 }
 
+/**
+ * Prepare the state of a reader thread.
+ *
+ * @param volume  The volume to be read
+ * @param reader  The reader to initialize
+ *
+ * @return UDS_SUCCESS or an error code
+ **/
+static int initializePageReader(Volume *volume, PageReader *reader)
+{
+  int result = ALLOCATE(volume->readDepth, PageRead, "page reads",
+                        &reader->reads);
+  if (result != UDS_SUCCESS) {
+    return result;
+  }
+
+  result = initializeSemaphore(&reader->readDone, 0, "page reads done");
+  if (result != UDS_SUCCESS) {
+    FREE(reader->reads);
+    reader->reads = NULL;
+    return result;
+  }
+
+  reader->volume = volume;
+  for (unsigned int i = 0; i < volume->readDepth; i++) {
+    reader->reads[i].read.callback = handlePageReadDone;
+    reader->reads[i].readDone      = &reader->readDone;
+  }
+  return UDS_SUCCESS;
+}
+
+/**
+ * Release the state of a reader thread which has exited.
+ *
+ * @param reader  The reader to destroy
+ **/
+static void destroyPageReader(PageReader *reader)
+{
+  destroySemaphore(&reader->readDone, "page reads done");
+  FREE(reader->reads);
+  reader->reads = NULL;
+}
+
 /**********************************************************************/
 static int readPageLocked(Volume        *volume,
                           Request       *request,
@@ -445,8 +677,8 @@ int getPageLocked(Volume          *volume,
                   CachedPage     **pagePtr)
 {
   CachedPage *page = NULL;
-  int result = getPageFromCache(volume->pageCache, physicalPage, probeType,
-                                &page);
+  int result = getPageFromCache(volume->pageCache, getZoneNumber(request),
+                                physicalPage, probeType, &page);
   if (result != UDS_SUCCESS) {
     return result;
   }
@@ -455,9 +687,8 @@ int getPageLocked(Volume          *volume,
     if (result != UDS_SUCCESS) {
       return result;
     }
-  } else if (getZoneNumber(request) == 0) {
-    // Only 1 zone is responsible for updating LRU
-    makePageMostRecent(volume->pageCache, page);
+  } else {
+    markPageReferenced(page);
   }
 
   *pagePtr = page;
@@ -471,15 +702,15 @@ int getPageProtected(Volume          *volume,
                      CacheProbeType   probeType,
                      CachedPage     **pagePtr)
 {
+  unsigned int zoneNumber = getZoneNumber(request);
   CachedPage *page = NULL;
-  int result = getPageFromCache(volume->pageCache, physicalPage,
+  int result = getPageFromCache(volume->pageCache, zoneNumber, physicalPage,
                                 probeType | CACHE_PROBE_IGNORE_FAILURE,
                                 &page);
   if (result != UDS_SUCCESS) {
     return result;
   }
 
-  unsigned int zoneNumber = getZoneNumber(request);
   // If we didn't find a page we need to enqueue a read for it, in which
   // case we need to grab the mutex.
   if (page == NULL) {
@@ -495,8 +726,8 @@ int getPageProtected(Volume          *volume,
      * which is already in the cache, which would mean we end up with two
      * entries in the cache for the same page.
      */
-    result
-      = getPageFromCache(volume->pageCache, physicalPage, probeType, &page);
+    result = getPageFromCache(volume->pageCache, zoneNumber, physicalPage,
+                              probeType, &page);
     if (result != UDS_SUCCESS) {
       /*
        * In non-success cases (anything not UDS_SUCCESS, meaning both
@@ -553,10 +784,7 @@ int getPageProtected(Volume          *volume,
     beginPendingSearch(volume->pageCache, physicalPage, zoneNumber);
     unlockMutex(&volume->readThreadsMutex);
   } else {
-    if (getZoneNumber(request) == 0 ) {
-      // Only 1 zone is responsible for updating LRU
-      makePageMostRecent(volume->pageCache, page);
-    }
+    markPageReferenced(page);
   }
 
   *pagePtr = page;
@@ -1300,11 +1528,24 @@ int makeVolume(const Configuration  *config,
     volumeReadThreads = VOLUME_READ_THREADS;
   }
 
+  unsigned int volumeReadDepth;
+  if ((udsGetParameter(UDS_VOLUME_READ_DEPTH, &value) == UDS_SUCCESS) &&
+      (value.type == UDS_PARAM_TYPE_UNSIGNED_INT)) {
+    volumeReadDepth = value.value.u_uint;
+  } else {
+    volumeReadDepth = VOLUME_READ_DEPTH;
+  }
+
   if (readQueueMaxSize <= volumeReadThreads) {
     logError("Number of read threads must be smaller than read queue");
     return UDS_INVALID_ARGUMENT;
   }
 
+  if (readQueueMaxSize <= volumeReadDepth) {
+    logError("Read depth must be smaller than read queue");
+    return UDS_INVALID_ARGUMENT;
+  }
+
   Volume *volume;
 
   int result = allocateVolume(config, layout, readQueueMaxSize, zoneCount,
@@ -1328,8 +1569,22 @@ int makeVolume(const Configuration  *config,
     return result;
   }
 
+  // Every read in flight holds a cache page, so there must be pages to spare.
+  if (volume->pageCache->numCacheEntries <= volumeReadDepth) {
+    logError("Read depth must be smaller than the page cache");
+    freeVolume(volume);
+    return UDS_INVALID_ARGUMENT;
+  }
+  volume->readDepth = volumeReadDepth;
+
   // Start the reader threads.  If this allocation succeeds, freeVolume knows
   // that it needs to try and stop those threads.
+  result = ALLOCATE(volumeReadThreads, PageReader, "page readers",
+                    &volume->pageReaders);
+  if (result != UDS_SUCCESS) {
+    freeVolume(volume);
+    return result;
+  }
   result = ALLOCATE(volumeReadThreads, Thread, "reader threads",
                     &volume->readerThreads);
   if (result != UDS_SUCCESS) {
@@ -1337,9 +1592,16 @@ int makeVolume(const Configuration  *config,
     return result;
   }
   for (unsigned int i = 0; i < volumeReadThreads; i++) {
-    result = createThread(readThreadFunction, (void *) volume, "reader",
+    PageReader *reader = &volume->pageReaders[i];
+    result = initializePageReader(volume, reader);
+    if (result != UDS_SUCCESS) {
+      freeVolume(volume);
+      return result;
+    }
+    result = createThread(readThreadFunction, (void *) reader, "reader",
                           &volume->readerThreads[i]);
     if (result != UDS_SUCCESS) {
+      destroyPageReader(reader);
       freeVolume(volume);
       return result;
     }
@@ -1367,10 +1629,12 @@ void freeVolume(Volume *volume)
     unlockMutex(&volume->readThreadsMutex);
     for (unsigned int i = 0; i < volume->numReadThreads; i++) {
       joinThreads(volume->readerThreads[i]);
+      destroyPageReader(&volume->pageReaders[i]);
     }
     FREE(volume->readerThreads);
     volume->readerThreads = NULL;
   }
+  FREE(volume->pageReaders);
 
   if (volume->region != NULL) {
     int result = syncAndCloseRegion(&volume->region, "index volume");
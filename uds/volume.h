@@ -36,7 +36,8 @@
 #include "util/radixSort.h"
 
 enum {
-  MAX_VOLUME_READ_THREADS = 16
+  MAX_VOLUME_READ_THREADS = 16,
+  MAX_VOLUME_READ_DEPTH   = 256
 };
 
 typedef enum {
@@ -63,6 +64,8 @@ typedef enum indexLookupMode {
   LOOKUP_FOR_REBUILD
 } IndexLookupMode;
 
+typedef struct pageReader PageReader;
+
 typedef struct volume {
   /* The layout of the volume */
   Geometry              *geometry;
@@ -96,14 +99,18 @@ typedef struct volume {
   CondVar                readThreadsReadDoneCond;
   /* Threads to read data from disk */
   Thread                *readerThreads;
-  /* Number of threads busy with reads */
-  unsigned int           busyReaderThreads;
+  /* The in-flight reads of each reader thread */
+  PageReader            *pageReaders;
+  /* Number of page reads submitted but not yet finished */
+  unsigned int           readsInFlight;
   /* The state of the reader threads */
   ReaderState            readerState;
   /* The lookup mode for the index */
   IndexLookupMode        lookupMode;
   /* Number of read threads to use (run-time parameter) */
   unsigned int           numReadThreads;
+  /* Maximum number of page reads in flight (run-time parameter) */
+  unsigned int           readDepth;
 } Volume;
 
 /**
@@ -272,6 +272,18 @@ int readPageToBuffer(const Volume *volume,
   return UDS_SUCCESS;
 }
 
+/**********************************************************************/
+void readPageToBufferAsync(const Volume *volume,
+                           unsigned int  physicalPage,
+                           byte         *buffer,
+                           AsyncRead    *read)
+{
+  off_t pageOffset
+    = ((off_t) physicalPage) * ((off_t) volume->geometry->bytesPerPage);
+  readFromRegionAsync(volume->region, pageOffset, buffer,
+                      volume->geometry->bytesPerPage, read);
+}
+
 /**********************************************************************/
 int readChapterIndexToBuffer(const Volume *volume,
                              unsigned int  chapterNumber,
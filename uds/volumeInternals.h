@@ -91,6 +91,21 @@ int readPageToBuffer(const Volume *volume,
                      byte         *buffer)
   __attribute__((warn_unused_result));
 
+/**
+ * Start reading a page from the volume without waiting for the read to
+ * finish. The read's callback will be called, possibly in interrupt context,
+ * when it does.
+ *
+ * @param volume       the volume from which to read the page
+ * @param physicalPage the volume page number of the desired page
+ * @param buffer       the buffer to hold the page
+ * @param read         the read request, with its callback set
+ **/
+void readPageToBufferAsync(const Volume *volume,
+                           unsigned int  physicalPage,
+                           byte         *buffer,
+                           AsyncRead    *read);
+
 /**
  * Read a chapter index from the volume.
  *
@@ -25,6 +25,7 @@
 
 #include "blockAllocator.h"
 #include "dataVIO.h"
+#include "logicalZone.h"
 #include "pbnLock.h"
 #include "slabDepot.h"
 #include "vdoInternal.h"
@@ -79,7 +80,18 @@ static int attemptPBNWriteLock(AllocatingVIO *allocatingVIO)
 static int allocateAndLockBlock(AllocatingVIO *allocatingVIO)
 {
   BlockAllocator *allocator = getBlockAllocator(allocatingVIO->zone);
-  int result = allocateBlock(allocator, &allocatingVIO->allocation);
+  int result;
+  if (allocatingVIO->writeLockType == VIO_WRITE_LOCK) {
+    // Data writes know their logical address, so sequential writes can be
+    // kept physically contiguous.
+    DataVIO   *dataVIO     = allocatingVIOAsDataVIO(allocatingVIO);
+    ZoneCount  logicalZone = getLogicalZoneNumber(dataVIO->logical.zone);
+    result = allocateBlockForStream(allocator, logicalZone,
+                                    dataVIO->logical.lbn,
+                                    &allocatingVIO->allocation);
+  } else {
+    result = allocateBlock(allocator, &allocatingVIO->allocation);
+  }
   if (result != VDO_SUCCESS) {
     return result;
   }
@@ -51,6 +51,28 @@ static inline void assertOnAllocatorThread(ThreadID    threadID,
                   "%s called on correct thread", functionName);
 }
 
+/**
+ * Map a non-zero number of free blocks to a priority. The priority is made
+ * from the position of the highest set bit of the count, followed by the
+ * next SLAB_PRIORITY_FRACTION_BITS bits, much like a small floating point
+ * number, so it grows with the count but distinguishes counts within the
+ * same power of two.
+ *
+ * @param freeBlocks  The number of free blocks, which must not be zero
+ *
+ * @return The priority for that many free blocks, which is at least 1
+ **/
+static unsigned int getFreeBlockPriority(BlockCount freeBlocks)
+{
+  unsigned int exponent = logBaseTwo(freeBlocks);
+  BlockCount   fraction
+    = ((exponent >= SLAB_PRIORITY_FRACTION_BITS)
+       ? (freeBlocks >> (exponent - SLAB_PRIORITY_FRACTION_BITS))
+       : (freeBlocks << (SLAB_PRIORITY_FRACTION_BITS - exponent)));
+  fraction &= ((1 << SLAB_PRIORITY_FRACTION_BITS) - 1);
+  return (1 + (exponent << SLAB_PRIORITY_FRACTION_BITS) + fraction);
+}
+
 /**
  * Get the priority for a slab in the allocator's slab queue. Slabs are
  * essentially prioritized by an approximation of the number of free blocks in
@@ -87,12 +109,14 @@ static unsigned int calculateSlabPriority(Slab *slab)
 
   /*
    * For all other slabs, the priority is derived from the logarithm of the
-   * number of free blocks. Slabs with the same order of magnitude of free
-   * blocks have the same priority. With 2^23 blocks, the priority will range
-   * from 1 to 25. The reserved unopenedSlabPriority divides the range and is
-   * skipped by the logarithmic mapping.
+   * number of free blocks, refined by the bits after the highest one. Slabs
+   * whose free block counts agree to within an eighth of their order of
+   * magnitude have the same priority. With 2^23 free blocks, the priority
+   * would be 186, but a slab always has fewer data blocks than that, so real
+   * priorities range from 1 to at most 185. The reserved unopenedSlabPriority
+   * divides the range and is skipped by the logarithmic mapping.
    */
-  unsigned int priority = (1 + logBaseTwo(freeBlocks));
+  unsigned int priority = getFreeBlockPriority(freeBlocks);
   return ((priority < unopenedSlabPriority) ? priority : priority + 1);
 }
 
@@ -199,7 +223,7 @@ static int allocateComponents(BlockAllocator  *allocator,
   // The number of data blocks is the maximum number of free blocks that could
   // be used in calculateSlabPriority().
   BlockCount maxFreeBlocks = depot->slabConfig.dataBlocks;
-  unsigned int maxPriority = (2 + logBaseTwo(maxFreeBlocks));
+  unsigned int maxPriority = (1 + getFreeBlockPriority(maxFreeBlocks));
   result = makePriorityTable(maxPriority, &allocator->prioritizedSlabs);
   if (result != VDO_SUCCESS) {
     return result;
@@ -221,7 +245,8 @@ static int allocateComponents(BlockAllocator  *allocator,
    * avoids degenerate behavior in unit tests where the number of data blocks
    * is artificially constrained to a power of two.
    */
-  allocator->unopenedSlabPriority = (1 + logBaseTwo((maxFreeBlocks * 3) / 4));
+  BlockCount threshold = (1ULL << logBaseTwo((maxFreeBlocks * 3) / 4));
+  allocator->unopenedSlabPriority = getFreeBlockPriority(threshold);
 
   return VDO_SUCCESS;
 }
@@ -272,6 +297,7 @@ void freeBlockAllocator(BlockAllocator **blockAllocatorPtr)
   freeSlabCompletion(&allocator->slabCompletion);
   freeVIOPool(&allocator->vioPool);
   freePriorityTable(&allocator->prioritizedSlabs);
+  FREE(allocator->spareCounters);
   destroyEnqueueable(&allocator->completion);
   FREE(allocator);
   *blockAllocatorPtr = NULL;
@@ -323,6 +349,78 @@ BlockCount getUnrecoveredSlabCount(const BlockAllocator *allocator)
   return getScrubberSlabCount(allocator->slabScrubber);
 }
 
+/**********************************************************************/
+int configureAllocatorScrubbing(BlockAllocator *allocator,
+                                PhysicalLayer  *layer,
+                                unsigned int    concurrency,
+                                BlockCount      ioBudget)
+{
+  // Scrubbing a slab may read its whole journal and all its reference blocks.
+  const SlabConfig *slabConfig = &allocator->depot->slabConfig;
+  BlockCount scrubCost = (slabConfig->slabJournalBlocks
+                          + slabConfig->referenceCountBlocks);
+  return configureSlabScrubber(allocator->slabScrubber, layer, concurrency,
+                               scrubCost, ioBudget);
+}
+
+/**********************************************************************/
+void setColdSlabCompaction(BlockAllocator *allocator, bool compact)
+{
+  allocator->compactColdSlabs = compact;
+  allocator->coldSlabCursor   = allocator->zoneNumber;
+}
+
+/**
+ * Examine the next few of an allocator's slabs, and compact the reference
+ * counts of the first of them which is cold. The open slab and slabs which
+ * have yet to be loaded or scrubbed are left alone.
+ *
+ * @param allocator  The block allocator
+ **/
+static void compactColdSlab(BlockAllocator *allocator)
+{
+  if (allocator->slabCount == 0) {
+    return;
+  }
+
+  SlabDepot *depot = allocator->depot;
+  for (unsigned int i = 0; i < COLD_SLAB_SWEEP_SIZE; i++) {
+    Slab *slab = depot->slabs[allocator->coldSlabCursor];
+    allocator->coldSlabCursor += depot->zoneCount;
+    if (allocator->coldSlabCursor > allocator->lastSlab) {
+      allocator->coldSlabCursor = allocator->zoneNumber;
+    }
+
+    uint64_t age = allocator->referenceUpdateClock - slab->lastReferenceUpdate;
+    if ((slab == allocator->openSlab) || isUnrecoveredSlab(slab)
+        || (age < COLD_SLAB_AGE)) {
+      continue;
+    }
+
+    if (compactReferenceCounts(slab->referenceCounts)) {
+      return;
+    }
+  }
+}
+
+/**********************************************************************/
+void noteReferenceCountUpdate(Slab *slab)
+{
+  BlockAllocator *allocator = slab->allocator;
+  slab->lastReferenceUpdate = ++allocator->referenceUpdateClock;
+  if (allocator->compactColdSlabs
+      && ((allocator->referenceUpdateClock % COLD_SLAB_SWEEP_INTERVAL) == 0)) {
+    compactColdSlab(allocator);
+  }
+}
+
+/**********************************************************************/
+SlabScrubbingStatistics
+getAllocatorScrubbingStatistics(const BlockAllocator *allocator)
+{
+  return getSlabScrubbingStatistics(allocator->slabScrubber);
+}
+
 /**********************************************************************/
 void queueSlab(Slab *slab)
 {
@@ -434,6 +532,136 @@ int allocateBlock(BlockAllocator *allocator,
   return allocateSlabBlock(allocator->openSlab, blockNumberPtr);
 }
 
+/**
+ * Find the stream, if any, which a write of a given logical block would
+ * continue.
+ *
+ * @param allocator    The block allocator
+ * @param logicalZone  The logical zone of the write
+ * @param lbn          The logical block being written
+ *
+ * @return The stream the write continues, or NULL
+ **/
+static AllocationStream *findAllocationStream(BlockAllocator     *allocator,
+                                              ZoneCount           logicalZone,
+                                              LogicalBlockNumber  lbn)
+{
+  for (unsigned int i = 0; i < ALLOCATION_STREAM_COUNT; i++) {
+    AllocationStream *stream = &allocator->streams[i];
+    if ((stream->lastUse != 0) && (stream->logicalZone == logicalZone)
+        && (stream->nextLBN == lbn)) {
+      return stream;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Get the least recently used stream so that it can track a new run.
+ *
+ * @param allocator  The block allocator
+ *
+ * @return The stream to reuse
+ **/
+static AllocationStream *getOldestAllocationStream(BlockAllocator *allocator)
+{
+  AllocationStream *oldest = &allocator->streams[0];
+  for (unsigned int i = 1; i < ALLOCATION_STREAM_COUNT; i++) {
+    if (allocator->streams[i].lastUse < oldest->lastUse) {
+      oldest = &allocator->streams[i];
+    }
+  }
+
+  return oldest;
+}
+
+/**
+ * Allocate the block following a stream's most recent allocation from the
+ * extent set aside for the stream. The extent is only honored while its slab
+ * remains the open slab.
+ *
+ * @param [in]  allocator       The block allocator
+ * @param [in]  stream          The stream being extended
+ * @param [out] blockNumberPtr  A pointer to receive the allocated block number
+ *
+ * @return VDO_SUCCESS, VDO_NO_SPACE if the stream has no usable extent or the
+ *         block has been allocated by someone else, or an error code
+ **/
+static int allocateFromStreamExtent(BlockAllocator      *allocator,
+                                    AllocationStream    *stream,
+                                    PhysicalBlockNumber *blockNumberPtr)
+{
+  PhysicalBlockNumber pbn = stream->lastPBN + 1;
+  if ((stream->slab != allocator->openSlab) || (pbn >= stream->extentEnd)) {
+    return VDO_NO_SPACE;
+  }
+
+  int result = allocateUnreferencedBlockAt(stream->slab->referenceCounts,
+                                           pbn);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  adjustFreeBlockCount(stream->slab, false);
+  *blockNumberPtr = pbn;
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+int allocateBlockForStream(BlockAllocator      *allocator,
+                           ZoneCount            logicalZone,
+                           LogicalBlockNumber   lbn,
+                           PhysicalBlockNumber *blockNumberPtr)
+{
+  PhysicalBlockNumber pbn;
+  AllocationStream *stream = findAllocationStream(allocator, logicalZone, lbn);
+  if (stream == NULL) {
+    // This write may start a new run. Nothing is set aside for it until the
+    // run is seen to continue, since most writes which look like the start of
+    // a run are really random.
+    int result = allocateBlock(allocator, &pbn);
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+
+    stream  = getOldestAllocationStream(allocator);
+    *stream = (AllocationStream) {
+      .logicalZone = logicalZone,
+      .slab        = allocator->openSlab,
+      .extentEnd   = pbn + 1,
+    };
+  } else {
+    relaxedAdd64(&allocator->statistics.sequentialAllocations, 1);
+    int result = allocateFromStreamExtent(allocator, stream, &pbn);
+    if (result == VDO_NO_SPACE) {
+      // The run has used up or lost its extent, so allocate normally and set
+      // aside the blocks following the new allocation.
+      result = allocateBlock(allocator, &pbn);
+      if (result != VDO_SUCCESS) {
+        return result;
+      }
+
+      stream->slab      = allocator->openSlab;
+      stream->extentEnd
+        = skipAllocationSearch(stream->slab->referenceCounts,
+                               ALLOCATION_STREAM_EXTENT);
+    } else if (result != VDO_SUCCESS) {
+      return result;
+    }
+
+    if (pbn == (stream->lastPBN + 1)) {
+      relaxedAdd64(&allocator->statistics.contiguousAllocations, 1);
+    }
+  }
+
+  stream->nextLBN = lbn + 1;
+  stream->lastPBN = pbn;
+  stream->lastUse = ++allocator->streamClock;
+  *blockNumberPtr = pbn;
+  return VDO_SUCCESS;
+}
+
 /**********************************************************************/
 void releaseBlockReference(BlockAllocator      *allocator,
                            PhysicalBlockNumber  pbn,
@@ -525,6 +753,9 @@ int prepareSlabsForAllocation(BlockAllocator *allocator)
       continue;
     }
 
+    // Clean slabs must be loaded before coming online unless the load is
+    // lazy, in which case they are loaded by background scrubbing along with
+    // any dirty slabs, and before them if they are needed sooner.
     markSlabUnrecovered(slab);
     bool highPriority
       = ((currentSlabStatus.isClean && (depot->loadType == NORMAL_LOAD))
@@ -821,6 +1052,10 @@ getBlockAllocatorStatistics(const BlockAllocator *allocator)
     .slabCount     = allocator->slabCount,
     .slabsOpened   = relaxedLoad64(&atoms->slabsOpened),
     .slabsReopened = relaxedLoad64(&atoms->slabsReopened),
+    .sequentialAllocations
+      = relaxedLoad64(&atoms->sequentialAllocations),
+    .contiguousAllocations
+      = relaxedLoad64(&atoms->contiguousAllocations),
   };
 }
 
@@ -829,11 +1064,14 @@ SlabJournalStatistics getSlabJournalStatistics(const BlockAllocator *allocator)
 {
   const AtomicSlabJournalStatistics *atoms = &allocator->slabJournalStatistics;
   return (SlabJournalStatistics) {
-    .diskFullCount = atomicLoad64(&atoms->diskFullCount),
-    .flushCount    = atomicLoad64(&atoms->flushCount),
-    .blockedCount  = atomicLoad64(&atoms->blockedCount),
-    .blocksWritten = atomicLoad64(&atoms->blocksWritten),
-    .tailBusyCount = atomicLoad64(&atoms->tailBusyCount),
+    .diskFullCount     = atomicLoad64(&atoms->diskFullCount),
+    .flushCount        = atomicLoad64(&atoms->flushCount),
+    .blockedCount      = atomicLoad64(&atoms->blockedCount),
+    .blocksWritten     = atomicLoad64(&atoms->blocksWritten),
+    .tailBusyCount     = atomicLoad64(&atoms->tailBusyCount),
+    .updateBatches     = atomicLoad64(&atoms->updateBatches),
+    .updatesApplied    = atomicLoad64(&atoms->updatesApplied),
+    .updateNanoseconds = atomicLoad64(&atoms->updateNanoseconds),
   };
 }
 
@@ -843,6 +1081,10 @@ RefCountsStatistics getRefCountsStatistics(const BlockAllocator *allocator)
   const AtomicRefCountStatistics *atoms = &allocator->refCountStatistics;
   return (RefCountsStatistics) {
     .blocksWritten = atomicLoad64(&atoms->blocksWritten),
+    .compactSlabs  = atomicLoad64(&atoms->compactSlabs),
+    .memorySaved   = atomicLoad64(&atoms->memorySaved),
+    .slabsExpanded = atomicLoad64(&atoms->slabsExpanded),
+    .writeRuns     = atomicLoad64(&atoms->writeRuns),
   };
 }
 
@@ -102,6 +102,28 @@ int allocateBlock(BlockAllocator      *allocator,
                   PhysicalBlockNumber *blockNumberPtr)
   __attribute__((warn_unused_result));
 
+/**
+ * Allocate a physical block for a data write, keeping logically sequential
+ * writes from the same logical zone physically contiguous where possible.
+ * A write which does not continue a known run is allocated exactly as by
+ * allocateBlock().
+ *
+ * The block allocated will have a provisional reference, as with
+ * allocateBlock().
+ *
+ * @param [in]  allocator       The block allocator
+ * @param [in]  logicalZone     The number of the logical zone of the write
+ * @param [in]  lbn             The logical block being written
+ * @param [out] blockNumberPtr  A pointer to receive the allocated block number
+ *
+ * @return VDO_SUCCESS or an error code
+ **/
+int allocateBlockForStream(BlockAllocator      *allocator,
+                           ZoneCount            logicalZone,
+                           LogicalBlockNumber   lbn,
+                           PhysicalBlockNumber *blockNumberPtr)
+  __attribute__((warn_unused_result));
+
 /**
  * Release an unused provisional reference.
  *
@@ -134,6 +156,54 @@ BlockCount getAllocatedBlocks(const BlockAllocator *allocator)
 BlockCount getUnrecoveredSlabCount(const BlockAllocator *allocator)
   __attribute__((warn_unused_result));
 
+/**
+ * Configure how many slabs an allocator may scrub at once, and how much slab
+ * metadata its background scrubbing may be reading at once.
+ *
+ * @param allocator    The block allocator
+ * @param layer        The physical layer below the allocator
+ * @param concurrency  The most slabs to scrub at once
+ * @param ioBudget     The number of metadata blocks which background
+ *                     scrubbing may be reading at once, or 0 for no limit
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+int configureAllocatorScrubbing(BlockAllocator *allocator,
+                                PhysicalLayer  *layer,
+                                unsigned int    concurrency,
+                                BlockCount      ioBudget)
+  __attribute__((warn_unused_result));
+
+/**
+ * Set whether an allocator compacts the reference counts of slabs which have
+ * gone cold.
+ *
+ * @param allocator  The block allocator
+ * @param compact    Whether to compact the reference counts of cold slabs
+ **/
+void setColdSlabCompaction(BlockAllocator *allocator, bool compact);
+
+/**
+ * Record an update to the reference counts of a slab and, every so often,
+ * compact the reference counts of a slab in the same zone which has not been
+ * updated for a long time.
+ *
+ * @param slab  The slab whose reference counts were updated
+ **/
+void noteReferenceCountUpdate(Slab *slab);
+
+/**
+ * Get the slab scrubbing progress of an allocator. This may be called from
+ * any thread.
+ *
+ * @param allocator  The block allocator
+ *
+ * @return The scrubbing progress of the allocator
+ **/
+SlabScrubbingStatistics
+getAllocatorScrubbingStatistics(const BlockAllocator *allocator)
+  __attribute__((warn_unused_result));
+
 /**
  * Prepare the block allocator to come online and start allocating blocks.
  * Implements AllocatorAction.
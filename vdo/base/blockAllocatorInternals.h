@@ -25,6 +25,7 @@
 #include "atomic.h"
 #include "blockAllocator.h"
 #include "priorityTable.h"
+#include "referenceBlock.h"
 #include "ringNode.h"
 #include "slabScrubber.h"
 
@@ -34,6 +35,23 @@ enum {
    * the VDO.
    */
   VIO_POOL_SIZE = 128,
+  /** The number of sequential write streams tracked by each allocator */
+  ALLOCATION_STREAM_COUNT = 16,
+  /** The number of blocks set aside for a sequential stream at a time */
+  ALLOCATION_STREAM_EXTENT = 32,
+  /**
+   * The number of reference count updates in a zone after which a slab
+   * which has had none of them is considered cold
+   */
+  COLD_SLAB_AGE = (1 << 20),
+  /** The number of reference count updates in a zone between cold slab
+      sweeps */
+  COLD_SLAB_SWEEP_INTERVAL = (1 << 12),
+  /** The most slabs examined by each cold slab sweep */
+  COLD_SLAB_SWEEP_SIZE = 16,
+  /** The number of bits of a slab's free block count, after the highest one,
+      which distinguish its allocation priority */
+  SLAB_PRIORITY_FRACTION_BITS = 3,
 };
 
 typedef enum {
@@ -48,6 +66,29 @@ typedef struct {
   RingNode      *ringToScrub;
 } SlabRingRebuildCompletion;
 
+/**
+ * An AllocationStream tracks a run of logically sequential writes from one
+ * logical zone so that the run can be given physically contiguous blocks.
+ * Once a run is seen to continue, the blocks following its most recent
+ * allocation are set aside for it by skipping the open slab's free block
+ * search past them.
+ **/
+typedef struct {
+  /** The logical zone which is writing the run */
+  ZoneCount            logicalZone;
+  /** The logical block number which would continue the run */
+  LogicalBlockNumber   nextLBN;
+  /** The physical block most recently allocated to the run */
+  PhysicalBlockNumber  lastPBN;
+  /** The slab containing the extent set aside for the run */
+  Slab                *slab;
+  /** The end of the extent set aside for the run (exclusive) */
+  PhysicalBlockNumber  extentEnd;
+  /** The allocator's stream clock when the run was last extended; 0 if the
+      stream is unused */
+  uint64_t             lastUse;
+} AllocationStream;
+
 /**
  * These fields are only modified by the physical zone thread, but are queried
  * by other threads.
@@ -59,6 +100,10 @@ typedef struct atomicAllocatorStatistics {
   Atomic64 slabsOpened;
   /** The number of times since loading that a slab been re-opened */
   Atomic64 slabsReopened;
+  /** The number of allocations which continued a sequential logical run */
+  Atomic64 sequentialAllocations;
+  /** The number of those allocations which were physically contiguous */
+  Atomic64 contiguousAllocations;
 } AtomicAllocatorStatistics;
 
 /**
@@ -78,6 +123,12 @@ typedef struct atomicSlabJournalStatistics {
   Atomic64 blocksWritten;
   /** Number of times we had to wait for the tail block commit */
   Atomic64 tailBusyCount;
+  /** Number of batches of reference count updates applied */
+  Atomic64 updateBatches;
+  /** Number of reference count updates applied in those batches */
+  Atomic64 updatesApplied;
+  /** Time spent applying those updates, in nanoseconds */
+  Atomic64 updateNanoseconds;
 } AtomicSlabJournalStatistics;
 
 /**
@@ -89,6 +140,14 @@ typedef struct atomicSlabJournalStatistics {
 typedef struct atomicRefCountStatistics {
   /** Number of blocks written */
   Atomic64 blocksWritten;
+  /** Number of slabs whose counters are currently compact */
+  Atomic64 compactSlabs;
+  /** Bytes of counter memory currently released by compaction */
+  Atomic64 memorySaved;
+  /** Number of times compact counters have been expanded */
+  Atomic64 slabsExpanded;
+  /** Number of runs of adjacent reference blocks written together */
+  Atomic64 writeRuns;
 } AtomicRefCountStatistics;
 
 struct blockAllocator {
@@ -125,6 +184,20 @@ struct blockAllocator {
   /** What phase of the close operation the allocator is to perform */
   BlockAllocatorCloseStep      closeStep;
 
+  /** The sequential write streams being allocated in this zone */
+  AllocationStream             streams[ALLOCATION_STREAM_COUNT];
+  /** A counter which orders the uses of the streams */
+  uint64_t                     streamClock;
+
+  /** Whether to compact the reference counts of cold slabs */
+  bool                         compactColdSlabs;
+  /** The number of reference count updates made in this zone */
+  uint64_t                     referenceUpdateClock;
+  /** The number of the next slab for a cold slab sweep to examine */
+  SlabCount                    coldSlabCursor;
+  /** A zeroed counter array held ready for expanding a compact slab */
+  ReferenceCount              *spareCounters;
+
   /** Statistics for this block allocator */
   AtomicAllocatorStatistics    statistics;
   /** Cumulative statistics for the slab journals in this zone */
@@ -27,6 +27,7 @@
 
 #include "blockMapInternals.h"
 #include "blockMapPage.h"
+#include "blockMapRecovery.h"
 #include "blockMapTree.h"
 #include "constants.h"
 #include "dataVIO.h"
@@ -95,6 +96,10 @@ static int validatePageOnRead(void                *buffer,
     formatBlockMapPage(page, nonce, pbn, false);
   }
 
+  if (zone->pendingReplay != NULL) {
+    applyStagedBlockMapEntries(zone->pendingReplay, page, pbn);
+  }
+
   context->recoveryLock = 0;
   return VDO_SUCCESS;
 }
@@ -173,6 +178,9 @@ int makeBlockMap(BlockCount           logicalBlocks,
     blockMapZone->zoneNumber   = zone;
     blockMapZone->threadID     = getLogicalZoneThread(threadConfig, zone);
     blockMapZone->blockMap     = map;
+    blockMapZone->prefetch     = (PrefetchStream) {
+      .depth = INITIAL_PREFETCH_DEPTH,
+    };
     map->zoneCount++;
   }
 
@@ -278,6 +286,8 @@ int decodeSodiumBlockMap(Buffer              *buffer,
  * @param cacheSize        The size of the page cache for the zone
  * @param maximumAge       The number of journal blocks before a dirtied page
  *                         is considered old and must be written out
+ * @param cachePolicy      The replacement policy for the page cache
+ * @param background       Whether to write dirty pages out gradually
  *
  * @return VDO_SUCCESS or an error
  **/
@@ -286,7 +296,9 @@ static int initializeBlockMapZone(BlockMapZone        *zone,
                                   PhysicalLayer       *layer,
                                   ReadOnlyModeContext *readOnlyContext,
                                   PageCount            cacheSize,
-                                  BlockCount           maximumAge)
+                                  BlockCount           maximumAge,
+                                  PageCachePolicy      cachePolicy,
+                                  bool                 background)
 {
   STATIC_ASSERT(offsetof(BlockMapZone, completion) == 0);
   initializeCompletion(&zone->completion, BLOCK_MAP_ZONE_COMPLETION, layer);
@@ -304,6 +316,8 @@ static int initializeBlockMapZone(BlockMapZone        *zone,
                           zone,
                           sizeof(BlockMapPageContext),
                           maximumAge,
+                          cachePolicy,
+                          background,
                           &zone->pageCache);
 }
 
@@ -314,7 +328,9 @@ int makeBlockMapCaches(BlockMap            *map,
                        RecoveryJournal     *journal,
                        Nonce                nonce,
                        PageCount            cacheSize,
-                       BlockCount           maximumAge)
+                       BlockCount           maximumAge,
+                       PageCachePolicy      cachePolicy,
+                       bool                 background)
 {
   int result = ASSERT(cacheSize > 0, "block map cache size is specified");
   if (result != UDS_SUCCESS) {
@@ -332,7 +348,8 @@ int makeBlockMapCaches(BlockMap            *map,
   replaceForest(map);
   for (ZoneCount zone = 0; zone < map->zoneCount; zone++) {
     result = initializeBlockMapZone(&map->zones[zone], layer, readOnlyContext,
-                                    cacheSize / map->zoneCount, maximumAge);
+                                    cacheSize / map->zoneCount, maximumAge,
+                                    cachePolicy, background);
     if (result != VDO_SUCCESS) {
       return result;
     }
@@ -993,6 +1010,94 @@ static void handlePageError(VDOCompletion *completion)
   finishProcessingPage(completion, completion->result);
 }
 
+/**
+ * Check whether a block map page belongs to a given zone.
+ *
+ * @param zone        The zone
+ * @param pageNumber  The number of the page
+ *
+ * @return <code>true</code> if the page belongs to the zone
+ **/
+static inline bool isPageInZone(BlockMapZone *zone, PageNumber pageNumber)
+{
+  BlockMap *map = zone->blockMap;
+  return (((pageNumber % map->rootCount) % map->zoneCount) == zone->zoneNumber);
+}
+
+/**
+ * Deepen a zone's prefetching if its prefetched pages are being used, or
+ * halve it if any have been discarded unused since the last adjustment.
+ *
+ * @param zone  The zone
+ **/
+static void adjustPrefetchDepth(BlockMapZone *zone)
+{
+  PrefetchStream            *stream = &zone->prefetch;
+  AtomicPageCacheStatistics *stats
+    = getVDOPageCacheStatistics(zone->pageCache);
+  uint64_t used   = relaxedLoad64(&stats->prefetchUsed);
+  uint64_t wasted = relaxedLoad64(&stats->prefetchWasted);
+  if (wasted > stream->wasted) {
+    stream->depth = maxPageCount(stream->depth / 2, 1);
+  } else if (used > stream->used) {
+    stream->depth = minPageCount(stream->depth + 1, MAXIMUM_PREFETCH_DEPTH);
+  }
+
+  stream->used   = used;
+  stream->wasted = wasted;
+}
+
+/**
+ * Track the leaf pages requested in a zone and, when the zone moves forward
+ * to a nearby page, start loading the next of the zone's leaf pages so that
+ * a sequential stream does not stall on each new page.
+ *
+ * @param zone        The zone
+ * @param pageNumber  The number of the leaf page just requested
+ **/
+static void prefetchLeafPages(BlockMapZone *zone, PageNumber pageNumber)
+{
+  PrefetchStream *stream = &zone->prefetch;
+  if (pageNumber == stream->lastPage) {
+    return;
+  }
+
+  BlockMap *map        = zone->blockMap;
+  bool      sequential = ((pageNumber > stream->lastPage)
+                          && ((pageNumber - stream->lastPage)
+                              <= map->rootCount));
+  stream->lastPage = pageNumber;
+  if (!sequential) {
+    stream->prefetchedThrough = pageNumber;
+    return;
+  }
+
+  adjustPrefetchDepth(zone);
+  PageNumber lastPage = computePageNumber(map->entryCount - 1);
+  PageCount  ahead    = 0;
+  for (PageNumber next = pageNumber + 1;
+       (next <= lastPage) && (ahead < stream->depth);
+       next++) {
+    if (!isPageInZone(zone, next)) {
+      continue;
+    }
+
+    ahead++;
+    if (next <= stream->prefetchedThrough) {
+      continue;
+    }
+
+    // Unallocated pages and pages whose parents aren't loaded are skipped.
+    PhysicalBlockNumber pbn = findBlockMapPagePBN(map, next);
+    if ((pbn != ZERO_BLOCK) && !prefetchVDOPage(zone->pageCache, pbn)) {
+      // The cache is full; try again when the stream reaches another page.
+      return;
+    }
+
+    stream->prefetchedThrough = next;
+  }
+}
+
 /**
  * Get the mapping page for a get/put mapped block operation and dispatch to
  * the appropriate handler.
@@ -1011,11 +1116,14 @@ static void setupMappedBlock(DataVIO   *dataVIO,
     return;
   }
 
+  // The dataVIO may be gone once the page has been requested.
+  PageNumber pageNumber = dataVIO->treeLock.treeSlots[0].pageIndex;
   initVDOPageCompletion(&dataVIO->pageCompletion, zone->pageCache,
                         dataVIO->treeLock.treeSlots[0].blockMapSlot.pbn,
                         modifiable, dataVIOAsCompletion(dataVIO), action,
                         handlePageError);
   getVDOPageAsync(&dataVIO->pageCompletion.completion);
+  prefetchLeafPages(zone, pageNumber);
 }
 
 /**
@@ -1160,12 +1268,23 @@ BlockMapStatistics getBlockMapStatistics(BlockMap *map)
     stats.reclaimed       += atomicLoad64(&atoms->reclaimed);
     stats.readOutgoing    += atomicLoad64(&atoms->readOutgoing);
     stats.foundInCache    += atomicLoad64(&atoms->foundInCache);
+    stats.ghostHits       += atomicLoad64(&atoms->ghostHits);
+    stats.prefetchIssued  += atomicLoad64(&atoms->prefetchIssued);
+    stats.prefetchUsed    += atomicLoad64(&atoms->prefetchUsed);
+    stats.prefetchWasted  += atomicLoad64(&atoms->prefetchWasted);
     stats.discardRequired += atomicLoad64(&atoms->discardRequired);
     stats.waitForPage     += atomicLoad64(&atoms->waitForPage);
     stats.fetchRequired   += atomicLoad64(&atoms->fetchRequired);
     stats.pagesLoaded     += atomicLoad64(&atoms->pagesLoaded);
     stats.pagesSaved      += atomicLoad64(&atoms->pagesSaved);
     stats.flushCount      += atomicLoad64(&atoms->flushCount);
+    stats.writebackPages  += atomicLoad64(&atoms->writebackPages);
+    stats.writebackLimit  += atomicLoad64(&atoms->writebackLimit);
+
+    uint64_t largestWriteBatch = atomicLoad64(&atoms->largestWriteBatch);
+    if (largestWriteBatch > stats.largestWriteBatch) {
+      stats.largestWriteBatch = largestWriteBatch;
+    }
   }
 
   return stats;
@@ -148,6 +148,9 @@ int decodeSodiumBlockMap(Buffer              *buffer,
  * @param cacheSize        The block map cache size, in pages
  * @param maximumAge       The number of journal blocks before a dirtied page
  *                         is considered old and must be written out
+ * @param cachePolicy      The replacement policy for the page caches
+ * @param background       Whether to write dirty pages out gradually rather
+ *                         than only when they expire
  *
  * @return VDO_SUCCESS or an error code
  **/
@@ -157,7 +160,9 @@ int makeBlockMapCaches(BlockMap            *map,
                        RecoveryJournal     *journal,
                        Nonce                nonce,
                        PageCount            cacheSize,
-                       BlockCount           maximumAge)
+                       BlockCount           maximumAge,
+                       PageCachePolicy      cachePolicy,
+                       bool                 background)
   __attribute__((warn_unused_result));
 
 /**
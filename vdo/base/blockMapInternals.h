@@ -61,6 +61,29 @@ struct blockMapTreeZone {
   uint32_t             dirtyPageCounts[256];
 };
 
+enum {
+  /** The number of leaf pages to load ahead of a new sequential stream */
+  INITIAL_PREFETCH_DEPTH = 2,
+  /** The most leaf pages which will be loaded ahead of a stream */
+  MAXIMUM_PREFETCH_DEPTH = 16,
+};
+
+/**
+ * The sequential access detector of a block map zone.
+ **/
+typedef struct {
+  /** The page number most recently requested in the zone */
+  PageNumber lastPage;
+  /** The highest page number which has been considered for prefetching */
+  PageNumber prefetchedThrough;
+  /** The number of the zone's leaf pages to keep loading ahead of a stream */
+  PageCount  depth;
+  /** The page cache's count of used prefetches at the last adjustment */
+  uint64_t   used;
+  /** The page cache's count of wasted prefetches at the last adjustment */
+  uint64_t   wasted;
+} PrefetchStream;
+
 /**
  * The per-zone fields of the block map.
  **/
@@ -79,6 +102,10 @@ struct blockMapZone {
   BlockMapTreeZone  treeZone;
   /** The administrative state of the zone */
   AdminState        adminState;
+  /** The detector for sequential runs of leaf page requests */
+  PrefetchStream    prefetch;
+  /** The recovery to apply to pages as they are loaded, if any */
+  BlockMapReplay   *pendingReplay;
 };
 
 /**
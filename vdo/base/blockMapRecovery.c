@@ -23,7 +23,9 @@
 
 #include "logger.h"
 #include "memoryAlloc.h"
+#include "timeUtils.h"
 
+#include "atomic.h"
 #include "blockMapInternals.h"
 #include "blockMapPage.h"
 #include "heap.h"
@@ -35,6 +37,8 @@
 
 /**
  * A completion to manage recovering the block map from the recovery journal.
+ * There is one of these for each logical zone, each replaying the entries
+ * for the block map pages assigned to its zone through its zone's page cache.
  * Note that the page completions kept in this structure are not immediately
  * freed, so the corresponding pages will be locked down in the page cache
  * until the recovery frees them.
@@ -44,10 +48,16 @@ typedef struct {
   VDOCompletion         completion;
   /** the completion for flushing the block map */
   VDOCompletion         subTaskCompletion;
+  /** the replay of which this recovery is a part */
+  BlockMapReplay       *replay;
+  /** the logical zone whose pages this recovery is replaying */
+  ZoneCount             zoneNumber;
   /** the thread on which all block map operations must be done */
   ThreadID              logicalThreadID;
   /** the block map */
   BlockMap             *blockMap;
+  /** the page cache of the zone */
+  VDOPageCache         *pageCache;
   /** whether this recovery has been aborted */
   bool                  aborted;
   /** whether we are currently launching the initial round of requests */
@@ -56,6 +66,8 @@ typedef struct {
   // Fields for the journal entries.
   /** the journal entries to apply */
   NumberedBlockMapping *journalEntries;
+  /** the number of journal entries to apply */
+  BlockCount            entryCount;
   /**
    * a heap wrapping journalEntries. It re-orders and sorts journal entries in
    * ascending LBN order, then original journal order. This permits efficient
@@ -80,6 +92,40 @@ typedef struct {
   VDOPageCompletion     pageCompletions[];
 } BlockMapRecoveryCompletion;
 
+/**
+ * The state shared by the per-zone recoveries of a single block map replay.
+ * The journal entries are partitioned by block map page so that each page is
+ * only ever touched by one zone, allowing the zones to proceed in parallel.
+ *
+ * A staged replay owns its journal entries, which are fully sorted up front
+ * so that the entries for any page can be found and applied when the page
+ * is loaded while the VDO is online but the replay has not yet finished.
+ **/
+struct blockMapReplay {
+  /** the VDO being recovered */
+  VDO                        *vdo;
+  /** whether the replay was staged to run while the VDO is online */
+  bool                        staged;
+  /** the sorted journal entries of a staged replay */
+  NumberedBlockMapping       *entries;
+  /** the completion to notify when every zone has finished */
+  VDOCompletion              *parent;
+  /** the number of zones which have not yet finished */
+  Atomic32                    zonesReplaying;
+  /** the first error encountered by any zone */
+  Atomic32                    result;
+  /** the total number of journal entries being replayed */
+  BlockCount                  entryCount;
+  /** the time at which the replay started, in microseconds */
+  uint64_t                    startTime;
+  /** the number of zones */
+  ZoneCount                   zoneCount;
+  /** the index just past the last journal entry of each zone */
+  BlockCount                  zoneEnds[MAX_LOGICAL_ZONES];
+  /** the recovery for each zone */
+  BlockMapRecoveryCompletion *zones[MAX_LOGICAL_ZONES];
+};
+
 /**
  * This is a HeapComparator function that orders NumberedBlockMappings using
  * the 'blockMapSlot' field as the primary key and the mapping 'number' field
@@ -147,40 +193,139 @@ static void freeRecoveryCompletion(VDOCompletion **completionPtr)
   *completionPtr = NULL;
 }
 
+/**********************************************************************/
+void freeBlockMapReplay(BlockMapReplay **replayPtr)
+{
+  BlockMapReplay *replay = *replayPtr;
+  if (replay == NULL) {
+    return;
+  }
+
+  for (ZoneCount zone = 0; zone < replay->zoneCount; zone++) {
+    if (replay->zones[zone] != NULL) {
+      VDOCompletion *completion = &replay->zones[zone]->completion;
+      freeRecoveryCompletion(&completion);
+    }
+  }
+
+  if (replay->staged) {
+    FREE(replay->entries);
+  }
+
+  FREE(replay);
+  *replayPtr = NULL;
+}
+
+/**
+ * Record the throughput of a replay which every zone has finished, free it,
+ * and notify the parent.
+ *
+ * @param replay  The replay which has finished
+ **/
+static void finishBlockMapReplay(BlockMapReplay *replay)
+{
+  uint64_t elapsed = nowUsec() - replay->startTime;
+  VDO     *vdo     = replay->vdo;
+  vdo->recoveryStatistics.blockMapEntries = replay->entryCount;
+  vdo->recoveryStatistics.blockMapTime    = elapsed;
+  logInfo("Replayed %" PRIu64 " recovery entries into block map in %" PRIu64
+          " ms using %u zones (%" PRIu64 " entries/second)",
+          replay->entryCount, elapsed / 1000, replay->zoneCount,
+          (replay->entryCount * 1000000) / ((elapsed > 0) ? elapsed : 1));
+
+  int            result = (int) atomicLoad32(&replay->result);
+  VDOCompletion *parent = replay->parent;
+  freeBlockMapReplay(&replay);
+  finishCompletion(parent, result);
+}
+
 /**
- * Free the BlockMapRecoveryCompletion and notify the parent that the block map
- * recovery is done. This callback is registered in makeRecoveryCompletion().
+ * Detach a staged replay from a zone of the block map now that every zone has
+ * flushed its replayed pages and, if this is the last zone to do so, finish
+ * the replay. This callback is launched from finishBlockMapRecovery() on the
+ * zone's logical thread.
+ *
+ * @param completion  The BlockMapRecoveryCompletion for the zone
+ **/
+static void detachStagedReplay(VDOCompletion *completion)
+{
+  BlockMapRecoveryCompletion *recovery
+    = asBlockMapRecoveryCompletion(completion);
+  BlockMapReplay *replay = recovery->replay;
+  getBlockMapZone(recovery->blockMap, recovery->zoneNumber)->pendingReplay
+    = NULL;
+  if (atomicAdd32(&replay->zonesReplaying, -1) > 0) {
+    return;
+  }
+
+  finishBlockMapReplay(replay);
+}
+
+/**
+ * Note that a zone has finished and, if it is the last zone to finish,
+ * notify the parent that the block map recovery is done. A staged replay
+ * must first be detached from every zone, since pages loaded on demand must
+ * keep having entries applied until all of the replayed pages have been
+ * flushed. This callback is registered in startZoneRecovery().
  *
  * @param completion  The BlockMapRecoveryCompletion
  **/
 static void finishBlockMapRecovery(VDOCompletion *completion)
 {
-  int            result = completion->result;
-  VDOCompletion *parent = completion->parent;
-  freeRecoveryCompletion(&completion);
-  finishCompletion(parent, result);
+  BlockMapRecoveryCompletion *recovery
+    = asBlockMapRecoveryCompletion(completion);
+  BlockMapReplay *replay = recovery->replay;
+  if (completion->result != VDO_SUCCESS) {
+    // Only the first error is kept.
+    compareAndSwap32(&replay->result, VDO_SUCCESS, completion->result);
+  }
+
+  if (!replay->staged) {
+    replay->zones[recovery->zoneNumber] = NULL;
+    freeRecoveryCompletion(&completion);
+  }
+
+  if (atomicAdd32(&replay->zonesReplaying, -1) > 0) {
+    return;
+  }
+
+  if (!replay->staged) {
+    finishBlockMapReplay(replay);
+    return;
+  }
+
+  ZoneCount zoneCount = replay->zoneCount;
+  atomicStore32(&replay->zonesReplaying, zoneCount);
+  for (ZoneCount zone = 0; zone < zoneCount; zone++) {
+    BlockMapRecoveryCompletion *zoneRecovery = replay->zones[zone];
+    // Any error has already been recorded in the replay.
+    resetCompletion(&zoneRecovery->completion);
+    launchCallback(&zoneRecovery->completion, detachStagedReplay,
+                   zoneRecovery->logicalThreadID);
+  }
 }
 
 /**
- * Make a new block map recovery completion.
+ * Make a new block map recovery completion for one logical zone.
  *
- * @param [in]  vdo             The VDO
- * @param [in]  entryCount      The number of journal entries
+ * @param [in]  replay          The replay of which the recovery is a part
+ * @param [in]  zoneNumber      The logical zone to recover
+ * @param [in]  entryCount      The number of journal entries for the zone
  * @param [in]  journalEntries  An array of journal entries to process
- * @param [in]  parent          The parent of the recovery completion
  * @param [out] recoveryPtr     The new block map recovery completion
  *
  * @return a success or error code
  **/
-static int makeRecoveryCompletion(VDO                         *vdo,
+static int makeRecoveryCompletion(BlockMapReplay              *replay,
+                                  ZoneCount                    zoneNumber,
                                   BlockCount                   entryCount,
                                   NumberedBlockMapping        *journalEntries,
-                                  VDOCompletion               *parent,
                                   BlockMapRecoveryCompletion **recoveryPtr)
 {
+  VDO      *vdo      = replay->vdo;
   BlockMap *blockMap = getBlockMap(vdo);
   PageCount pageCount
-    = minPageCount(getConfiguredCacheSize(vdo) >> 1,
+    = minPageCount((getConfiguredCacheSize(vdo) / replay->zoneCount) >> 1,
                    MAXIMUM_SIMULTANEOUS_BLOCK_MAP_RESTORATION_READS);
 
   BlockMapRecoveryCompletion *recovery;
@@ -199,33 +344,110 @@ static int makeRecoveryCompletion(VDO                         *vdo,
     return result;
   }
 
+  recovery->replay         = replay;
+  recovery->zoneNumber     = zoneNumber;
   recovery->blockMap       = blockMap;
+  recovery->pageCache      = getBlockMapZone(blockMap, zoneNumber)->pageCache;
   recovery->journalEntries = journalEntries;
+  recovery->entryCount     = entryCount;
   recovery->pageCount      = pageCount;
   recovery->currentEntry   = &recovery->journalEntries[entryCount - 1];
 
   initializeCompletion(&recovery->subTaskCompletion, SUB_TASK_COMPLETION,
                        vdo->layer);
-  recovery->logicalThreadID = getLogicalZoneThread(getThreadConfig(vdo), 0);
+  recovery->logicalThreadID
+    = getLogicalZoneThread(getThreadConfig(vdo), zoneNumber);
 
-  // Organize the journal entries into a binary heap so we can iterate over
-  // them in sorted order incrementally, avoiding an expensive sort call.
-  initializeHeap(&recovery->replayHeap, compareMappings, journalEntries,
-                 entryCount, sizeof(NumberedBlockMapping));
-  buildHeap(&recovery->replayHeap, entryCount);
+  *recoveryPtr = recovery;
+  return VDO_SUCCESS;
+}
 
-  ASSERT_LOG_ONLY((getCallbackThreadID() == recovery->logicalThreadID),
-                  "%s must be called on logical thread %u (not %u)", __func__,
-                  recovery->logicalThreadID, getCallbackThreadID());
-  prepareCompletion(&recovery->completion, finishBlockMapRecovery,
-                    finishBlockMapRecovery, recovery->logicalThreadID, parent);
+/**
+ * Get the logical zone which will replay the entries for a block map page.
+ * Any fixed assignment of pages to zones will do, since no page is touched
+ * by more than one zone and every zone's cache is flushed when it finishes.
+ * This relies on no cache holding a copy of a page from before the replay;
+ * a caller which has read pages through a cache must invalidate it first.
+ *
+ * @param entry      The journal entry
+ * @param zoneCount  The number of logical zones
+ *
+ * @return The zone which will replay the entry
+ **/
+static inline ZoneCount getEntryZone(const NumberedBlockMapping *entry,
+                                     ZoneCount                   zoneCount)
+{
+  return (entry->blockMapSlot.pbn % zoneCount);
+}
 
-  // This message must be recognizable by VDOTest::RebuildBase.
-  logInfo("Replaying %zu recovery entries into block map",
-          recovery->replayHeap.count);
+/**
+ * Partition the journal entries in place so that the entries for each zone
+ * are contiguous, in zone order. The order of the entries within each zone is
+ * not preserved, but the entry numbers are, which is all the replay heap
+ * needs.
+ *
+ * @param replay   The replay whose zone boundaries are to be recorded
+ * @param entries  The journal entries to partition
+ **/
+static void partitionEntries(BlockMapReplay       *replay,
+                             NumberedBlockMapping *entries)
+{
+  ZoneCount  zoneCount = replay->zoneCount;
+  BlockCount next[MAX_LOGICAL_ZONES];
+  memset(next, 0, sizeof(next));
+  for (BlockCount i = 0; i < replay->entryCount; i++) {
+    next[getEntryZone(&entries[i], zoneCount)]++;
+  }
 
-  *recoveryPtr = recovery;
-  return VDO_SUCCESS;
+  BlockCount start = 0;
+  for (ZoneCount zone = 0; zone < zoneCount; zone++) {
+    BlockCount count       = next[zone];
+    next[zone]             = start;
+    start                 += count;
+    replay->zoneEnds[zone] = start;
+  }
+
+  // Swap each misplaced entry into the next free slot of its own zone.
+  for (ZoneCount zone = 0; zone < zoneCount; zone++) {
+    while (next[zone] < replay->zoneEnds[zone]) {
+      NumberedBlockMapping *entry = &entries[next[zone]];
+      ZoneCount entryZone = getEntryZone(entry, zoneCount);
+      if (entryZone == zone) {
+        next[zone]++;
+        continue;
+      }
+
+      NumberedBlockMapping temp = entries[next[entryZone]];
+      entries[next[entryZone]++] = *entry;
+      *entry = temp;
+    }
+  }
+}
+
+/**
+ * Divide the sorted journal entries of a staged replay into a contiguous run
+ * for each zone, of roughly equal size, without splitting the entries for any
+ * one page between zones.
+ *
+ * @param replay  The replay whose zone boundaries are to be recorded
+ **/
+static void divideSortedEntries(BlockMapReplay *replay)
+{
+  NumberedBlockMapping *entries = replay->entries;
+  BlockCount            start   = 0;
+  for (ZoneCount zone = 0; zone < replay->zoneCount; zone++) {
+    BlockCount end = maxBlockCount(start,
+                                   ((replay->entryCount * (zone + 1))
+                                    / replay->zoneCount));
+    while ((end > start) && (end < replay->entryCount)
+           && (entries[end].blockMapSlot.pbn
+               == entries[end - 1].blockMapSlot.pbn)) {
+      end++;
+    }
+
+    replay->zoneEnds[zone] = end;
+    start                  = end;
+  }
 }
 
 /**
@@ -246,7 +468,6 @@ static bool finishIfDone(BlockMapRecoveryCompletion *recovery)
     return false;
   }
 
-  VDOPageCache *cache = getBlockMapZone(recovery->blockMap, 0)->pageCache;
   if (recovery->aborted) {
     /*
      * We need to be careful here to only free completions that exist. But
@@ -262,7 +483,7 @@ static bool finishIfDone(BlockMapRecoveryCompletion *recovery)
   } else {
     logInfo("Flushing block map changes");
     prepareToFinishParent(&recovery->subTaskCompletion, &recovery->completion);
-    flushVDOPageCacheAsync(cache, &recovery->subTaskCompletion);
+    flushVDOPageCacheAsync(recovery->pageCache, &recovery->subTaskCompletion);
   }
   return true;
 }
@@ -389,9 +610,9 @@ static void fetchPage(BlockMapRecoveryCompletion *recovery,
     = recovery->currentUnfetchedEntry->blockMapSlot.pbn;
   recovery->currentUnfetchedEntry
     = findEntryStartingNextPage(recovery, recovery->currentUnfetchedEntry,
-                                true);
+                                !recovery->replay->staged);
   initVDOPageCompletion(((VDOPageCompletion *) completion),
-                        recovery->blockMap->zones[0].pageCache,
+                        recovery->pageCache,
                         newPBN, true, &recovery->completion,
                         pageLoaded, handlePageLoadError);
   recovery->outstanding++;
@@ -462,29 +683,39 @@ static void recoverReadyPages(BlockMapRecoveryCompletion *recovery,
   }
 }
 
-/**********************************************************************/
-void recoverBlockMap(VDO                  *vdo,
-                     BlockCount            entryCount,
-                     NumberedBlockMapping *journalEntries,
-                     VDOCompletion        *parent)
+/**
+ * Begin replaying the entries for one zone. This callback is launched from
+ * launchZoneRecoveries() on the zone's logical thread.
+ *
+ * @param completion  The BlockMapRecoveryCompletion for the zone
+ **/
+static void startZoneRecovery(VDOCompletion *completion)
 {
-  BlockMapRecoveryCompletion *recovery;
-  int result = makeRecoveryCompletion(vdo, entryCount, journalEntries, parent,
-                                      &recovery);
-  if (result != VDO_SUCCESS) {
-    finishCompletion(parent, result);
-    return;
-  }
+  BlockMapRecoveryCompletion *recovery
+    = asBlockMapRecoveryCompletion(completion);
+  ASSERT_LOG_ONLY((getCallbackThreadID() == recovery->logicalThreadID),
+                  "%s must be called on logical thread %u (not %u)", __func__,
+                  recovery->logicalThreadID, getCallbackThreadID());
+  prepareCompletion(completion, finishBlockMapRecovery, finishBlockMapRecovery,
+                    recovery->logicalThreadID, recovery->replay->parent);
 
-  if (isHeapEmpty(&recovery->replayHeap)) {
+  if (recovery->entryCount == 0) {
     finishCompletion(&recovery->completion, VDO_SUCCESS);
     return;
   }
 
-  NumberedBlockMapping *firstSortedEntry
-    = sortNextHeapElement(&recovery->replayHeap);
-  ASSERT_LOG_ONLY(firstSortedEntry == recovery->currentEntry,
-                  "heap is returning elements in an unexpected order");
+  if (!recovery->replay->staged) {
+    // Organize the journal entries into a binary heap so we can iterate over
+    // them in sorted order incrementally, avoiding an expensive sort call.
+    initializeHeap(&recovery->replayHeap, compareMappings,
+                   recovery->journalEntries, recovery->entryCount,
+                   sizeof(NumberedBlockMapping));
+    buildHeap(&recovery->replayHeap, recovery->entryCount);
+    NumberedBlockMapping *firstSortedEntry
+      = sortNextHeapElement(&recovery->replayHeap);
+    ASSERT_LOG_ONLY(firstSortedEntry == recovery->currentEntry,
+                    "heap is returning elements in an unexpected order");
+  }
 
   // Prevent any page from being processed until all pages have been launched.
   recovery->launching = true;
@@ -502,3 +733,189 @@ void recoverBlockMap(VDO                  *vdo,
   // Process any ready pages.
   recoverReadyPages(recovery, &recovery->pageCompletions[0].completion);
 }
+
+/**
+ * Make the recovery completion for each zone of a replay whose zone
+ * boundaries have been recorded.
+ *
+ * @param replay   The replay
+ * @param entries  The journal entries being replayed
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+static int makeZoneRecoveries(BlockMapReplay       *replay,
+                              NumberedBlockMapping *entries)
+{
+  BlockCount start = 0;
+  for (ZoneCount zone = 0; zone < replay->zoneCount; zone++) {
+    int result = makeRecoveryCompletion(replay, zone,
+                                        replay->zoneEnds[zone] - start,
+                                        &entries[start],
+                                        &replay->zones[zone]);
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+
+    start = replay->zoneEnds[zone];
+  }
+
+  return VDO_SUCCESS;
+}
+
+/**
+ * Launch the recovery of every zone of a replay.
+ *
+ * @param replay  The replay to launch
+ **/
+static void launchZoneRecoveries(BlockMapReplay *replay)
+{
+  // The last zone to finish frees the replay, which can not happen until
+  // every zone has been launched, so don't touch it after the last launch.
+  ZoneCount zoneCount = replay->zoneCount;
+  atomicStore32(&replay->zonesReplaying, zoneCount);
+  for (ZoneCount zone = 0; zone < zoneCount; zone++) {
+    BlockMapRecoveryCompletion *recovery = replay->zones[zone];
+    launchCallback(&recovery->completion, startZoneRecovery,
+                   recovery->logicalThreadID);
+  }
+}
+
+/**
+ * Allocate a replay and initialize the fields common to normal and staged
+ * replays.
+ *
+ * @param [in]  vdo         The VDO
+ * @param [in]  entryCount  The number of journal entries to replay
+ * @param [out] replayPtr   A pointer to hold the new replay
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+static int makeBlockMapReplay(VDO             *vdo,
+                              BlockCount       entryCount,
+                              BlockMapReplay **replayPtr)
+{
+  BlockMapReplay *replay;
+  int result = ALLOCATE(1, BlockMapReplay, __func__, &replay);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  replay->vdo        = vdo;
+  replay->entryCount = entryCount;
+  replay->zoneCount  = getThreadConfig(vdo)->logicalZoneCount;
+  atomicStore32(&replay->result, VDO_SUCCESS);
+  *replayPtr = replay;
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void recoverBlockMap(VDO                  *vdo,
+                     BlockCount            entryCount,
+                     NumberedBlockMapping *journalEntries,
+                     VDOCompletion        *parent)
+{
+  BlockMapReplay *replay;
+  int result = makeBlockMapReplay(vdo, entryCount, &replay);
+  if (result != VDO_SUCCESS) {
+    finishCompletion(parent, result);
+    return;
+  }
+
+  replay->parent    = parent;
+  replay->startTime = nowUsec();
+
+  // This message must be recognizable by VDOTest::RebuildBase.
+  logInfo("Replaying %" PRIu64 " recovery entries into block map",
+          entryCount);
+
+  partitionEntries(replay, journalEntries);
+  result = makeZoneRecoveries(replay, journalEntries);
+  if (result != VDO_SUCCESS) {
+    freeBlockMapReplay(&replay);
+    finishCompletion(parent, result);
+    return;
+  }
+
+  launchZoneRecoveries(replay);
+}
+
+/**********************************************************************/
+int stageBlockMapRecovery(VDO                   *vdo,
+                          BlockCount             entryCount,
+                          NumberedBlockMapping  *journalEntries,
+                          BlockMapReplay       **replayPtr)
+{
+  BlockMapReplay *replay;
+  int result = makeBlockMapReplay(vdo, entryCount, &replay);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  // Sort the entries completely so that the entries for any page can be
+  // found with a binary search. The array ends up in descending order, which
+  // is the order in which the zone recoveries expect to walk it backwards.
+  Heap heap;
+  initializeHeap(&heap, compareMappings, journalEntries, entryCount,
+                 sizeof(NumberedBlockMapping));
+  buildHeap(&heap, entryCount);
+  sortHeap(&heap);
+
+  replay->staged  = true;
+  replay->entries = journalEntries;
+  divideSortedEntries(replay);
+  result = makeZoneRecoveries(replay, journalEntries);
+  if (result != VDO_SUCCESS) {
+    // The caller still owns the entries.
+    replay->entries = NULL;
+    freeBlockMapReplay(&replay);
+    return result;
+  }
+
+  for (ZoneCount zone = 0; zone < replay->zoneCount; zone++) {
+    getBlockMapZone(getBlockMap(vdo), zone)->pendingReplay = replay;
+  }
+
+  *replayPtr = replay;
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void replayStagedBlockMap(BlockMapReplay *replay, VDOCompletion *parent)
+{
+  replay->parent    = parent;
+  replay->startTime = nowUsec();
+  logInfo("Replaying %" PRIu64 " recovery entries into block map"
+          " in the background", replay->entryCount);
+  launchZoneRecoveries(replay);
+}
+
+/**********************************************************************/
+void applyStagedBlockMapEntries(const BlockMapReplay *replay,
+                                BlockMapPage         *page,
+                                PhysicalBlockNumber   pbn)
+{
+  // The entries are sorted by descending PBN, so find the first one which
+  // is not above the page.
+  const NumberedBlockMapping *entries = replay->entries;
+  BlockCount                  low     = 0;
+  BlockCount                  high    = replay->entryCount;
+  while (low < high) {
+    BlockCount middle = low + ((high - low) / 2);
+    if (entries[middle].blockMapSlot.pbn > pbn) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  BlockCount end = low;
+  while ((end < replay->entryCount) && (entries[end].blockMapSlot.pbn == pbn)) {
+    end++;
+  }
+
+  // Apply the entries for the page in journal order, which is backwards.
+  for (BlockCount i = end; i > low; i--) {
+    page->entries[entries[i - 1].blockMapSlot.slot]
+      = entries[i - 1].blockMapEntry;
+  }
+}
@@ -23,6 +23,7 @@
 #define BLOCK_MAP_RECOVERY_H
 
 #include "blockMap.h"
+#include "blockMapPage.h"
 #include "blockMappingState.h"
 #include "types.h"
 
@@ -50,4 +51,55 @@ void recoverBlockMap(VDO                   *vdo,
                      NumberedBlockMapping  *journalEntries,
                      VDOCompletion         *parent);
 
+/**
+ * Prepare a block map recovery to be run while the VDO is online. The journal
+ * entries are sorted and attached to every zone of the block map so that any
+ * page loaded before the replay has finished will have its entries applied as
+ * it is loaded. This must be called before the block map is in use.
+ *
+ * @param [in]  vdo             The VDO
+ * @param [in]  entryCount      The number of journal entries
+ * @param [in]  journalEntries  An array of journal entries to process; on
+ *                              success, the replay takes ownership of it
+ * @param [out] replayPtr       A pointer to hold the staged replay
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+int stageBlockMapRecovery(VDO                   *vdo,
+                          BlockCount             entryCount,
+                          NumberedBlockMapping  *journalEntries,
+                          BlockMapReplay       **replayPtr)
+  __attribute__((warn_unused_result));
+
+/**
+ * Replay a staged block map recovery in the background. Once every replayed
+ * page has been flushed, the replay is detached from the block map and
+ * freed, and the parent is notified.
+ *
+ * @param replay  The staged replay
+ * @param parent  The completion to notify when the replay is complete
+ **/
+void replayStagedBlockMap(BlockMapReplay *replay, VDOCompletion *parent);
+
+/**
+ * Free a staged block map replay which was never launched and null out the
+ * reference to it.
+ *
+ * @param replayPtr  A pointer to the replay to free
+ **/
+void freeBlockMapReplay(BlockMapReplay **replayPtr);
+
+/**
+ * Apply the journal entries of a staged replay to a block map page which has
+ * just been loaded. Since only the replay modifies pages until it is done,
+ * applying the entries more than once is harmless.
+ *
+ * @param replay  The staged replay
+ * @param page    The page which was loaded
+ * @param pbn     The physical block number of the page
+ **/
+void applyStagedBlockMapEntries(const BlockMapReplay *replay,
+                                BlockMapPage         *page,
+                                PhysicalBlockNumber   pbn);
+
 #endif // BLOCK_MAP_RECOVERY_H
@@ -26,6 +26,7 @@
 #include "blockMap.h"
 #include "blockMapInternals.h"
 #include "blockMapPage.h"
+#include "blockMapRecovery.h"
 #include "blockMapTreeInternals.h"
 #include "constants.h"
 #include "dataVIO.h"
@@ -836,6 +837,9 @@ static void finishBlockMapPageLoad(VDOCompletion *completion)
   if (!copyValidPage(entry->buffer, nonce, pbn, page)) {
     formatBlockMapPage(page, nonce, pbn, false);
   }
+  if (zone->mapZone->pendingReplay != NULL) {
+    applyStagedBlockMapEntries(zone->mapZone->pendingReplay, page, pbn);
+  }
   returnVIOToPool(zone->vioPool, entry);
 
   // Release our claim to the load and wake any waiters
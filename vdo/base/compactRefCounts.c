@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA. 
+ */
+
+#include "compactRefCounts.h"
+
+#include "memoryAlloc.h"
+
+#include "statusCodes.h"
+
+/**
+ * A counter greater than one, recorded in the exception table.
+ **/
+typedef struct {
+  /** The index of the counter */
+  SlabBlockNumber index;
+  /** The value of the counter */
+  ReferenceCount  count;
+} SharedCounter;
+
+struct compactRefCounts {
+  /** The number of counters represented */
+  BlockCount     blockCount;
+  /** The number of counters greater than one */
+  size_t         sharedCount;
+  /** The counters greater than one, in increasing order of index */
+  SharedCounter *shared;
+  /** The number of words in the referenced bitmap */
+  size_t         wordCount;
+  /** One bit for each counter, set if the counter is not zero */
+  uint64_t       referenced[];
+};
+
+/**********************************************************************/
+int makeCompactRefCounts(const ReferenceCount  *counters,
+                         BlockCount             blockCount,
+                         CompactRefCounts     **compactPtr)
+{
+  size_t sharedCount = 0;
+  for (BlockCount i = 0; i < blockCount; i++) {
+    if (counters[i] == PROVISIONAL_REFERENCE_COUNT) {
+      return VDO_COMPONENT_BUSY;
+    }
+
+    if (counters[i] > 1) {
+      sharedCount++;
+    }
+  }
+
+  size_t wordCount = (blockCount + 63) / 64;
+  CompactRefCounts *compact;
+  int result = ALLOCATE_EXTENDED(CompactRefCounts, wordCount, uint64_t,
+                                 "compact ref counts", &compact);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  if (sharedCount > 0) {
+    result = ALLOCATE(sharedCount, SharedCounter, "shared ref counts",
+                      &compact->shared);
+    if (result != VDO_SUCCESS) {
+      FREE(compact);
+      return result;
+    }
+  }
+
+  compact->blockCount  = blockCount;
+  compact->sharedCount = sharedCount;
+  compact->wordCount   = wordCount;
+
+  size_t shared = 0;
+  for (BlockCount i = 0; i < blockCount; i++) {
+    if (counters[i] == EMPTY_REFERENCE_COUNT) {
+      continue;
+    }
+
+    compact->referenced[i / 64] |= (1ULL << (i % 64));
+    if (counters[i] > 1) {
+      compact->shared[shared++] = (SharedCounter) {
+        .index = i,
+        .count = counters[i],
+      };
+    }
+  }
+
+  *compactPtr = compact;
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void freeCompactRefCounts(CompactRefCounts **compactPtr)
+{
+  CompactRefCounts *compact = *compactPtr;
+  if (compact == NULL) {
+    return;
+  }
+
+  FREE(compact->shared);
+  FREE(compact);
+  *compactPtr = NULL;
+}
+
+/**********************************************************************/
+size_t getCompactRefCountsSize(const CompactRefCounts *compact)
+{
+  return (sizeof(CompactRefCounts)
+          + (compact->wordCount * sizeof(uint64_t))
+          + (compact->sharedCount * sizeof(SharedCounter)));
+}
+
+/**********************************************************************/
+ReferenceCount getCompactReferenceCount(const CompactRefCounts *compact,
+                                        SlabBlockNumber         index)
+{
+  if ((compact->referenced[index / 64] & (1ULL << (index % 64))) == 0) {
+    return EMPTY_REFERENCE_COUNT;
+  }
+
+  size_t low  = 0;
+  size_t high = compact->sharedCount;
+  while (low < high) {
+    size_t middle = low + ((high - low) / 2);
+    SlabBlockNumber sharedIndex = compact->shared[middle].index;
+    if (sharedIndex == index) {
+      return compact->shared[middle].count;
+    }
+
+    if (sharedIndex < index) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+
+  return 1;
+}
+
+/**********************************************************************/
+void clearCompactRefCounts(CompactRefCounts *compact)
+{
+  memset(compact->referenced, 0, compact->wordCount * sizeof(uint64_t));
+  FREE(compact->shared);
+  compact->shared      = NULL;
+  compact->sharedCount = 0;
+}
+
+/**********************************************************************/
+void expandCompactRefCounts(const CompactRefCounts *compact,
+                            ReferenceCount         *counters)
+{
+  for (size_t word = 0; word < compact->wordCount; word++) {
+    uint64_t bits = compact->referenced[word];
+    while (bits != 0) {
+      counters[(word * 64) + __builtin_ctzll(bits)] = 1;
+      bits &= (bits - 1);
+    }
+  }
+
+  for (size_t i = 0; i < compact->sharedCount; i++) {
+    counters[compact->shared[i].index] = compact->shared[i].count;
+  }
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA. 
+ */
+
+#ifndef COMPACT_REF_COUNTS_H
+#define COMPACT_REF_COUNTS_H
+
+#include "referenceBlock.h"
+#include "slab.h"
+#include "types.h"
+
+/**
+ * A CompactRefCounts holds the reference counters of a slab which is not
+ * being modified in much less memory than one byte per block. Since nearly
+ * every counter of such a slab is zero or one, each counter is represented by
+ * a single bit which is set if the counter is not zero, and the few counters
+ * greater than one are kept in a sorted exception table. Provisional
+ * references can not be represented.
+ **/
+typedef struct compactRefCounts CompactRefCounts;
+
+/**
+ * Build the compact form of an array of reference counters.
+ *
+ * @param [in]  counters    The counters to compact
+ * @param [in]  blockCount  The number of counters
+ * @param [out] compactPtr  A pointer to hold the compact counters
+ *
+ * @return VDO_SUCCESS, VDO_COMPONENT_BUSY if any of the counters is
+ *         provisional, or an error code
+ **/
+int makeCompactRefCounts(const ReferenceCount  *counters,
+                         BlockCount             blockCount,
+                         CompactRefCounts     **compactPtr)
+  __attribute__((warn_unused_result));
+
+/**
+ * Free a CompactRefCounts and null out the reference to it.
+ *
+ * @param compactPtr  The reference to the compact counters to free
+ **/
+void freeCompactRefCounts(CompactRefCounts **compactPtr);
+
+/**
+ * Get the number of bytes of memory used by a CompactRefCounts.
+ *
+ * @param compact  The compact counters
+ *
+ * @return The size of the compact counters
+ **/
+size_t getCompactRefCountsSize(const CompactRefCounts *compact)
+  __attribute__((warn_unused_result));
+
+/**
+ * Get the value of one counter from a CompactRefCounts.
+ *
+ * @param compact  The compact counters
+ * @param index    The index of the counter
+ *
+ * @return The value of the counter
+ **/
+ReferenceCount getCompactReferenceCount(const CompactRefCounts *compact,
+                                        SlabBlockNumber         index)
+  __attribute__((warn_unused_result));
+
+/**
+ * Set every counter of a CompactRefCounts to zero.
+ *
+ * @param compact  The compact counters to clear
+ **/
+void clearCompactRefCounts(CompactRefCounts *compact);
+
+/**
+ * Expand a CompactRefCounts back into an array of reference counters.
+ *
+ * @param compact   The compact counters
+ * @param counters  The array to fill, which must already be zeroed and large
+ *                  enough to hold every counter
+ **/
+void expandCompactRefCounts(const CompactRefCounts *compact,
+                            ReferenceCount         *counters);
+
+#endif // COMPACT_REF_COUNTS_H
@@ -46,6 +46,7 @@ typedef enum __attribute__((packed)) {
   GENERATION_FLUSHED_COMPLETION,
   HEARTBEAT_COMPLETION,
   LOCK_COUNTER_COMPLETION,
+  ONLINE_RECOVERY_COMPLETION,
   PARTITION_COPY_COMPLETION,
   READ_ONLY_MODE_COMPLETION,
   READ_ONLY_REBUILD_COMPLETION,
@@ -100,11 +100,13 @@ bool mayCompressDataVIO(DataVIO *dataVIO)
   if (!hasAllocation(dataVIO)
       || ((getWritePolicy(getVDOFromDataVIO(dataVIO)) == WRITE_POLICY_ASYNC)
           && vioRequiresFlushAfter(dataVIOAsVIO(dataVIO)))
-      || !getVDOCompressing(getVDOFromDataVIO(dataVIO))) {
+      || !getVDOCompressing(getVDOFromDataVIO(dataVIO))
+      || dataVIO->skipCompression) {
     /*
      * If this VIO didn't get an allocation, the compressed write probably
      * won't either, so don't try compressing it. Also, if compression is off,
-     * don't compress.
+     * or the layer has asked that this write not be compressed, don't
+     * compress.
      */
     setCompressionDone(dataVIO);
     return false;
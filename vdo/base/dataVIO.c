@@ -76,9 +76,11 @@ static const char *ASYNC_OPERATION_NAMES[] = {
  **/
 static void initializeLBNLock(DataVIO *dataVIO, LogicalBlockNumber lbn)
 {
-  LBNLock *lock = &dataVIO->logical;
-  lock->lbn     = lbn;
-  lock->locked  = false;
+  LBNLock *lock         = &dataVIO->logical;
+  lock->lbn             = lbn;
+  lock->locked          = false;
+  lock->optimistic      = false;
+  lock->writeGeneration = 0;
   initializeWaitQueue(&lock->waiters);
 
   VDO *vdo = getVDOFromDataVIO(dataVIO);
@@ -101,7 +103,8 @@ void prepareDataVIO(DataVIO            *dataVIO,
 
   resetAllocation(dataVIOAsAllocatingVIO(dataVIO));
 
-  dataVIO->isDuplicate = false;
+  dataVIO->isDuplicate   = false;
+  dataVIO->trimmedBlocks = 1;
 
   memset(&dataVIO->chunkName, 0, sizeof(dataVIO->chunkName));
   memset(&dataVIO->duplicate, 0, sizeof(dataVIO->duplicate));
@@ -215,6 +218,9 @@ static void launchLockedRequest(DataVIO *dataVIO)
 {
   dataVIOAddTraceRecord(dataVIO, THIS_LOCATION(NULL));
   dataVIO->logical.locked = true;
+  if (!isReadDataVIO(dataVIO)) {
+    noteLogicalBlockWriter(dataVIO->logical.zone, dataVIO->logical.lbn);
+  }
 
   if (isWriteDataVIO(dataVIO)) {
     launchWriteDataVIO(dataVIO);
@@ -235,8 +241,23 @@ void attemptLogicalBlockLock(VDOCompletion *completion)
     return;
   }
 
-  DataVIO *lockHolder;
   LBNLock *lock = &dataVIO->logical;
+  if (dataVIO->mayReadOptimistically
+      && (intMapGet(getLBNLockMap(lock->zone), lock->lbn) == NULL)) {
+    /*
+     * No one holds the lock, so read without taking it. Any writer which
+     * locks the LBN before the read completes will change its write
+     * generation, in which case the read will be redone with the lock held.
+     */
+    lock->optimistic      = true;
+    lock->writeGeneration = getLogicalBlockWriteGeneration(lock->zone,
+                                                           lock->lbn);
+    dataVIOAddTraceRecord(dataVIO, THIS_LOCATION("$F;optimistic"));
+    launchReadDataVIO(dataVIO);
+    return;
+  }
+
+  DataVIO *lockHolder;
   int result = intMapPut(getLBNLockMap(lock->zone), lock->lbn, dataVIO, false,
                          (void **) &lockHolder);
   if (result != VDO_SUCCESS) {
@@ -287,6 +308,14 @@ void attemptLogicalBlockLock(VDOCompletion *completion)
   }
 }
 
+/**********************************************************************/
+bool isOptimisticReadCurrent(DataVIO *dataVIO)
+{
+  LBNLock *lock = &dataVIO->logical;
+  return (getLogicalBlockWriteGeneration(lock->zone, lock->lbn)
+          == lock->writeGeneration);
+}
+
 /**
  * Release an uncontended LBN lock.
  *
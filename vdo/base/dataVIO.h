@@ -90,6 +90,10 @@ struct lbnLock {
   WaitQueue           waiters;
   /* The logical zone of the LBN */
   LogicalZone        *zone;
+  /* Whether this is a read proceeding without holding the lock */
+  bool                optimistic;
+  /* The write generation of the LBN when an optimistic read began */
+  SequenceNumber      writeGeneration;
 };
 
 /*
@@ -179,6 +183,19 @@ struct dataVIO {
   /* Whether this VIO write is a duplicate */
   bool                 isDuplicate;
 
+  /* Whether this read may be serviced without taking its LBN lock */
+  bool                 mayReadOptimistically;
+
+  /* Whether this write must not wait in the packer to be compressed */
+  bool                 skipCompression;
+
+  /*
+   * The number of logical blocks, starting with this one, which a trim has
+   * found to need no work, because they are all on a block map page which
+   * has not been allocated
+   */
+  BlockCount           trimmedBlocks;
+
   /*
    * Whether this VIO has received an allocation (needs to be atomic so it can
    * be examined from threads not in the allocation zone).
@@ -209,6 +226,12 @@ struct dataVIO {
   /* The point in the recovery journal where this write last made an entry */
   JournalPoint         recoveryJournalPoint;
 
+  /*
+   * The point in the slab journal where this write last made an entry, kept
+   * until the reference count update for the entry has been applied
+   */
+  JournalPoint         slabJournalPoint;
+
   /* The RingNode of VIOs in user initiated write requests */
   RingNode             writeNode;
 
@@ -938,6 +961,18 @@ int setMappedLocation(DataVIO             *dataVIO,
  **/
 void attemptLogicalBlockLock(VDOCompletion *completion);
 
+/**
+ * Check whether an optimistic read may still complete, which is the case if no
+ * writer has acquired the lock on the read's LBN since the read looked up its
+ * mapping. This may be called from any thread.
+ *
+ * @param dataVIO  The optimistic read DataVIO
+ *
+ * @return <code>true</code> if the data read is known to be current
+ **/
+bool isOptimisticReadCurrent(DataVIO *dataVIO)
+  __attribute__((warn_unused_result));
+
 /**
  * Release the lock on the logical block, if any, that a DataVIO has acquired.
  *
@@ -34,6 +34,8 @@ struct dirtyLists {
   SequenceNumber  oldestPeriod;
   /** One more than the current period */
   SequenceNumber  nextPeriod;
+  /** No list older than this period has elements */
+  SequenceNumber  firstDirtyPeriod;
   /** The function to call on expired elements */
   DirtyCallback  *callback;
   /** The callback context */
@@ -88,9 +90,10 @@ void freeDirtyLists(DirtyLists **dirtyListsPtr)
 void setCurrentPeriod(DirtyLists *dirtyLists, SequenceNumber period)
 {
   ASSERT_LOG_ONLY(dirtyLists->nextPeriod == 0, "current period not set");
-  dirtyLists->oldestPeriod = period;
-  dirtyLists->nextPeriod   = period + 1;
-  dirtyLists->offset       = period % dirtyLists->maximumAge;
+  dirtyLists->oldestPeriod     = period;
+  dirtyLists->nextPeriod       = period + 1;
+  dirtyLists->firstDirtyPeriod = period;
+  dirtyLists->offset           = period % dirtyLists->maximumAge;
 }
 
 /**
@@ -109,6 +112,10 @@ static void expireOldestList(DirtyLists *dirtyLists)
   if (dirtyLists->offset == dirtyLists->maximumAge) {
     dirtyLists->offset = 0;
   }
+
+  if (dirtyLists->firstDirtyPeriod < dirtyLists->oldestPeriod) {
+    dirtyLists->firstDirtyPeriod = dirtyLists->oldestPeriod;
+  }
 }
 
 /**
@@ -160,6 +167,9 @@ void addToDirtyLists(DirtyLists     *dirtyLists,
   } else {
     updatePeriod(dirtyLists, newPeriod);
     pushRingNode(&dirtyLists->lists[newPeriod % dirtyLists->maximumAge], node);
+    if (newPeriod < dirtyLists->firstDirtyPeriod) {
+      dirtyLists->firstDirtyPeriod = newPeriod;
+    }
   }
 
   writeExpiredElements(dirtyLists);
@@ -181,6 +191,60 @@ void flushDirtyLists(DirtyLists *dirtyLists)
   writeExpiredElements(dirtyLists);
 }
 
+/**
+ * Get the list for a period which has not been expired.
+ *
+ * @param dirtyLists  The DirtyLists
+ * @param period      The period
+ *
+ * @return The list of elements dirtied in that period
+ **/
+static inline RingNode *getList(DirtyLists *dirtyLists, SequenceNumber period)
+{
+  return &dirtyLists->lists[period % dirtyLists->maximumAge];
+}
+
+/**
+ * Skip over empty lists at the old end of the dirty lists. Elements may leave
+ * a list without the DirtyLists noticing, so this is done lazily.
+ *
+ * @param dirtyLists  The DirtyLists
+ **/
+static void skipEmptyLists(DirtyLists *dirtyLists)
+{
+  while ((dirtyLists->firstDirtyPeriod < dirtyLists->nextPeriod)
+         && isRingEmpty(getList(dirtyLists, dirtyLists->firstDirtyPeriod))) {
+    dirtyLists->firstDirtyPeriod++;
+  }
+}
+
+/**********************************************************************/
+BlockCount expireOldestElements(DirtyLists *dirtyLists, BlockCount limit)
+{
+  BlockCount expired = 0;
+  while (expired < limit) {
+    skipEmptyLists(dirtyLists);
+    if ((dirtyLists->firstDirtyPeriod + 1) >= dirtyLists->nextPeriod) {
+      // Leave the current period alone; its elements may still be changing.
+      break;
+    }
+
+    RingNode *list = getList(dirtyLists, dirtyLists->firstDirtyPeriod);
+    pushRingNode(&dirtyLists->expired, chopRingNode(list));
+    expired++;
+  }
+
+  writeExpiredElements(dirtyLists);
+  return expired;
+}
+
+/**********************************************************************/
+BlockCount getOldestDirtyAge(DirtyLists *dirtyLists)
+{
+  skipEmptyLists(dirtyLists);
+  return dirtyLists->nextPeriod - dirtyLists->firstDirtyPeriod;
+}
+
 /**********************************************************************/
 SequenceNumber getDirtyListsNextPeriod(DirtyLists *dirtyLists)
 {
@@ -108,4 +108,29 @@ void advancePeriod(DirtyLists *dirtyLists, SequenceNumber period);
  **/
 void flushDirtyLists(DirtyLists *dirtyLists);
 
+/**
+ * Expire some of the oldest elements ahead of their periods, without
+ * advancing the current period. Elements dirtied in the current period are
+ * never expired this way. The expired elements are passed to the callback as
+ * usual.
+ *
+ * @param dirtyLists  The DirtyLists
+ * @param limit       The maximum number of elements to expire
+ *
+ * @return The number of elements expired
+ **/
+BlockCount expireOldestElements(DirtyLists *dirtyLists, BlockCount limit);
+
+/**
+ * Get the age of the oldest list which may still contain elements, in
+ * periods. An age equal to the maximum age means the oldest elements are
+ * about to be expired.
+ *
+ * @param dirtyLists  The DirtyLists
+ *
+ * @return The age of the oldest non-empty list, or 0 if all are empty
+ **/
+BlockCount getOldestDirtyAge(DirtyLists *dirtyLists)
+  __attribute__((warn_unused_result));
+
 #endif // DIRTY_LISTS_H
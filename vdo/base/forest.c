@@ -161,8 +161,9 @@ static int makeSegment(Forest      *oldForest,
     return result;
   }
 
-  result = ALLOCATE(newPages, TreePage, "new forest pages",
-                    &forest->pages[index]);
+  // Interior pages are read on every lookup, so prefer huge-mapped memory.
+  result = allocateLargeMemory(newPages * sizeof(TreePage), ANY_MEMORY_NODE,
+                               "new forest pages", &forest->pages[index]);
   if (result != VDO_SUCCESS) {
     return result;
   }
@@ -225,7 +226,7 @@ static void deforest(Forest *forest, size_t firstPageSegment)
   if (forest->pages != NULL) {
     for (size_t segment = firstPageSegment; segment < forest->segments;
          segment++) {
-      FREE(forest->pages[segment]);
+      freeLargeMemory(forest->pages[segment]);
     }
     FREE(forest->pages);
   }
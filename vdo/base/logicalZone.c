@@ -33,6 +33,11 @@
 #include "intMap.h"
 #include "vdoInternal.h"
 
+enum {
+  /** The number of LBN write generation counters in each zone */
+  WRITE_GENERATION_COUNT = 1024,
+};
+
 struct logicalZone {
   /** The completion for flush notifications */
   VDOCompletion   completion;
@@ -69,6 +74,8 @@ struct logicalZone {
   VDOCompletion  *closeCompletion;
   /** Whether a close has been requested */
   bool            closeRequested;
+  /** The counts of LBN lock acquisitions by writers, striped by LBN */
+  Atomic64        writeGenerations[WRITE_GENERATION_COUNT];
 };
 
 /**
@@ -204,6 +211,12 @@ ThreadID getLogicalZoneThreadID(const LogicalZone *zone)
   return zone->threadData->threadID;
 }
 
+/**********************************************************************/
+ZoneCount getLogicalZoneNumber(const LogicalZone *zone)
+{
+  return zone->zoneNumber;
+}
+
 /**********************************************************************/
 BlockMapZone *getBlockMapForZone(const LogicalZone *zone)
 {
@@ -282,6 +295,20 @@ SequenceNumber getOldestLockedGeneration(const LogicalZone *zone)
   return (SequenceNumber) atomicLoad64(&zone->oldestLockedGeneration);
 }
 
+/**********************************************************************/
+void noteLogicalBlockWriter(LogicalZone *zone, LogicalBlockNumber lbn)
+{
+  assertOnZoneThread(zone, __func__);
+  atomicAdd64(&zone->writeGenerations[lbn % WRITE_GENERATION_COUNT], 1);
+}
+
+/**********************************************************************/
+SequenceNumber getLogicalBlockWriteGeneration(const LogicalZone  *zone,
+                                              LogicalBlockNumber  lbn)
+{
+  return atomicLoad64(&zone->writeGenerations[lbn % WRITE_GENERATION_COUNT]);
+}
+
 /**********************************************************************/
 int acquireFlushGenerationLock(DataVIO *dataVIO)
 {
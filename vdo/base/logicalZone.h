@@ -66,6 +66,16 @@ void closeLogicalZone(LogicalZone *zone, VDOCompletion *completion);
 ThreadID getLogicalZoneThreadID(const LogicalZone *zone)
   __attribute__((warn_unused_result));
 
+/**
+ * Get the number of a logical zone.
+ *
+ * @param zone  The zone
+ *
+ * @return The zone's number
+ **/
+ZoneCount getLogicalZoneNumber(const LogicalZone *zone)
+  __attribute__((warn_unused_result));
+
 /**
  * Get the portion of the block map for this zone.
  *
@@ -118,6 +128,29 @@ void incrementFlushGeneration(LogicalZone    *zone,
 SequenceNumber getOldestLockedGeneration(const LogicalZone *zone)
   __attribute__((warn_unused_result));
 
+/**
+ * Record that a writer has acquired the lock on a logical block, invalidating
+ * any optimistic reads of that block which are in progress.
+ *
+ * @param zone  The logical zone of the block
+ * @param lbn   The logical block which has been locked
+ **/
+void noteLogicalBlockWriter(LogicalZone *zone, LogicalBlockNumber lbn);
+
+/**
+ * Get the write generation of a logical block. The generation changes
+ * whenever a writer acquires the lock on the block (or on some other block
+ * which shares its generation counter). This may be called from any thread.
+ *
+ * @param zone  The logical zone of the block
+ * @param lbn   The logical block
+ *
+ * @return The current write generation of the block
+ **/
+SequenceNumber getLogicalBlockWriteGeneration(const LogicalZone  *zone,
+                                              LogicalBlockNumber  lbn)
+  __attribute__((warn_unused_result));
+
 /**
  * Acquire the shared lock on a flush generation by a write DataVIO.
  *
@@ -333,6 +333,14 @@ typedef void OperationWaiter(PhysicalLayer *layer);
  **/
 typedef void OperationComplete(PhysicalLayer *layer);
 
+/**
+ * A function to let the layer submit the writes it has been holding back
+ * while the VDO recovered its block map in the background.
+ *
+ * @param layer  The layer which has been holding writes
+ **/
+typedef void HeldWritesReleaser(PhysicalLayer *layer);
+
 /**
  * A function to get the id of the current thread.
  *
@@ -340,6 +348,16 @@ typedef void OperationComplete(PhysicalLayer *layer);
  **/
 typedef ThreadID ThreadIDGetter(void);
 
+/**
+ * A function to get the NUMA node on which a base thread runs.
+ *
+ * @param layer     The layer
+ * @param threadID  The ID of the thread
+ *
+ * @return The node of the thread, or ANY_MEMORY_NODE if it is not bound to one
+ **/
+typedef int ThreadNodeGetter(PhysicalLayer *layer, ThreadID threadID);
+
 /**
  * A function to return the physical layer pointer for the current thread.
  *
@@ -395,9 +413,11 @@ struct physicalLayer {
   Enqueuer                  *enqueue;
   OperationWaiter           *waitForAdminOperation;
   OperationComplete         *completeAdminOperation;
+  HeldWritesReleaser        *releaseHeldWrites;
 
   // Thread specific interface
   ThreadIDGetter            *getCurrentThreadID;
+  ThreadNodeGetter          *getThreadNode;
 };
 
 /**
@@ -27,8 +27,15 @@
 
 #include "statusCodes.h"
 
-/** We use a single 64-bit search vector, so the maximum priority is 63 */
-enum { MAX_PRIORITY = 63 };
+enum {
+  /** The number of buckets flagged by each word of the search vector */
+  BUCKETS_PER_WORD = 64,
+  /**
+   * Each bit of the summary word flags a non-zero word of the search vector,
+   * so the maximum priority is 64 * 64 - 1
+   */
+  MAX_PRIORITY = (BUCKETS_PER_WORD * BUCKETS_PER_WORD) - 1,
+};
 
 /**
  * All the entries with the same priority are queued in a circular list in a
@@ -45,14 +52,17 @@ typedef struct bucket {
  * A priority table is an array of buckets, indexed by priority. New entries
  * are added to the end of the queue in the appropriate bucket. The dequeue
  * operation finds the highest-priority non-empty bucket by searching a bit
- * vector represented as a single 8-byte word, which is very fast with
- * compiler and CPU support.
+ * vector of up to 64 words. A summary word flags the non-zero words of the
+ * vector, so the search takes two highest-bit lookups, which are very fast
+ * with compiler and CPU support.
  **/
 struct priorityTable {
   /** The maximum priority of entries that may be stored in this table */
   unsigned int maxPriority;
+  /** A bit vector flagging all words of the search vector which are not 0 */
+  uint64_t     summaryWord;
   /** A bit vector flagging all buckets that are currently non-empty */
-  uint64_t     searchVector;
+  uint64_t     searchVector[BUCKETS_PER_WORD];
   /** The array of all buckets, indexed by priority */
   Bucket       buckets[];
 };
@@ -90,8 +100,9 @@ int makePriorityTable(unsigned int maxPriority, PriorityTable **tablePtr)
     initializeRing(&bucket->queue);
   }
 
-  table->maxPriority  = maxPriority;
-  table->searchVector = 0;
+  table->maxPriority = maxPriority;
+  table->summaryWord = 0;
+  memset(table->searchVector, 0, sizeof(table->searchVector));
 
   *tablePtr = table;
   return VDO_SUCCESS;
@@ -116,7 +127,8 @@ void freePriorityTable(PriorityTable **tablePtr)
 /**********************************************************************/
 void resetPriorityTable(PriorityTable *table)
 {
-  table->searchVector = 0;
+  table->summaryWord = 0;
+  memset(table->searchVector, 0, sizeof(table->searchVector));
   for (unsigned int priority = 0; priority <= table->maxPriority; priority++) {
     unspliceRingNode(&table->buckets[priority].queue);
   }
@@ -134,13 +146,20 @@ void priorityTableEnqueue(PriorityTable *table,
   pushRingNode(&table->buckets[priority].queue, entry);
 
   // Flag the bucket in the search vector since it must be non-empty.
-  table->searchVector |= (1ULL << priority);
+  unsigned int word = priority / BUCKETS_PER_WORD;
+  table->searchVector[word] |= (1ULL << (priority % BUCKETS_PER_WORD));
+  table->summaryWord        |= (1ULL << word);
 }
 
 /**********************************************************************/
 static inline void markBucketEmpty(PriorityTable *table, Bucket *bucket)
 {
-  table->searchVector &= ~(1ULL << bucket->priority);
+  unsigned int word = bucket->priority / BUCKETS_PER_WORD;
+  unsigned int bit  = bucket->priority % BUCKETS_PER_WORD;
+  table->searchVector[word] &= ~(1ULL << bit);
+  if (table->searchVector[word] == 0) {
+    table->summaryWord &= ~(1ULL << word);
+  }
 }
 
 /**********************************************************************/
@@ -148,13 +167,15 @@ RingNode *priorityTableDequeue(PriorityTable *table)
 {
   // Find the highest priority non-empty bucket by finding the highest-order
   // non-zero bit in the search vector.
-  int topPriority = logBaseTwo(table->searchVector);
-
-  if (topPriority < 0) {
+  int topWord = logBaseTwo(table->summaryWord);
+  if (topWord < 0) {
     // All buckets are empty.
     return NULL;
   }
 
+  int topPriority = ((topWord * BUCKETS_PER_WORD)
+                     + logBaseTwo(table->searchVector[topWord]));
+
   // Dequeue the first entry in the bucket.
   Bucket   *bucket = &table->buckets[topPriority];
   RingNode *entry  = unspliceRingNode(bucket->queue.next);
@@ -191,5 +212,5 @@ void priorityTableRemove(PriorityTable *table, RingNode *entry)
 /**********************************************************************/
 bool isPriorityTableEmpty(PriorityTable *table)
 {
-  return (table->searchVector == 0);
+  return (table->summaryWord == 0);
 }
@@ -41,7 +41,8 @@
  * else while so queued.
  *
  * The table is implemented as an array of queues (circular lists) indexed by
- * priority, along with a hint for which queues are non-empty. Steven Skiena
+ * priority, along with a two-level bit vector hint for which queues are
+ * non-empty, so priorities may range up to 4095. Steven Skiena
  * calls a very similar structure a "bounded height priority queue", but given
  * the resemblance to a hash table, "priority table" seems both shorter and
  * more apt, if somewhat novel.
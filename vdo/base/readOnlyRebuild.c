@@ -126,6 +126,20 @@ static int makeRebuildCompletion(VDO                        *vdo,
   return VDO_SUCCESS;
 }
 
+/**
+ * Set or clear rebuild mode on the page cache of every block map zone, since
+ * the block map replay uses all of them.
+ *
+ * @param map         The block map
+ * @param rebuilding  Whether the caches are rebuilding
+ **/
+static void setBlockMapRebuildMode(BlockMap *map, bool rebuilding)
+{
+  for (ZoneCount zone = 0; zone < map->zoneCount; zone++) {
+    setVDOPageCacheRebuildMode(map->zones[zone].pageCache, rebuilding);
+  }
+}
+
 /**
  * Clean up the rebuild process, whether or not it succeeded, by freeing the
  * rebuild completion and notifying the parent of the outcome.
@@ -138,7 +152,7 @@ static void completeRebuild(VDOCompletion *completion)
   int                        result  = completion->result;
   ReadOnlyRebuildCompletion *rebuild = asReadOnlyRebuildCompletion(completion);
   VDO                       *vdo     = rebuild->vdo;
-  setVDOPageCacheRebuildMode(getBlockMap(vdo)->zones[0].pageCache, false);
+  setBlockMapRebuildMode(getBlockMap(vdo), false);
   freeRebuildCompletion(&rebuild);
   finishCompletion(parent, result);
 }
@@ -364,7 +378,7 @@ static void applyJournalEntries(VDOCompletion *completion)
   }
 
   // Suppress block map errors.
-  setVDOPageCacheRebuildMode(getBlockMap(vdo)->zones[0].pageCache, true);
+  setBlockMapRebuildMode(getBlockMap(vdo), true);
 
   // Play the recovery journal into the block map.
   prepareCompletion(completion, launchReferenceCountRebuild,
@@ -25,6 +25,7 @@
 #include "buffer.h"
 #include "logger.h"
 #include "memoryAlloc.h"
+#include "timeUtils.h"
 
 #include "blockMap.h"
 #include "constants.h"
@@ -55,6 +56,16 @@ static const Header RECOVERY_JOURNAL_HEADER_7_0 = {
 
 static const uint64_t RECOVERY_COUNT_MASK = 0xff;
 
+/**
+ * The longest a partially filled block will be held open to gather more
+ * entries, in microseconds. Blocks are only held when entries have been
+ * arriving faster than this.
+ **/
+static const uint64_t GROUP_COMMIT_WINDOW = 50;
+
+/** Arrival gaps longer than this are treated as idle time (microseconds) */
+static const uint64_t MAXIMUM_ARRIVAL_GAP = 1000000;
+
 enum {
   /*
    * The number of reserved blocks must be large enough to prevent a
@@ -405,6 +416,7 @@ int makeRecoveryJournal(Nonce                 nonce,
   journal->size            = journalSize;
   journal->readOnlyContext = readOnlyContext;
   journal->tail            = 1;
+  journal->meanArrivalGap  = MAXIMUM_ARRIVAL_GAP;
   journal->slabJournalCommitThreshold = (journalSize * 2) / 3;
   initializeJournalState(journal);
 
@@ -450,6 +462,14 @@ int makeRecoveryJournal(Nonce                 nonce,
       return result;
     }
 
+    result = initializeEnqueueableCompletion(&journal->groupCommitCompletion,
+                                             RECOVERY_JOURNAL_COMPLETION,
+                                             layer);
+    if (result != VDO_SUCCESS) {
+      freeRecoveryJournal(&journal);
+      return result;
+    }
+
     setActiveBlock(journal);
     journal->flushVIO->completion.callbackThreadID = journal->threadID;
   }
@@ -468,6 +488,7 @@ void freeRecoveryJournal(RecoveryJournal **journalPtr)
 
   freeLockCounter(&journal->lockCounter);
   freeVIO(&journal->flushVIO);
+  destroyEnqueueable(&journal->groupCommitCompletion);
   FREE(journal->unusedFlushVIOData);
 
   ASSERT_LOG_ONLY(isRingEmpty(&journal->activeTailBlocks),
@@ -946,6 +967,38 @@ static void notifyCommitWaiters(RecoveryJournal *journal)
   }
 }
 
+/**
+ * Get the histogram bucket for a value. Bucket i holds values in
+ * [2^i, 2^(i+1)), except that the first also holds 0 and the last holds
+ * everything larger.
+ *
+ * @param value  The value to record
+ *
+ * @return The bucket for the value
+ **/
+static inline unsigned int getHistogramBucket(uint64_t value)
+{
+  int bucket = logBaseTwo(value);
+  if (bucket < 0) {
+    return 0;
+  }
+  return ((bucket < JOURNAL_HISTOGRAM_BUCKETS)
+          ? bucket : (JOURNAL_HISTOGRAM_BUCKETS - 1));
+}
+
+/**
+ * Record the size and latency of a commit which has just finished.
+ *
+ * @param journal  The journal
+ * @param block    The block which was committed
+ **/
+static void recordCommit(RecoveryJournal *journal, RecoveryJournalBlock *block)
+{
+  uint64_t latency = nowUsec() - block->commitStart;
+  journal->events.entriesPerCommit[getHistogramBucket(block->entriesInCommit)]++;
+  journal->events.commitLatency[getHistogramBucket(latency)]++;
+}
+
 /**
  * Handle post-commit processing. This is the callback registered by
  * writeBlock(). If more entries accumulated in the block being committed while
@@ -962,6 +1015,7 @@ static void completeWrite(VDOCompletion *completion)
   journal->pendingWriteCount        -= 1;
   journal->events.blocks.committed  += 1;
   journal->events.entries.committed += block->entriesInCommit;
+  recordCommit(journal, block);
   block->uncommittedEntryCount      -= block->entriesInCommit;
   block->entriesInCommit             = 0;
   block->committing                  = false;
@@ -999,10 +1053,133 @@ static void handleWriteError(VDOCompletion *completion)
   completeWrite(completion);
 }
 
+/**
+ * Attempt to commit a block without considering whether to hold it open.
+ *
+ * @param journal  The recovery journal
+ * @param block    The block to write
+ **/
+static void commitBlock(RecoveryJournal *journal, RecoveryJournalBlock *block)
+{
+  int result = commitRecoveryBlock(block, completeWrite, handleWriteError);
+  if (result != VDO_SUCCESS) {
+    enterJournalReadOnlyMode(journal, result);
+    return;
+  }
+}
+
+/**
+ * Check whether a group commit window should remain open, which is the case
+ * while entries keep arriving and the window has not reached its limit.
+ *
+ * @param journal  The journal
+ *
+ * @return <code>true</code> if the held block should be held longer
+ **/
+static bool shouldExtendGroupCommit(RecoveryJournal *journal)
+{
+  if (journal->closeRequested || isReadOnly(journal->readOnlyContext)
+      || (journal->arrivalsDuringHold == 0)) {
+    return false;
+  }
+
+  RecoveryJournalBlock *block = journal->activeBlock;
+  return ((block != NULL) && !block->committing && !isRecoveryBlockFull(block)
+          && ((nowUsec() - journal->holdStart) < GROUP_COMMIT_WINDOW));
+}
+
+/**
+ * Requeue the group commit completion behind any work already queued on the
+ * journal thread, which includes entries about to be added.
+ *
+ * @param journal  The journal
+ **/
+static void requeueGroupCommit(RecoveryJournal *journal);
+
+/**
+ * Close a group commit window, committing the held block, and any block which
+ * filled while it was held, unless entries are still arriving. This callback
+ * is registered in requeueGroupCommit().
+ *
+ * @param completion  The group commit completion
+ **/
+static void finishGroupCommit(VDOCompletion *completion)
+{
+  RecoveryJournal *journal = completion->parent;
+  if (shouldExtendGroupCommit(journal)) {
+    requeueGroupCommit(journal);
+    return;
+  }
+
+  journal->holdingCommit = false;
+  if (isReadOnly(journal->readOnlyContext)) {
+    notifyCommitWaiters(journal);
+    checkForClosure(journal);
+    return;
+  }
+
+  // Blocks which filled during the hold were passed over by assignEntry(), so
+  // commit every block on the active tail, oldest first.
+  for (RingNode *node = journal->activeTailBlocks.next;
+       node != &journal->activeTailBlocks; node = node->next) {
+    commitBlock(journal, blockFromRingNode(node));
+    if (isReadOnly(journal->readOnlyContext)) {
+      return;
+    }
+  }
+}
+
+/**********************************************************************/
+static void requeueGroupCommit(RecoveryJournal *journal)
+{
+  journal->arrivalsDuringHold = 0;
+  prepareForRequeue(&journal->groupCommitCompletion, finishGroupCommit,
+                    finishGroupCommit, journal->threadID, journal);
+  invokeCallback(&journal->groupCommitCompletion);
+}
+
+/**
+ * Check whether to hold a partially filled block open briefly rather than
+ * committing it now. A block is held only if it could be committed now and
+ * entries have recently been arriving quickly enough that more are likely
+ * within the group commit window. At low load, blocks are never held.
+ *
+ * @param journal  The journal
+ * @param block    The block which is about to be committed
+ *
+ * @return <code>true</code> if the commit of the block has been deferred
+ **/
+static bool holdForGroupCommit(RecoveryJournal      *journal,
+                               RecoveryJournalBlock *block)
+{
+  // A full block must always be committed, even while another is held.
+  if ((block == NULL) || block->committing || isRecoveryBlockFull(block)) {
+    return false;
+  }
+
+  if (journal->holdingCommit) {
+    return true;
+  }
+
+  if (!hasWaiters(&block->entryWaiters)
+      || (journal->pendingWriteCount > 0) || journal->closeRequested
+      || isReadOnly(journal->readOnlyContext)
+      || (journal->meanArrivalGap >= GROUP_COMMIT_WINDOW)) {
+    return false;
+  }
+
+  journal->holdingCommit = true;
+  journal->holdStart     = nowUsec();
+  journal->events.groupCommits++;
+  requeueGroupCommit(journal);
+  return true;
+}
+
 /**
  * Attempt to commit a block. If the block is not the oldest block
  * with uncommitted entries or if it is already being committed,
- * nothing will be done.
+ * nothing will be done. A partial block may also be held open briefly
+ * to gather more entries.
  *
  * @param journal  The recovery journal
  * @param block    The block to write
@@ -1010,11 +1187,30 @@ static void handleWriteError(VDOCompletion *completion)
 static void writeBlock(RecoveryJournal *journal, RecoveryJournalBlock *block)
 {
   assertOnJournalThread(journal, __func__);
-  int result = commitRecoveryBlock(block, completeWrite, handleWriteError);
-  if (result != VDO_SUCCESS) {
-    enterJournalReadOnlyMode(journal, result);
+  if (holdForGroupCommit(journal, block)) {
     return;
   }
+
+  commitBlock(journal, block);
+}
+
+/**
+ * Update the moving average of the time between entry arrivals.
+ *
+ * @param journal  The journal
+ **/
+static void noteEntryArrival(RecoveryJournal *journal)
+{
+  uint64_t now = nowUsec();
+  uint64_t gap = now - journal->lastArrival;
+  if (gap > MAXIMUM_ARRIVAL_GAP) {
+    gap = MAXIMUM_ARRIVAL_GAP;
+  }
+
+  journal->lastArrival    = now;
+  journal->meanArrivalGap = (journal->meanArrivalGap
+                             - (journal->meanArrivalGap / 8) + (gap / 8));
+  journal->arrivalsDuringHold++;
 }
 
 /**********************************************************************/
@@ -1031,10 +1227,21 @@ void addRecoveryJournalEntry(RecoveryJournal *journal, DataVIO *dataVIO)
     return;
   }
 
+  if (atomicLoadBool(&journal->entriesHeld)) {
+    int result = enqueueDataVIO(&journal->heldEntryWaiters, dataVIO,
+                                THIS_LOCATION("$F($j-$js);io=journal($j-$js)"));
+    if (result != VDO_SUCCESS) {
+      enterJournalReadOnlyMode(journal, result);
+      continueDataVIO(dataVIO, result);
+    }
+    return;
+  }
+
   bool increment = isIncrementOperation(dataVIO->operation.type);
   ASSERT_LOG_ONLY((!increment || (dataVIO->recoverySequenceNumber == 0)),
                   "journal lock not held for increment");
 
+  noteEntryArrival(journal);
   advanceJournalPoint(&journal->appendPoint, journal->entriesPerBlock);
   int result = enqueueDataVIO((increment
                                ? &journal->incrementWaiters
@@ -1049,6 +1256,46 @@ void addRecoveryJournalEntry(RecoveryJournal *journal, DataVIO *dataVIO)
   assignEntries(journal);
 }
 
+/**********************************************************************/
+void holdRecoveryJournalEntries(RecoveryJournal *journal)
+{
+  atomicStoreBool(&journal->entriesHeld, true);
+}
+
+/**********************************************************************/
+bool areRecoveryJournalEntriesHeld(RecoveryJournal *journal)
+{
+  return atomicLoadBool(&journal->entriesHeld);
+}
+
+/**
+ * Add the entry for a DataVIO which was held while the block map was being
+ * recovered. This callback is registered in releaseRecoveryJournalEntries().
+ *
+ * @param waiter   The DataVIO's waiter
+ * @param context  The journal
+ **/
+static void addHeldEntry(Waiter *waiter, void *context)
+{
+  addRecoveryJournalEntry(context, waiterAsDataVIO(waiter));
+}
+
+/**********************************************************************/
+void releaseRecoveryJournalEntries(RecoveryJournal *journal)
+{
+  assertOnJournalThread(journal, __func__);
+  if (!atomicLoadBool(&journal->entriesHeld)) {
+    return;
+  }
+
+  atomicStoreBool(&journal->entriesHeld, false);
+  size_t held = countWaiters(&journal->heldEntryWaiters);
+  if (held > 0) {
+    logInfo("Releasing %zu writes held during block map recovery", held);
+  }
+  notifyAllWaiters(&journal->heldEntryWaiters, addHeldEntry, journal);
+}
+
 /**
  * Conduct a sweep on a recovery journal to reclaim unreferenced blocks.
  *
@@ -1089,6 +1336,7 @@ static void reapRecoveryJournal(RecoveryJournal *journal)
     return;
   }
 
+  journal->events.reaps++;
   PhysicalLayer *layer = vioAsCompletion(journal->flushVIO)->layer;
   if (layer->isFlushRequired(layer)) {
     /*
@@ -1098,6 +1346,7 @@ static void reapRecoveryJournal(RecoveryJournal *journal)
      * that just released some lock.
      */
     journal->reaping = true;
+    journal->events.reapFlushes++;
     launchFlush(journal->flushVIO, completeReaping, handleFlushError);
     return;
   }
@@ -1171,7 +1420,16 @@ BlockCount getJournalLogicalBlocksUsed(const RecoveryJournal *journal)
 RecoveryJournalStatistics
 getRecoveryJournalStatistics(const RecoveryJournal *journal)
 {
-  return journal->events;
+  RecoveryJournalStatistics stats = journal->events;
+  stats.entriesElided = atomicLoad64(&journal->entriesElided);
+  return stats;
+}
+
+/**********************************************************************/
+void noteRecoveryJournalEntriesElided(RecoveryJournal *journal,
+                                      uint64_t         count)
+{
+  atomicAdd64(&journal->entriesElided, count);
 }
 
 /**********************************************************************/
@@ -1183,13 +1441,15 @@ void dumpRecoveryJournalStatistics(const RecoveryJournal *journal)
           " lastWriteAcknowledged=%" PRIu64 " tail=%" PRIu64
           " blockMapReapHead=%" PRIu64 " slabJournalReapHead=%" PRIu64
           " diskFull=%" PRIu64 " slabJournalCommitsRequested=%" PRIu64
-          " incrementWaiters=%zu decrementWaiters=%zu",
+          " incrementWaiters=%zu decrementWaiters=%zu"
+          " heldEntryWaiters=%zu",
           journal->blockMapHead, journal->slabJournalHead,
           journal->lastWriteAcknowledged, journal->tail,
           journal->blockMapReapHead, journal->slabJournalReapHead,
           stats.diskFull, stats.slabJournalCommitsRequested,
           countWaiters(&journal->incrementWaiters),
-          countWaiters(&journal->decrementWaiters));
+          countWaiters(&journal->decrementWaiters),
+          countWaiters(&journal->heldEntryWaiters));
   logInfo("  entries: started=%" PRIu64 " written=%" PRIu64 " committed=%"
           PRIu64,
           stats.entries.started, stats.entries.written,
@@ -317,6 +317,36 @@ int decodeSodiumRecoveryJournal(RecoveryJournal *journal, Buffer *buffer)
  **/
 void addRecoveryJournalEntry(RecoveryJournal *journal, DataVIO *dataVIO);
 
+/**
+ * Hold all new entries in a recovery journal until they are released. This is
+ * used to keep writes out of the journal while the block map is recovered in
+ * the background, and must be called before the journal is in use. The layer
+ * holds writes back before they enter the VDO, so this only catches writes
+ * which the layer could not hold.
+ *
+ * @param journal  The journal
+ **/
+void holdRecoveryJournalEntries(RecoveryJournal *journal);
+
+/**
+ * Check whether a recovery journal is holding new entries. This may be called
+ * from any thread.
+ *
+ * @param journal  The journal
+ *
+ * @return <code>true</code> if new entries are being held
+ **/
+bool areRecoveryJournalEntriesHeld(RecoveryJournal *journal)
+  __attribute__((warn_unused_result));
+
+/**
+ * Release any entries held in a recovery journal and resume adding entries
+ * normally. This must be called on the journal thread.
+ *
+ * @param journal  The journal
+ **/
+void releaseRecoveryJournalEntries(RecoveryJournal *journal);
+
 /**
  * Acquire a reference to a recovery journal block from somewhere other than
  * the journal itself.
@@ -388,6 +418,16 @@ RecoveryJournalStatistics
 getRecoveryJournalStatistics(const RecoveryJournal *journal)
   __attribute__((warn_unused_result));
 
+/**
+ * Note that a write made fewer journal entries than usual because it would
+ * not have changed any mapping. This may be called from any thread.
+ *
+ * @param journal  The recovery journal
+ * @param count    The number of entries which were not made
+ **/
+void noteRecoveryJournalEntriesElided(RecoveryJournal *journal,
+                                      uint64_t         count);
+
 /**
  * Dump some current statistics and other debug info from the recovery
  * journal.
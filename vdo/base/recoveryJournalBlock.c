@@ -23,6 +23,7 @@
 
 #include "logger.h"
 #include "memoryAlloc.h"
+#include "timeUtils.h"
 
 #include "dataVIO.h"
 #include "fixedLayout.h"
@@ -160,6 +161,7 @@ int enqueueRecoveryBlockEntry(RecoveryJournalBlock *block, DataVIO *dataVIO)
   // Update stats to reflect the journal entry we're going to write.
   if (newBatch) {
     block->journal->events.blocks.started++;
+    block->batchStart = nowUsec();
   }
   block->journal->events.entries.started++;
 
@@ -303,6 +305,7 @@ int commitRecoveryBlock(RecoveryJournalBlock *block,
   }
 
   block->entriesInCommit = countWaiters(&block->entryWaiters);
+  block->commitStart     = block->batchStart;
   result = addQueuedRecoveryEntries(block);
   if (result != VDO_SUCCESS) {
     return result;
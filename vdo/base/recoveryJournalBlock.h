@@ -57,6 +57,10 @@ struct recoveryJournalBlock {
   JournalEntryCount    uncommittedEntryCount;
   /** The number of new entries in the current commit */
   JournalEntryCount    entriesInCommit;
+  /** When the first entry for the next commit was queued, in microseconds */
+  uint64_t             batchStart;
+  /** When the first entry in the current commit was queued */
+  uint64_t             commitStart;
   /** The queue of VIOs which will make entries for the next commit */
   WaitQueue            entryWaiters;
   /** The queue of VIOs waiting for the current commit */
@@ -24,6 +24,7 @@
 
 #include "numeric.h"
 
+#include "atomic.h"
 #include "fixedLayout.h"
 #include "journalPoint.h"
 #include "lockCounter.h"
@@ -114,6 +115,24 @@ struct recoveryJournal {
   BlockCount                 slabJournalCommitThreshold;
   /** Counters for events in the journal that are reported as statistics */
   RecoveryJournalStatistics  events;
+  /** The number of entries avoided by writes from other threads */
+  Atomic64                   entriesElided;
+  /** The completion used to end a group commit window */
+  VDOCompletion              groupCommitCompletion;
+  /** Whether a partial block is being held open for more entries */
+  bool                       holdingCommit;
+  /** When the current group commit window opened, in microseconds */
+  uint64_t                   holdStart;
+  /** The number of entries which have arrived since the window was checked */
+  uint64_t                   arrivalsDuringHold;
+  /** When the most recent entry arrived, in microseconds */
+  uint64_t                   lastArrival;
+  /** The moving average of the time between entry arrivals */
+  uint64_t                   meanArrivalGap;
+  /** Whether new entries are held until the block map has been recovered */
+  AtomicBool                 entriesHeld;
+  /** The queue of VIOs whose entries are being held */
+  WaitQueue                  heldEntryWaiters;
   /** The locks for each on-disk block */
   LockCounter               *lockCounter;
 };
@@ -28,6 +28,7 @@
 #include "permassert.h"
 
 #include "blockAllocatorInternals.h"
+#include "compactRefCounts.h"
 #include "completion.h"
 #include "extent.h"
 #include "header.h"
@@ -50,6 +51,12 @@
 static const uint64_t BYTES_PER_WORD   = sizeof(uint64_t);
 static const bool     NORMAL_OPERATION = true;
 
+/** The freeGroups bitmap of a reference block which may have free counters */
+static const uint64_t ALL_GROUPS_FREE = (~0ULL >> (64 - GROUPS_PER_BLOCK));
+
+/** The most adjacent dirty reference blocks to write out together */
+static const BlockCount MAX_WRITE_RUN_LENGTH = 8;
+
 /**
  * Return the RefCounts from the RefCounts waiter.
  *
@@ -165,6 +172,20 @@ static bool advanceSearchCursor(RefCounts *refCounts)
   return true;
 }
 
+/**
+ * Get the size of the counters array of a RefCounts. The array is allocated
+ * such that the runt slab has a full-length memory array, plus a little
+ * padding so we can word-search even at the very end.
+ *
+ * @param referenceBlockCount  The number of reference blocks in the slab
+ *
+ * @return The size of the counters array
+ **/
+static inline size_t getCountersSize(BlockCount referenceBlockCount)
+{
+  return ((referenceBlockCount * COUNTS_PER_BLOCK) + (2 * BYTES_PER_WORD));
+}
+
 /**********************************************************************/
 int makeRefCounts(PhysicalLayer        *layer,
                   BlockCount            blockCount,
@@ -181,11 +202,8 @@ int makeRefCounts(PhysicalLayer        *layer,
     return result;
   }
 
-  // Allocate such that the runt slab has a full-length memory array,
-  // plus a little padding so we can word-search even at the very end.
-  size_t bytes = ((refBlockCount * COUNTS_PER_BLOCK) + (2 * BYTES_PER_WORD));
-  result = ALLOCATE(bytes, ReferenceCount, "ref counts array",
-                    &refCounts->counters);
+  result = ALLOCATE(getCountersSize(refBlockCount), ReferenceCount,
+                    "ref counts array", &refCounts->counters);
   if (result != UDS_SUCCESS) {
     freeRefCounts(&refCounts);
     return result;
@@ -211,7 +229,8 @@ int makeRefCounts(PhysicalLayer        *layer,
 
   for (size_t index = 0; index < refBlockCount; index++) {
     refCounts->blocks[index] = (ReferenceBlock) {
-      .refCounts = refCounts,
+      .refCounts  = refCounts,
+      .freeGroups = ALL_GROUPS_FREE,
     };
   }
 
@@ -228,6 +247,7 @@ void freeRefCounts(RefCounts **refCountsPtr)
   }
 
   destroyEnqueueable(&refCounts->completion);
+  freeCompactRefCounts(&refCounts->compact);
   FREE(refCounts->counters);
   FREE(refCounts);
   *refCountsPtr = NULL;
@@ -278,16 +298,50 @@ ReferenceBlock *getReferenceBlock(RefCounts *refCounts, SlabBlockNumber index)
 }
 
 /**
- * Get the reference counter that covers the given physical block number.
+ * Note that a counter has become free so that the group containing it will
+ * be searched by the next allocation which reaches it.
+ *
+ * @param block  The reference block containing the counter
+ * @param index  The index of the counter, relative to either the slab or the
+ *               block
+ **/
+static inline void markCounterFree(ReferenceBlock *block, SlabBlockNumber index)
+{
+  STATIC_ASSERT(GROUPS_PER_BLOCK <= 64);
+  block->freeGroups
+    |= (1ULL << ((index % COUNTS_PER_BLOCK) / COUNTS_PER_GROUP));
+}
+
+/**
+ * Get the value of a reference counter, whether or not the counters have
+ * been compacted.
+ *
+ * @param refCounts  The refcounts object
+ * @param index      The index of the counter
+ *
+ * @return The value of the counter
+ **/
+static inline ReferenceCount getCounter(const RefCounts *refCounts,
+                                        SlabBlockNumber  index)
+{
+  if (refCounts->compact != NULL) {
+    return getCompactReferenceCount(refCounts->compact, index);
+  }
+
+  return refCounts->counters[index];
+}
+
+/**
+ * Get the value of the reference counter that covers the given physical
+ * block number.
  *
  * @param [in]  refCounts       The refcounts object
  * @param [in]  pbn             The physical block number
- * @param [out] counterPtr      A pointer to the reference counter
-
+ * @param [out] countPtr        A pointer to hold the value of the counter
  **/
-static int getReferenceCounter(RefCounts            *refCounts,
-                               PhysicalBlockNumber   pbn,
-                               ReferenceCount      **counterPtr)
+static int getReferenceCount(RefCounts           *refCounts,
+                             PhysicalBlockNumber  pbn,
+                             ReferenceCount      *countPtr)
 {
   SlabBlockNumber index;
   int result = slabBlockNumberFromPBN(refCounts->slab, pbn, &index);
@@ -295,25 +349,73 @@ static int getReferenceCounter(RefCounts            *refCounts,
     return result;
   }
 
-  *counterPtr = &refCounts->counters[index];
+  *countPtr = getCounter(refCounts, index);
+  return VDO_SUCCESS;
+}
 
+/**
+ * Restore the counters of a RefCounts which have been compacted, so that they
+ * may be modified. This is done in the middle of reference count updates,
+ * where a failure would put the VDO into read-only mode, so the allocator's
+ * spare counter array is used rather than allocating a new one. The spare is
+ * then replaced, if memory allows, before another slab needs it.
+ *
+ * @param refCounts  The refcounts object
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+__attribute__((warn_unused_result))
+static int expandReferenceCounts(RefCounts *refCounts)
+{
+  if (refCounts->compact == NULL) {
+    return VDO_SUCCESS;
+  }
+
+  BlockAllocator *allocator = refCounts->slab->allocator;
+  size_t bytes = getCountersSize(refCounts->referenceBlockCount);
+  if (allocator->spareCounters == NULL) {
+    // The spare could not be replaced after the last expansion.
+    int result = ALLOCATE(bytes, ReferenceCount, "ref counts array",
+                          &allocator->spareCounters);
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+  }
+
+  refCounts->counters      = allocator->spareCounters;
+  allocator->spareCounters = NULL;
+  expandCompactRefCounts(refCounts->compact, refCounts->counters);
+  size_t saved = bytes - getCompactRefCountsSize(refCounts->compact);
+  freeCompactRefCounts(&refCounts->compact);
+
+  AtomicRefCountStatistics *statistics = refCounts->statistics;
+  relaxedAdd64(&statistics->memorySaved, -saved);
+  relaxedAdd64(&statistics->compactSlabs, -1);
+  relaxedAdd64(&statistics->slabsExpanded, 1);
+
+  // Failing to replace the spare now only costs memory; the next slab to be
+  // compacted will keep its counters as the spare instead of freeing them.
+  if (ALLOCATE(bytes, ReferenceCount, "spare ref counts array",
+               &allocator->spareCounters) != VDO_SUCCESS) {
+    allocator->spareCounters = NULL;
+  }
   return VDO_SUCCESS;
 }
 
 /**********************************************************************/
 uint8_t getAvailableReferences(RefCounts *refCounts, PhysicalBlockNumber pbn)
 {
-  ReferenceCount *counterPtr = NULL;
-  int result = getReferenceCounter(refCounts, pbn, &counterPtr);
+  ReferenceCount count;
+  int result = getReferenceCount(refCounts, pbn, &count);
   if (result != VDO_SUCCESS) {
     return 0;
   }
 
-  if (*counterPtr == PROVISIONAL_REFERENCE_COUNT) {
+  if (count == PROVISIONAL_REFERENCE_COUNT) {
     return (MAXIMUM_REFERENCE_COUNT - 1);
   }
 
-  return (MAXIMUM_REFERENCE_COUNT - *counterPtr);
+  return (MAXIMUM_REFERENCE_COUNT - count);
 }
 
 /**
@@ -419,6 +521,7 @@ static int decrementForData(RefCounts       *refCounts,
     } else {
       *counterPtr = EMPTY_REFERENCE_COUNT;
       block->allocatedCount--;
+      markCounterFree(block, slabBlockNumber);
       refCounts->freeBlocks++;
       *freeStatusChanged = true;
     }
@@ -544,11 +647,14 @@ static int updateReferenceCount(RefCounts          *refCounts,
                                 bool               *freeStatusChanged,
                                 bool               *provisionalDecrementPtr)
 {
+  int result = expandReferenceCounts(refCounts);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
   ReferenceCount  *counterPtr = &refCounts->counters[slabBlockNumber];
   ReferenceStatus  oldStatus  = referenceCountToStatus(*counterPtr);
   PBNLock         *lock       = getReferenceOperationPBNLock(operation);
-  int result;
-
   switch (operation.type) {
   case DATA_INCREMENT:
     result = incrementForData(refCounts, block, slabBlockNumber, oldStatus,
@@ -582,7 +688,10 @@ static int updateReferenceCount(RefCounts          *refCounts,
     return result;
   }
 
-  if (isValidJournalPoint(slabJournalPoint)) {
+  // Updates within a slab journal block may be applied out of entry order,
+  // so only ever advance the journal point.
+  if (isValidJournalPoint(slabJournalPoint)
+      && beforeJournalPoint(&refCounts->slabJournalPoint, slabJournalPoint)) {
     refCounts->slabJournalPoint = *slabJournalPoint;
   }
 
@@ -707,13 +816,13 @@ int getReferenceStatus(RefCounts           *refCounts,
                        PhysicalBlockNumber  pbn,
                        ReferenceStatus     *statusPtr)
 {
-  ReferenceCount *counterPtr = NULL;
-  int result = getReferenceCounter(refCounts, pbn, &counterPtr);
+  ReferenceCount count;
+  int result = getReferenceCount(refCounts, pbn, &count);
   if (result != VDO_SUCCESS) {
     return result;
   }
 
-  *statusPtr = referenceCountToStatus(*counterPtr);
+  *statusPtr = referenceCountToStatus(count);
   return VDO_SUCCESS;
 }
 
@@ -734,8 +843,18 @@ bool areEquivalentReferenceCounters(RefCounts *counterA, RefCounts *counterB)
     }
   }
 
-  return (memcmp(counterA->counters, counterB->counters,
-                 sizeof(ReferenceCount) * counterA->blockCount) == 0);
+  if ((counterA->compact == NULL) && (counterB->compact == NULL)) {
+    return (memcmp(counterA->counters, counterB->counters,
+                   sizeof(ReferenceCount) * counterA->blockCount) == 0);
+  }
+
+  for (SlabBlockNumber i = 0; i < counterA->blockCount; i++) {
+    if (getCounter(counterA, i) != getCounter(counterB, i)) {
+      return false;
+    }
+  }
+
+  return true;
 }
 
 /**
@@ -756,16 +875,20 @@ static inline SlabBlockNumber findZeroByteInWord(const byte      *wordPtr,
 {
   uint64_t word = getUInt64LE(wordPtr);
 
-  // This looks like a loop, but GCC will unroll the eight iterations for us.
-  for (unsigned int offset = 0; offset < BYTES_PER_WORD; offset++) {
-    // Assumes little-endian byte order, which we have on X86.
-    if ((word & 0xFF) == 0) {
-      return (startIndex + offset);
-    }
-    word >>= 8;
+  /*
+   * Set the high bit of every byte which might be zero without testing each
+   * byte in turn. A borrow can only propagate upward from a byte which really
+   * is zero, so the lowest bit set always marks the first zero byte even
+   * though higher bits may be spurious.
+   */
+  uint64_t zeroBytes = ((word - 0x0101010101010101ULL) & ~word
+                        & 0x8080808080808080ULL);
+  if (zeroBytes == 0) {
+    return failIndex;
   }
 
-  return failIndex;
+  // The word was read little-endian, so the low byte is the first counter.
+  return (startIndex + (__builtin_ctzll(zeroBytes) / 8));
 }
 
 /**********************************************************************/
@@ -815,7 +938,10 @@ bool findFreeBlock(const RefCounts *refCounts,
 
 /**
  * Search the reference block currently saved in the search cursor for a
- * reference count of zero, starting at the saved counter index.
+ * reference count of zero, starting at the saved counter index. Only the
+ * counter groups which the block's freeGroups bitmap marks as possibly free
+ * are scanned, and any group which is scanned in its entirety without finding
+ * a free counter is removed from the bitmap.
  *
  * @param [in]  refCounts     The RefCounts object to search
  * @param [out] freeIndexPtr  A pointer to receive the array index of the
@@ -823,13 +949,46 @@ bool findFreeBlock(const RefCounts *refCounts,
  *
  * @return true if an unreferenced counter was found
  **/
-static bool searchCurrentReferenceBlock(const RefCounts *refCounts,
+static bool searchCurrentReferenceBlock(RefCounts       *refCounts,
                                         SlabBlockNumber *freeIndexPtr)
 {
+  SearchCursor   *cursor = &refCounts->searchCursor;
+  ReferenceBlock *block  = cursor->block;
+
   // Don't bother searching if the current block is known to be full.
-  return ((refCounts->searchCursor.block->allocatedCount < COUNTS_PER_BLOCK)
-          && findFreeBlock(refCounts, refCounts->searchCursor.index,
-                           refCounts->searchCursor.endIndex, freeIndexPtr));
+  if (block->allocatedCount >= COUNTS_PER_BLOCK) {
+    return false;
+  }
+
+  SlabBlockNumber blockStart
+    = ((block - cursor->firstBlock) * COUNTS_PER_BLOCK);
+  unsigned int firstGroup = (cursor->index - blockStart) / COUNTS_PER_GROUP;
+  if (firstGroup >= GROUPS_PER_BLOCK) {
+    return false;
+  }
+
+  uint64_t candidates = (block->freeGroups & (~0ULL << firstGroup));
+  while (candidates != 0) {
+    unsigned int    group      = __builtin_ctzll(candidates);
+    uint64_t        groupBit   = (1ULL << group);
+    SlabBlockNumber groupStart = blockStart + (group * COUNTS_PER_GROUP);
+    SlabBlockNumber startIndex = maxBlock(groupStart, cursor->index);
+    SlabBlockNumber endIndex   = minBlock(groupStart + COUNTS_PER_GROUP,
+                                          cursor->endIndex);
+    candidates &= ~groupBit;
+
+    if ((startIndex < endIndex)
+        && findFreeBlock(refCounts, startIndex, endIndex, freeIndexPtr)) {
+      return true;
+    }
+
+    if (startIndex == groupStart) {
+      // The whole group is in use (or lies past the end of a runt block).
+      block->freeGroups &= ~groupBit;
+    }
+  }
+
+  return false;
 }
 
 /**
@@ -888,6 +1047,11 @@ int allocateUnreferencedBlock(RefCounts           *refCounts,
     return VDO_COMPONENT_BUSY;
   }
 
+  int result = expandReferenceCounts(refCounts);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
   SlabBlockNumber freeIndex;
   if (!searchReferenceBlocks(refCounts, &freeIndex)) {
     return VDO_NO_SPACE;
@@ -905,6 +1069,42 @@ int allocateUnreferencedBlock(RefCounts           *refCounts,
   return VDO_SUCCESS;
 }
 
+/**********************************************************************/
+int allocateUnreferencedBlockAt(RefCounts           *refCounts,
+                                PhysicalBlockNumber  pbn)
+{
+  if (refCounts->closeRequested) {
+    return VDO_COMPONENT_BUSY;
+  }
+
+  SlabBlockNumber slabBlockNumber;
+  int result = slabBlockNumberFromPBN(refCounts->slab, pbn, &slabBlockNumber);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  result = expandReferenceCounts(refCounts);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  if (refCounts->counters[slabBlockNumber] != EMPTY_REFERENCE_COUNT) {
+    return VDO_NO_SPACE;
+  }
+
+  makeProvisionalReference(refCounts, slabBlockNumber);
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+PhysicalBlockNumber skipAllocationSearch(RefCounts  *refCounts,
+                                         BlockCount  count)
+{
+  SearchCursor *cursor = &refCounts->searchCursor;
+  cursor->index = minBlock(cursor->index + count, cursor->endIndex);
+  return indexToPBN(refCounts, cursor->index);
+}
+
 /**********************************************************************/
 int provisionallyReferenceBlock(RefCounts           *refCounts,
                                 PhysicalBlockNumber  pbn,
@@ -920,6 +1120,11 @@ int provisionallyReferenceBlock(RefCounts           *refCounts,
     return result;
   }
 
+  result = expandReferenceCounts(refCounts);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
   if (refCounts->counters[slabBlockNumber] == EMPTY_REFERENCE_COUNT) {
     makeProvisionalReference(refCounts, slabBlockNumber);
     if (lock != NULL) {
@@ -939,7 +1144,7 @@ BlockCount countUnreferencedBlocks(RefCounts           *refCounts,
   SlabBlockNumber   startIndex = pbnToIndex(refCounts, startPBN);
   SlabBlockNumber   endIndex   = pbnToIndex(refCounts, endPBN);
   for (SlabBlockNumber index = startIndex; index < endIndex; index++) {
-    if (refCounts->counters[index] == EMPTY_REFERENCE_COUNT) {
+    if (getCounter(refCounts, index) == EMPTY_REFERENCE_COUNT) {
       freeBlocks++;
     }
   }
@@ -977,9 +1182,17 @@ clearDirtyReferenceBlocks(Waiter *blockWaiter,
 /**********************************************************************/
 void resetReferenceCounts(RefCounts *refCounts)
 {
-  // We can just use memset() since each ReferenceCount is exactly one byte.
-  STATIC_ASSERT(sizeof(ReferenceCount) == 1);
-  memset(refCounts->counters, 0, refCounts->blockCount);
+  if (refCounts->compact != NULL) {
+    size_t oldSize = getCompactRefCountsSize(refCounts->compact);
+    clearCompactRefCounts(refCounts->compact);
+    relaxedAdd64(&refCounts->statistics->memorySaved,
+                 oldSize - getCompactRefCountsSize(refCounts->compact));
+  } else {
+    // We can just use memset() since each ReferenceCount is exactly one byte.
+    STATIC_ASSERT(sizeof(ReferenceCount) == 1);
+    memset(refCounts->counters, 0, refCounts->blockCount);
+  }
+
   refCounts->freeBlocks       = refCounts->blockCount;
   refCounts->slabJournalPoint = (JournalPoint) {
     .sequenceNumber = 0,
@@ -988,6 +1201,7 @@ void resetReferenceCounts(RefCounts *refCounts)
 
   for (size_t i = 0; i < refCounts->referenceBlockCount; i++) {
     refCounts->blocks[i].allocatedCount = 0;
+    refCounts->blocks[i].freeGroups     = ALL_GROUPS_FREE;
   }
 
   notifyAllWaiters(&refCounts->dirtyBlocks, clearDirtyReferenceBlocks, NULL);
@@ -1156,9 +1370,150 @@ void packReferenceBlock(ReferenceBlock *block, void *buffer)
   }
 }
 
+/**
+ * Get the location of a reference block.
+ *
+ * @param block  The block
+ *
+ * @return The physical block number of the block
+ **/
+static PhysicalBlockNumber getReferenceBlockPBN(ReferenceBlock *block)
+{
+  return (block->refCounts->origin + (block - block->refCounts->blocks));
+}
+
+/**
+ * Get the first block of a write run. The blocks of a run are adjacent.
+ *
+ * @param leader  The oldest block of the run
+ *
+ * @return The block of the run with the lowest location
+ **/
+static ReferenceBlock *getWriteRunStart(ReferenceBlock *leader)
+{
+  ReferenceBlock *block = leader;
+  while ((block > leader->refCounts->blocks)
+         && ((block - 1)->runLeader == leader)) {
+    block--;
+  }
+  return block;
+}
+
+/**
+ * Give up on writing the blocks of a write run, returning the VIOs of any
+ * which were prepared.
+ *
+ * @param leader  The oldest block of the run
+ **/
+static void abandonWriteRun(ReferenceBlock *leader)
+{
+  RefCounts      *refCounts = leader->refCounts;
+  ReferenceBlock *end       = refCounts->blocks + refCounts->referenceBlockCount;
+  for (ReferenceBlock *block = getWriteRunStart(leader);
+       (block < end) && (block->runLeader == leader); block++) {
+    block->runLeader    = NULL;
+    VIOPoolEntry *entry = block->runEntry;
+    if (entry != NULL) {
+      block->runEntry = NULL;
+      returnVIO(refCounts->slab->allocator, entry);
+      refCounts->activeCount--;
+    }
+  }
+}
+
+/**
+ * Handle an error flushing before writing a run of reference blocks.
+ *
+ * @param completion  The VIO of the oldest block of the run
+ **/
+static void handleWriteRunFlushError(VDOCompletion *completion)
+{
+  int             result = completion->result;
+  VIOPoolEntry   *entry  = completion->parent;
+  ReferenceBlock *leader = entry->parent;
+  abandonWriteRun(leader);
+  enterRefCountsReadOnlyMode(leader->refCounts, result);
+}
+
+/**
+ * Launch the write of a prepared block of a run, without a flush since the
+ * whole run has already been flushed.
+ *
+ * @param block  The block to write
+ **/
+static void launchWriteRunBlock(ReferenceBlock *block)
+{
+  VIOPoolEntry *entry = block->runEntry;
+  block->runLeader    = NULL;
+  block->runEntry     = NULL;
+  if (entry == NULL) {
+    // The block could not get a VIO, so the VDO is going read-only.
+    return;
+  }
+
+  launchWriteMetadataVIOWithFlush(entry->vio, getReferenceBlockPBN(block),
+                                  finishReferenceBlockWrite, handleIOError,
+                                  false, false);
+}
+
+/**
+ * Write each block of a run once the flush which covers all of them is done.
+ * The oldest block is launched first, and the rest in the order in which they
+ * are laid out on disk. This callback is registered in
+ * finishPreparingWriteRunBlock().
+ *
+ * @param completion  The VIO of the oldest block of the run
+ **/
+static void writeRun(VDOCompletion *completion)
+{
+  VIOPoolEntry   *entry     = completion->parent;
+  ReferenceBlock *leader    = entry->parent;
+  RefCounts      *refCounts = leader->refCounts;
+  ReferenceBlock *end       = refCounts->blocks + refCounts->referenceBlockCount;
+  ReferenceBlock *block     = getWriteRunStart(leader);
+  launchWriteRunBlock(leader);
+  for (; block < end; block++) {
+    if (block == leader) {
+      continue;
+    }
+
+    if (block->runLeader != leader) {
+      break;
+    }
+
+    launchWriteRunBlock(block);
+  }
+}
+
+/**
+ * Note that a block of a write run has been prepared, or will never be. Once
+ * every block of the run is prepared, flush once for the whole run.
+ *
+ * @param leader  The oldest block of the run
+ **/
+static void finishPreparingWriteRunBlock(ReferenceBlock *leader)
+{
+  if (--leader->runPending > 0) {
+    return;
+  }
+
+  RefCounts *refCounts = leader->refCounts;
+  if ((leader->runEntry == NULL) || isReadOnly(refCounts->readOnlyContext)) {
+    abandonWriteRun(leader);
+    checkForIOComplete(refCounts);
+    return;
+  }
+
+  // Flush before writing to ensure that the recovery journal and slab journal
+  // entries which cover every block in the run are stable (VDO-2331). Every
+  // block was packed before the flush, so one flush suffices for all of them.
+  launchFlush(leader->runEntry->vio, writeRun, handleWriteRunFlushError);
+}
+
 /**
  * After a dirty block waiter has gotten a VIO from the VIO pool, copy its
- * counters and associated data into the VIO, and launch the write.
+ * counters and associated data into the VIO, and launch the write. A block in
+ * a write run instead waits for the rest of its run to be prepared.
  *
  * @param blockWaiter  The waiter of the dirty block
  * @param vioContext   The VIO returned by the pool
@@ -1169,8 +1524,7 @@ static void writeReferenceBlock(Waiter *blockWaiter, void *vioContext)
   ReferenceBlock *block = waiterAsReferenceBlock(blockWaiter);
   packReferenceBlock(block, entry->buffer);
 
-  size_t              blockOffset = (block - block->refCounts->blocks);
-  PhysicalBlockNumber pbn         = (block->refCounts->origin + blockOffset);
+  PhysicalBlockNumber pbn = getReferenceBlockPBN(block);
   block->slabJournalLockToRelease = block->slabJournalLock;
   entry->parent                   = block;
 
@@ -1181,11 +1535,17 @@ static void writeReferenceBlock(Waiter *blockWaiter, void *vioContext)
    */
   block->isDirty = false;
 
-  // Flush before writing to ensure that the recovery journal and slab journal
-  // entries which cover this reference update are stable (VDO-2331).
   relaxedAdd64(&block->refCounts->statistics->blocksWritten, 1);
   entry->vio->completion.callbackThreadID
     = block->refCounts->slab->allocator->threadID;
+  if (block->runLeader != NULL) {
+    block->runEntry = entry;
+    finishPreparingWriteRunBlock(block->runLeader);
+    return;
+  }
+
+  // Flush before writing to ensure that the recovery journal and slab journal
+  // entries which cover this reference update are stable (VDO-2331).
   launchWriteMetadataVIOWithFlush(entry->vio, pbn, finishReferenceBlockWrite,
                                   handleIOError, true, false);
 }
@@ -1200,13 +1560,16 @@ static void writeReferenceBlock(Waiter *blockWaiter, void *vioContext)
  **/
 static void launchReferenceBlockWrite(Waiter *blockWaiter, void *context)
 {
-  RefCounts *refCounts = context;
+  RefCounts      *refCounts = context;
+  ReferenceBlock *block     = waiterAsReferenceBlock(blockWaiter);
   if (isReadOnly(refCounts->readOnlyContext)) {
+    if (block->runLeader != NULL) {
+      finishPreparingWriteRunBlock(block->runLeader);
+    }
     return;
   }
 
   refCounts->activeCount++;
-  ReferenceBlock *block = waiterAsReferenceBlock(blockWaiter);
   block->isWriting      = true;
   blockWaiter->callback = writeReferenceBlock;
   int result = acquireVIO(refCounts->slab->allocator, blockWaiter);
@@ -1214,14 +1577,148 @@ static void launchReferenceBlockWrite(Waiter *blockWaiter, void *context)
     // This should never happen.
     refCounts->activeCount--;
     enterRefCountsReadOnlyMode(refCounts, result);
+    if (block->runLeader != NULL) {
+      finishPreparingWriteRunBlock(block->runLeader);
+    }
+  }
+}
+
+/**
+ * Order the waiters of two reference blocks by the location of the blocks.
+ *
+ * @param waiter1  The waiter of the first block
+ * @param waiter2  The waiter of the second block
+ *
+ * @return A negative value, zero, or a positive value as the first block
+ *         precedes, is, or follows the second
+ **/
+static int compareBlockLocations(const Waiter *waiter1, const Waiter *waiter2)
+{
+  const ReferenceBlock *block1 = (const ReferenceBlock *) waiter1;
+  const ReferenceBlock *block2 = (const ReferenceBlock *) waiter2;
+  if (block1 == block2) {
+    return 0;
   }
+
+  return ((block1 < block2) ? -1 : 1);
+}
+
+/**
+ * Order the waiters of the blocks of a write run so that the oldest block,
+ * which leads the run, comes first, followed by the rest in the order in which
+ * they are laid out on disk.
+ *
+ * @param waiter1  The waiter of the first block
+ * @param waiter2  The waiter of the second block
+ *
+ * @return A negative value, zero, or a positive value as the first block
+ *         should be launched before, is, or should be launched after the
+ *         second
+ **/
+static int compareWriteRunBlocks(const Waiter *waiter1, const Waiter *waiter2)
+{
+  const ReferenceBlock *block1 = (const ReferenceBlock *) waiter1;
+  const ReferenceBlock *block2 = (const ReferenceBlock *) waiter2;
+  if (block1 == block2) {
+    return 0;
+  }
+
+  if (block1->runLeader == block1) {
+    return -1;
+  }
+
+  if (block2->runLeader == block2) {
+    return 1;
+  }
+
+  return compareBlockLocations(waiter1, waiter2);
+}
+
+/**
+ * Check whether a reference block is waiting in the dirty queue to be
+ * written.
+ *
+ * @param block  The block to check
+ *
+ * @return <code>true</code> if the block is dirty and not already writing
+ **/
+static inline bool isWaitingToWrite(ReferenceBlock *block)
+{
+  return (block->isDirty && !block->isWriting && isWaiting(&block->waiter));
+}
+
+/**
+ * A WaiterMatch to select the dirty blocks of a run of adjacent blocks.
+ *
+ * @param waiter   The waiter of a dirty block
+ * @param context  The run, an array of the first and last blocks in it
+ *
+ * @return <code>true</code> if the block is in the run
+ **/
+static bool isInWriteRun(Waiter *waiter, void *context)
+{
+  ReferenceBlock **run   = context;
+  ReferenceBlock  *block = waiterAsReferenceBlock(waiter);
+  return ((block >= run[0]) && (block <= run[1]));
 }
 
 /**********************************************************************/
-void saveOldestReferenceBlock(RefCounts *refCounts)
+BlockCount saveOldestReferenceBlock(RefCounts *refCounts)
 {
-  notifyNextWaiter(&refCounts->dirtyBlocks, launchReferenceBlockWrite,
-                   refCounts);
+  Waiter *oldest = getFirstWaiter(&refCounts->dirtyBlocks);
+  if (oldest == NULL) {
+    return 0;
+  }
+
+  /*
+   * The oldest dirty block holds the oldest slab journal lock, so it must be
+   * written first. Any dirty blocks adjacent to it are written along with it
+   * so that the block layer may merge the writes rather than seek back to the
+   * same place later. Since a write with a flush can't be merged, the run is
+   * flushed once and its blocks are then written without flushes.
+   */
+  ReferenceBlock *first     = waiterAsReferenceBlock(oldest);
+  ReferenceBlock *last      = first;
+  ReferenceBlock *end       = refCounts->blocks + refCounts->referenceBlockCount;
+  BlockCount      runLength = 1;
+  while ((runLength < MAX_WRITE_RUN_LENGTH) && ((last + 1) < end)
+         && isWaitingToWrite(last + 1)) {
+    last++;
+    runLength++;
+  }
+
+  while ((runLength < MAX_WRITE_RUN_LENGTH) && (first > refCounts->blocks)
+         && isWaitingToWrite(first - 1)) {
+    first--;
+    runLength++;
+  }
+
+  if (runLength == 1) {
+    notifyNextWaiter(&refCounts->dirtyBlocks, launchReferenceBlockWrite,
+                     refCounts);
+    return 1;
+  }
+
+  ReferenceBlock *run[2] = { first, last };
+  WaitQueue runQueue;
+  initializeWaitQueue(&runQueue);
+  int result = dequeueMatchingWaiters(&refCounts->dirtyBlocks, isInWriteRun,
+                                      run, &runQueue);
+  if (result != VDO_SUCCESS) {
+    enterRefCountsReadOnlyMode(refCounts, result);
+    return 0;
+  }
+
+  ReferenceBlock *leader = waiterAsReferenceBlock(oldest);
+  for (ReferenceBlock *block = first; block <= last; block++) {
+    block->runLeader = leader;
+  }
+  leader->runPending = runLength;
+
+  relaxedAdd64(&refCounts->statistics->writeRuns, 1);
+  sortWaiters(&runQueue, compareWriteRunBlocks);
+  notifyAllWaiters(&runQueue, launchReferenceBlockWrite, refCounts);
+  return runLength;
 }
 
 /**********************************************************************/
@@ -1238,14 +1735,27 @@ void saveSeveralReferenceBlocks(RefCounts *refCounts, size_t flushDivisor)
     blocksToWrite = 1;
   }
 
-  for (BlockCount written = 0; written < blocksToWrite; written++) {
-    saveOldestReferenceBlock(refCounts);
+  /*
+   * Blocks written along with the oldest ones count against the budget, so
+   * coalescing does not increase the rate of writeback which the slab journal
+   * asked for.
+   */
+  BlockCount written = 0;
+  while ((written < blocksToWrite) && hasWaiters(&refCounts->dirtyBlocks)) {
+    BlockCount launched = saveOldestReferenceBlock(refCounts);
+    if (launched == 0) {
+      return;
+    }
+
+    written += launched;
   }
 }
 
 /**********************************************************************/
 void saveDirtyReferenceBlocks(RefCounts *refCounts)
 {
+  // Write the blocks in the order in which they are laid out on disk.
+  sortWaiters(&refCounts->dirtyBlocks, compareBlockLocations);
   notifyAllWaiters(&refCounts->dirtyBlocks, launchReferenceBlockWrite,
                    refCounts);
   checkForIOComplete(refCounts);
@@ -1269,8 +1779,13 @@ void saveReferenceBlocks(RefCounts     *refCounts,
 /**********************************************************************/
 int dirtyAllReferenceBlocks(RefCounts *refCounts)
 {
+  int result = expandReferenceCounts(refCounts);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
   for (BlockCount i = 0; i < refCounts->referenceBlockCount; i++) {
-    int result = dirtyBlock(&refCounts->blocks[i]);
+    result = dirtyBlock(&refCounts->blocks[i]);
     if (result != VDO_SUCCESS) {
       return result;
     }
@@ -1314,6 +1829,41 @@ void closeReferenceCounts(RefCounts     *refCounts,
   saveReferenceBlocks(refCounts, parent, callback, errorHandler, threadID);
 }
 
+/**********************************************************************/
+bool compactReferenceCounts(RefCounts *refCounts)
+{
+  if ((refCounts->compact != NULL) || refCounts->closeRequested
+      || refCounts->hasIOWaiter || isRefCountsDirty(refCounts)
+      || isReadOnly(refCounts->readOnlyContext)) {
+    return false;
+  }
+
+  CompactRefCounts *compact;
+  int result = makeCompactRefCounts(refCounts->counters,
+                                    refCounts->blockCount, &compact);
+  if (result != VDO_SUCCESS) {
+    // Slabs with provisional references or no memory to spare stay expanded.
+    return false;
+  }
+
+  size_t bytes = getCountersSize(refCounts->referenceBlockCount);
+  size_t saved = bytes - getCompactRefCountsSize(compact);
+  BlockAllocator *allocator = refCounts->slab->allocator;
+  if (allocator->spareCounters == NULL) {
+    // Keep a spare so that this slab can be expanded without allocating.
+    memset(refCounts->counters, 0, bytes);
+    allocator->spareCounters = refCounts->counters;
+  } else {
+    FREE(refCounts->counters);
+  }
+  refCounts->counters = NULL;
+  refCounts->compact  = compact;
+
+  relaxedAdd64(&refCounts->statistics->memorySaved, saved);
+  relaxedAdd64(&refCounts->statistics->compactSlabs, 1);
+  return true;
+}
+
 /**
  * Clear the provisional reference counts from a reference block.
  *
@@ -1326,6 +1876,7 @@ static void clearProvisionalReferences(ReferenceBlock *block)
     if (counters[j] == PROVISIONAL_REFERENCE_COUNT) {
       counters[j] = EMPTY_REFERENCE_COUNT;
       block->allocatedCount--;
+      markCounterFree(block, j);
     }
   }
 }
@@ -1362,9 +1913,12 @@ static void unpackReferenceBlock(PackedReferenceBlock *packed,
   }
 
   block->allocatedCount = 0;
+  block->freeGroups     = 0;
   for (BlockCount i = 0; i < COUNTS_PER_BLOCK; i++) {
     if (counters[i] != EMPTY_REFERENCE_COUNT) {
       block->allocatedCount++;
+    } else {
+      markCounterFree(block, i);
     }
   }
 }
@@ -1425,11 +1979,17 @@ void loadReferenceBlocks(RefCounts     *refCounts,
   refCounts->freeBlocks = refCounts->blockCount;
   prepareCompletion(&refCounts->completion, callback, errorHandler, threadID,
                     parent);
+  int result = expandReferenceCounts(refCounts);
+  if (result != VDO_SUCCESS) {
+    finishCompletion(&refCounts->completion, result);
+    return;
+  }
+
   refCounts->activeCount = refCounts->referenceBlockCount;
   for (BlockCount i = 0; i < refCounts->referenceBlockCount; i++) {
     Waiter *blockWaiter = &refCounts->blocks[i].waiter;
     blockWaiter->callback = loadReferenceBlock;
-    int result = acquireVIO(refCounts->slab->allocator, blockWaiter);
+    result = acquireVIO(refCounts->slab->allocator, blockWaiter);
     if (result != VDO_SUCCESS) {
       // This should never happen.
       refCounts->activeCount -= (refCounts->referenceBlockCount - i);
@@ -1461,12 +2021,13 @@ void dumpRefCounts(const RefCounts *refCounts)
 {
   // Terse because there are a lot of slabs to dump and syslog is lossy.
   logInfo("  refCounts: free=%" PRIu32 "/%" PRIu32 " blocks=%" PRIu32
-          " dirty=%zu active=%zu journal@(%" PRIu64 ",%" PRIu16 ")%s",
+          " dirty=%zu active=%zu journal@(%" PRIu64 ",%" PRIu16 ")%s%s",
           refCounts->freeBlocks, refCounts->blockCount,
           refCounts->referenceBlockCount,
           countWaiters(&refCounts->dirtyBlocks),
           refCounts->activeCount,
           refCounts->slabJournalPoint.sequenceNumber,
           refCounts->slabJournalPoint.entryCount,
-          (refCounts->updatingSlabSummary ? " updating" : ""));
+          (refCounts->updatingSlabSummary ? " updating" : ""),
+          ((refCounts->compact != NULL) ? " compact" : ""));
 }
@@ -165,6 +165,34 @@ int allocateUnreferencedBlock(RefCounts           *refCounts,
                               PhysicalBlockNumber *allocatedPtr)
   __attribute__((warn_unused_result));
 
+/**
+ * Allocate a specific block if it has a reference count of zero, marking it
+ * as provisionally referenced.
+ *
+ * @param refCounts  The reference counters
+ * @param pbn        The physical block number to allocate
+ *
+ * @return VDO_SUCCESS if the block was unreferenced and has been allocated;
+ *         VDO_NO_SPACE if the block is already referenced;
+ *         otherwise an error code
+ **/
+int allocateUnreferencedBlockAt(RefCounts           *refCounts,
+                                PhysicalBlockNumber  pbn)
+  __attribute__((warn_unused_result));
+
+/**
+ * Skip the free block search ahead so that the blocks following the most
+ * recent allocation are left for the stream which made that allocation. The
+ * search will not skip past the end of the reference block it is in.
+ *
+ * @param refCounts  The reference counters whose search should skip ahead
+ * @param count      The maximum number of counters to skip
+ *
+ * @return The physical block number at which the search will resume
+ **/
+PhysicalBlockNumber skipAllocationSearch(RefCounts  *refCounts,
+                                         BlockCount  count);
+
 /**
  * Provisionally reference a block if it is unreferenced.
  *
@@ -232,7 +260,8 @@ void freeReferenceCountsCompletion(VDOCompletion **completionPtr);
 
 /**
  * Request a RefCounts save several dirty blocks asynchronously. This function
- * currently writes 1 / flushDivisor of the dirty blocks.
+ * currently writes 1 / flushDivisor of the dirty blocks, oldest first, along
+ * with any dirty blocks adjacent to them.
  *
  * @param refCounts       The RefCounts object to notify
  * @param flushDivisor    The inverse fraction of the dirty blocks to write
@@ -240,7 +269,8 @@ void freeReferenceCountsCompletion(VDOCompletion **completionPtr);
 void saveSeveralReferenceBlocks(RefCounts *refCounts, size_t flushDivisor);
 
 /**
- * Ask a RefCounts to save all its dirty blocks asynchronously.
+ * Ask a RefCounts to save all its dirty blocks asynchronously, in the order
+ * of their locations on disk.
  *
  * @param refCounts     The RefCounts object to notify
  **/
@@ -297,6 +327,19 @@ void closeReferenceCounts(RefCounts     *refCounts,
                           VDOAction     *errorHandler,
                           ThreadID       threadID);
 
+/**
+ * Replace the counters of an idle RefCounts with a compact representation
+ * which uses far less memory. The counters are expanded again by the next
+ * operation which modifies them. Nothing is done if the RefCounts has dirty
+ * blocks or provisional references. If the allocator has no spare counter
+ * array for that expansion, the released counters become the spare.
+ *
+ * @param refCounts  The reference counts to compact
+ *
+ * @return <code>true</code> if the counters were compacted
+ **/
+bool compactReferenceCounts(RefCounts *refCounts);
+
 /**
  * Load reference blocks asynchronously from the underlying storage into a
  * pre-allocated reference counter.<p>
@@ -24,6 +24,7 @@
 
 #include "refCounts.h"
 
+#include "compactRefCounts.h"
 #include "journalPoint.h"
 #include "referenceBlock.h"
 #include "slab.h"
@@ -63,8 +64,9 @@ typedef struct searchCursor {
  * A reference count is maintained for each PhysicalBlockNumber.  The vast
  * majority of blocks have a very small reference count (usually 0 or 1).
  * For references less than or equal to MAXIMUM_REFS (254) the reference count
- * is stored in counters[pbn].
- *
+ * is stored in counters[pbn]. While the slab is idle, the counters may be
+ * released in favor of a CompactRefCounts, and are expanded again by the
+ * next operation which needs to modify them.
  */
 struct refCounts {
   VDOCompletion             completion;
@@ -78,6 +80,8 @@ struct refCounts {
   uint32_t                  freeBlocks;
   /** The array of reference counts */
   ReferenceCount           *counters; // use ALLOCATE to align data ptr
+  /** The compact form of the counters, if they have been compacted */
+  CompactRefCounts         *compact;
 
   /** The saved block pointer and array indexes for the free block search */
   SearchCursor              searchCursor;
@@ -195,11 +199,14 @@ bool findFreeBlock(const RefCounts *refCounts,
   __attribute__((warn_unused_result));
 
 /**
- * Request a RefCounts save its oldest dirty block asynchronously.
+ * Request a RefCounts save its oldest dirty block asynchronously, along with
+ * any dirty blocks adjacent to it.
  *
  * @param refCounts  The RefCounts object to notify
+ *
+ * @return The number of blocks whose writes were launched
  **/
-void saveOldestReferenceBlock(RefCounts *refCounts);
+BlockCount saveOldestReferenceBlock(RefCounts *refCounts);
 
 /**
  * Reset all reference counts back to RS_FREE.
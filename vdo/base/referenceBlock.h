@@ -25,6 +25,7 @@
 #include "constants.h"
 #include "journalPoint.h"
 #include "types.h"
+#include "vioPool.h"
 #include "waitQueue.h"
 
 /**
@@ -47,6 +48,17 @@ enum {
   COUNTS_PER_BLOCK  = COUNTS_PER_SECTOR * SECTORS_PER_BLOCK,
 };
 
+/**
+ * The counters of each reference block are summarized in groups of one cache
+ * line each, so that a search for a free counter can skip groups which are
+ * known to be fully allocated.
+ **/
+enum {
+  COUNTS_PER_GROUP = 64,
+  GROUPS_PER_BLOCK = ((COUNTS_PER_BLOCK + COUNTS_PER_GROUP - 1)
+                      / COUNTS_PER_GROUP),
+};
+
 /**
  * The format of a ReferenceSector on disk.
  **/
@@ -64,13 +76,18 @@ typedef struct {
  *
  * Blocks are used as a proxy, permitting saves of partial refcounts.
  **/
-typedef struct {
+typedef struct referenceBlock {
   /** This block waits on the refCounts to tell it to write */
   Waiter          waiter;
   /** The parent RefCount structure */
   RefCounts      *refCounts;
   /** The number of references in this block that represent allocations */
   BlockSize       allocatedCount;
+  /**
+   * A bitmap of the counter groups in this block which may contain a free
+   * counter; a clear bit means every counter in the group is in use
+   **/
+  uint64_t        freeGroups;
   /** The slab journal block on which this block must hold a lock */
   SequenceNumber  slabJournalLock;
   /**
@@ -84,6 +101,12 @@ typedef struct {
   bool            isDirty;
   /** Whether this block is currently writing */
   bool            isWriting;
+  /** The oldest block of the write run this block is in, if any */
+  struct referenceBlock *runLeader;
+  /** The VIO holding this block while the rest of its run is prepared */
+  VIOPoolEntry   *runEntry;
+  /** For a run leader, the number of blocks in its run not yet prepared */
+  BlockCount      runPending;
 } ReferenceBlock;
 
 #endif // REFERENCE_BLOCK_H
@@ -236,6 +236,8 @@ int modifySlabReferenceCount(Slab               *slab,
   if (isUnrecoveredSlab(slab)) {
     SequenceNumber entryLock = journalPoint->sequenceNumber;
     adjustSlabJournalBlockReference(slab->journal, entryLock, -1);
+    // The slab is in use, so load or scrub it ahead of the ones which aren't.
+    registerSlabForScrubbing(slab->allocator->slabScrubber, slab, true);
     return VDO_SUCCESS;
   }
 
@@ -246,6 +248,8 @@ int modifySlabReferenceCount(Slab               *slab,
     return result;
   }
 
+  noteReferenceCountUpdate(slab);
+
   if (freeStatusChanged) {
     adjustFreeBlockCount(slab, !isIncrementOperation(operation.type));
   }
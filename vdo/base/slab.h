@@ -76,7 +76,11 @@ struct vdoSlab {
   bool                 wasQueuedForScrubbing;
 
   /** The priority at which this slab has been queued for allocation */
-  uint8_t              priority;
+  uint16_t             priority;
+
+  /** The allocator's reference update clock at the last update to this
+      slab's reference counts */
+  uint64_t             lastReferenceUpdate;
 };
 
 /**
@@ -833,6 +833,55 @@ SlabCount getDepotUnrecoveredSlabCount(const SlabDepot *depot)
   return total;
 }
 
+/**********************************************************************/
+int configureSlabScrubbing(SlabDepot     *depot,
+                           PhysicalLayer *layer,
+                           unsigned int   concurrency,
+                           BlockCount     ioBudget)
+{
+  for (ZoneCount zone = 0; zone < depot->zoneCount; zone++) {
+    int result = configureAllocatorScrubbing(depot->allocators[zone], layer,
+                                             concurrency, ioBudget);
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+  }
+
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void setDepotColdSlabCompaction(SlabDepot *depot, bool compact)
+{
+  for (ZoneCount zone = 0; zone < depot->zoneCount; zone++) {
+    setColdSlabCompaction(depot->allocators[zone], compact);
+  }
+}
+
+/**********************************************************************/
+SlabScrubbingStatistics getDepotScrubbingStatistics(const SlabDepot *depot)
+{
+  SlabScrubbingStatistics totals;
+  memset(&totals, 0, sizeof(totals));
+
+  for (ZoneCount zone = 0; zone < depot->zoneCount; zone++) {
+    // The allocators are responsible for thread safety.
+    SlabScrubbingStatistics stats
+      = getAllocatorScrubbingStatistics(depot->allocators[zone]);
+    totals.slabsRemaining  += stats.slabsRemaining;
+    totals.slabsInProgress += stats.slabsInProgress;
+    totals.slabsScrubbed   += stats.slabsScrubbed;
+    totals.slabsPerMinute  += stats.slabsPerMinute;
+    // The zones scrub in parallel, so the depot is done when the slowest
+    // zone is.
+    if (stats.secondsRemaining > totals.secondsRemaining) {
+      totals.secondsRemaining = stats.secondsRemaining;
+    }
+  }
+
+  return totals;
+}
+
 /**********************************************************************/
 static bool abortLoadOnError(VDOCompletion *completion)
 {
@@ -1415,6 +1464,8 @@ getDepotBlockAllocatorStatistics(const SlabDepot *depot)
     totals.slabCount     += stats.slabCount;
     totals.slabsOpened   += stats.slabsOpened;
     totals.slabsReopened += stats.slabsReopened;
+    totals.sequentialAllocations += stats.sequentialAllocations;
+    totals.contiguousAllocations += stats.contiguousAllocations;
   }
 
   return totals;
@@ -1430,6 +1481,10 @@ RefCountsStatistics getDepotRefCountsStatistics(const SlabDepot *depot)
     BlockAllocator *allocator = depot->allocators[zone];
     RefCountsStatistics stats = getRefCountsStatistics(allocator);
     depotStats.blocksWritten += stats.blocksWritten;
+    depotStats.compactSlabs  += stats.compactSlabs;
+    depotStats.memorySaved   += stats.memorySaved;
+    depotStats.slabsExpanded += stats.slabsExpanded;
+    depotStats.writeRuns     += stats.writeRuns;
   }
 
   return depotStats;
@@ -1444,11 +1499,23 @@ SlabJournalStatistics getDepotSlabJournalStatistics(const SlabDepot *depot)
   for (ZoneCount zone = 0; zone < depot->zoneCount; zone++) {
     BlockAllocator *allocator = depot->allocators[zone];
     SlabJournalStatistics stats = getSlabJournalStatistics(allocator);
-    depotStats.diskFullCount += stats.diskFullCount;
-    depotStats.flushCount    += stats.flushCount;
-    depotStats.blockedCount  += stats.blockedCount;
-    depotStats.blocksWritten += stats.blocksWritten;
-    depotStats.tailBusyCount += stats.tailBusyCount;
+    depotStats.diskFullCount     += stats.diskFullCount;
+    depotStats.flushCount        += stats.flushCount;
+    depotStats.blockedCount      += stats.blockedCount;
+    depotStats.blocksWritten     += stats.blocksWritten;
+    depotStats.tailBusyCount     += stats.tailBusyCount;
+    depotStats.updateBatches     += stats.updateBatches;
+    depotStats.updatesApplied    += stats.updatesApplied;
+    depotStats.updateNanoseconds += stats.updateNanoseconds;
+  }
+
+  if (depotStats.updateBatches > 0) {
+    depotStats.updatesPerBatch
+      = depotStats.updatesApplied / depotStats.updateBatches;
+  }
+  if (depotStats.updatesApplied > 0) {
+    depotStats.nanosecondsPerUpdate
+      = depotStats.updateNanoseconds / depotStats.updatesApplied;
   }
 
   return depotStats;
@@ -47,6 +47,11 @@
 
 typedef enum {
   NORMAL_LOAD,
+  /**
+   * A normal load which leaves the reference counts of clean slabs to be
+   * loaded in the background once the VDO is online.
+   **/
+  LAZY_LOAD,
   DEFER_LOAD,
   NO_LOAD
 } SlabDepotLoadType;
@@ -323,6 +328,48 @@ SlabCount getDepotSlabCount(const SlabDepot *depot)
 SlabCount getDepotUnrecoveredSlabCount(const SlabDepot *depot)
   __attribute__((warn_unused_result));
 
+/**
+ * Configure how many slabs each zone of the depot may scrub at once, and how
+ * much slab metadata each zone's background scrubbing may be reading at
+ * once. This may be called only before the depot starts scrubbing.
+ *
+ * @param depot        The slab depot
+ * @param layer        The physical layer below the depot
+ * @param concurrency  The most slabs to scrub at once in each zone
+ * @param ioBudget     The number of metadata blocks which background
+ *                     scrubbing in each zone may be reading at once, or 0 for
+ *                     no limit
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+int configureSlabScrubbing(SlabDepot     *depot,
+                           PhysicalLayer *layer,
+                           unsigned int   concurrency,
+                           BlockCount     ioBudget)
+  __attribute__((warn_unused_result));
+
+/**
+ * Set whether each zone of the depot compacts the reference counts of slabs
+ * which have gone cold. This may be called only before the depot starts
+ * allocating.
+ *
+ * @param depot    The slab depot
+ * @param compact  Whether to compact the reference counts of cold slabs
+ **/
+void setDepotColdSlabCompaction(SlabDepot *depot, bool compact);
+
+/**
+ * Get the slab scrubbing progress of the depot, summed over all zones. The
+ * estimated time remaining is that of the slowest zone. This may be called
+ * from any thread.
+ *
+ * @param depot  The slab depot
+ *
+ * @return The scrubbing progress of the depot
+ **/
+SlabScrubbingStatistics getDepotScrubbingStatistics(const SlabDepot *depot)
+  __attribute__((warn_unused_result));
+
 /**
  * Get the aggregated slab journal statistics for the depot.
  *
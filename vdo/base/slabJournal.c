@@ -24,6 +24,7 @@
 #include "logger.h"
 #include "memoryAlloc.h"
 #include "stringUtils.h"
+#include "timeUtils.h"
 
 #include "blockAllocatorInternals.h"
 #include "dataVIO.h"
@@ -997,7 +998,7 @@ static void addEntryFromWaiter(Waiter *waiter, void *context)
     }
   }
 
-  JournalPoint slabJournalPoint = {
+  dataVIO->slabJournalPoint = (JournalPoint) {
     .sequenceNumber = header->sequenceNumber,
     .entryCount     = header->entryCount,
   };
@@ -1005,11 +1006,108 @@ static void addEntryFromWaiter(Waiter *waiter, void *context)
   addEntry(journal, dataVIO->operation.pbn, dataVIO->operation.type,
            &dataVIO->recoveryJournalPoint);
 
-  // Now that an entry has been made in the slab journal, update the
-  // reference counts.
-  int result = modifySlabReferenceCount(journal->slab, &slabJournalPoint,
-                                        dataVIO->operation);
-  continueDataVIO(dataVIO, result);
+  // Now that an entry has been made in the slab journal, the reference count
+  // update can be applied along with those of the other new entries.
+  int result = enqueueDataVIO(&journal->updateWaiters, dataVIO,
+                              THIS_LOCATION("$F($j-$js)"));
+  if (result != VDO_SUCCESS) {
+    continueDataVIO(dataVIO, result);
+  }
+}
+
+/**
+ * Implements WaiterComparator. Order reference count updates by slab journal
+ * block and then by physical block number. Updates are never reordered across
+ * slab journal blocks, since a reference block may only hold the lock on the
+ * oldest journal block with an entry for it.
+ *
+ * @param waiter1  The first DataVIO waiting to update a reference count
+ * @param waiter2  The second DataVIO waiting to update a reference count
+ *
+ * @return a negative value, zero, or a positive value as the first update
+ *         should be applied before, with, or after the second
+ **/
+static int compareReferenceUpdates(const Waiter *waiter1,
+                                   const Waiter *waiter2)
+{
+  const DataVIO *dataVIO1 = waiterAsDataVIO((Waiter *) waiter1);
+  const DataVIO *dataVIO2 = waiterAsDataVIO((Waiter *) waiter2);
+  SequenceNumber block1 = dataVIO1->slabJournalPoint.sequenceNumber;
+  SequenceNumber block2 = dataVIO2->slabJournalPoint.sequenceNumber;
+  if (block1 != block2) {
+    return ((block1 < block2) ? -1 : 1);
+  }
+
+  PhysicalBlockNumber pbn1 = dataVIO1->operation.pbn;
+  PhysicalBlockNumber pbn2 = dataVIO2->operation.pbn;
+  if (pbn1 != pbn2) {
+    return ((pbn1 < pbn2) ? -1 : 1);
+  }
+
+  return 0;
+}
+
+/**
+ * Implements WaiterCallback. Release a DataVIO whose reference count update
+ * has been applied; any error from the update is already in its completion.
+ *
+ * @param waiter   The DataVIO
+ * @param context  Unused
+ **/
+static void continueUpdatedWaiter(Waiter *waiter,
+                                  void   *context __attribute__((unused)))
+{
+  continueDataVIO(waiterAsDataVIO(waiter), VDO_SUCCESS);
+}
+
+/**
+ * Apply the reference count updates for all the entries which have been made
+ * since the last batch, in order of physical block number within each slab
+ * journal block so that the counters and reference blocks are visited in
+ * order, and then release the VIOs which made the entries.
+ *
+ * @param journal  The journal whose entries have been made
+ *
+ * @return <code>true</code> if there were any updates to apply
+ **/
+static bool applyReferenceCountUpdates(SlabJournal *journal)
+{
+  if (!hasWaiters(&journal->updateWaiters)) {
+    return false;
+  }
+
+  WaitQueue updates;
+  initializeWaitQueue(&updates);
+  transferAllWaiters(&journal->updateWaiters, &updates);
+  sortWaiters(&updates, compareReferenceUpdates);
+  size_t updateCount = countWaiters(&updates);
+
+  // Apply every update before releasing any of the VIOs, since a released
+  // VIO may go on to do a great deal of other work on this thread.
+  WaitQueue applied;
+  initializeWaitQueue(&applied);
+  AbsTime start = currentTime(CLOCK_MONOTONIC);
+  while (hasWaiters(&updates)) {
+    Waiter  *waiter  = dequeueNextWaiter(&updates);
+    DataVIO *dataVIO = waiterAsDataVIO(waiter);
+    int result = modifySlabReferenceCount(journal->slab,
+                                          &dataVIO->slabJournalPoint,
+                                          dataVIO->operation);
+    setCompletionResult(dataVIOAsCompletion(dataVIO), result);
+    result = enqueueWaiter(&applied, waiter);
+    if (result != VDO_SUCCESS) {
+      continueDataVIO(dataVIO, result);
+    }
+  }
+  RelTime elapsed = timeDifference(currentTime(CLOCK_MONOTONIC), start);
+
+  relaxedAdd64(&journal->events->updateBatches, 1);
+  relaxedAdd64(&journal->events->updatesApplied, updateCount);
+  relaxedAdd64(&journal->events->updateNanoseconds,
+               relTimeToNanoseconds(elapsed));
+
+  notifyAllWaiters(&applied, continueUpdatedWaiter, NULL);
+  return true;
 }
 
 /**
@@ -1027,21 +1125,13 @@ static inline bool isNextEntryABlockMapIncrement(SlabJournal *journal)
 }
 
 /**
- * Add as many entries as possible from the queue of VIOs waiting to make
- * entries. By processing the queue in order, we ensure that slab journal
- * entries are made in the same order as recovery journal entries for the
- * same increment or decrement.
+ * Make as many entries as possible from the queue of VIOs waiting to make
+ * entries, stopping when the journal has no room for the next one.
  *
  * @param journal  The journal to which entries may be added
  **/
-static void addEntries(SlabJournal *journal)
+static void makeEntries(SlabJournal *journal)
 {
-  if (journal->addingEntries) {
-    // Protect against re-entrancy.
-    return;
-  }
-
-  journal->addingEntries = true;
   while (hasWaiters(&journal->entryWaiters)) {
     if (journal->partialWriteInProgress || slabIsRebuilding(journal->slab)) {
       // Don't add entries while rebuilding or while a partial write is
@@ -1122,6 +1212,30 @@ static void addEntries(SlabJournal *journal)
 
     notifyNextWaiter(&journal->entryWaiters, addEntryFromWaiter, journal);
   }
+}
+
+/**
+ * Add as many entries as possible from the queue of VIOs waiting to make
+ * entries. By processing the queue in order, we ensure that slab journal
+ * entries are made in the same order as recovery journal entries for the
+ * same increment or decrement. The reference count updates for the entries
+ * are applied in batches once the entries have been made.
+ *
+ * @param journal  The journal to which entries may be added
+ **/
+static void addEntries(SlabJournal *journal)
+{
+  if (journal->addingEntries) {
+    // Protect against re-entrancy.
+    return;
+  }
+
+  journal->addingEntries = true;
+  do {
+    makeEntries(journal);
+    // Releasing the VIOs whose entries were just made may have queued more
+    // VIOs to make entries.
+  } while (applyReferenceCountUpdates(journal));
 
   journal->addingEntries = false;
 
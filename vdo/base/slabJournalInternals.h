@@ -189,6 +189,9 @@ struct slabJournal {
   Waiter                       flushWaiter;
   /** The queue of VIOs waiting to make an entry */
   WaitQueue                    entryWaiters;
+  /** The VIOs which have made entries but whose reference count updates
+      have not yet been applied */
+  WaitQueue                    updateWaiters;
   /** The parent slab reference of this journal */
   Slab                        *slab;
 
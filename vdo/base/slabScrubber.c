@@ -23,6 +23,7 @@
 
 #include "logger.h"
 #include "memoryAlloc.h"
+#include "timeUtils.h"
 
 #include "blockAllocator.h"
 #include "readOnlyModeContext.h"
@@ -40,8 +41,8 @@ int makeSlabScrubber(PhysicalLayer                  *layer,
     return result;
   }
 
-  result = makeSlabRebuildCompletion(layer, slabJournalSize,
-                                     &scrubber->slabRebuildCompletion);
+  scrubber->slabJournalSize = slabJournalSize;
+  result = configureSlabScrubber(scrubber, layer, 1, slabJournalSize, 0);
   if (result != VDO_SUCCESS) {
     freeSlabScrubber(&scrubber);
     return result;
@@ -55,6 +56,60 @@ int makeSlabScrubber(PhysicalLayer                  *layer,
   return VDO_SUCCESS;
 }
 
+/**********************************************************************/
+int configureSlabScrubber(SlabScrubber  *scrubber,
+                          PhysicalLayer *layer,
+                          unsigned int   concurrency,
+                          BlockCount     scrubCost,
+                          BlockCount     ioBudget)
+{
+  int result = ASSERT(!scrubber->isScrubbing,
+                      "scrubber must not be configured while scrubbing");
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  scrubber->scrubCost = scrubCost;
+  scrubber->ioBudget  = ioBudget;
+  result = ASSERT((concurrency <= MAX_SCRUBBING_CONCURRENCY),
+                  "scrubbing concurrency %u must not exceed %u",
+                  concurrency, MAX_SCRUBBING_CONCURRENCY);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  while (scrubber->rebuildCount < concurrency) {
+    VDOCompletion **rebuildPtr
+      = &scrubber->slabRebuilds[scrubber->rebuildCount];
+    result = makeSlabRebuildCompletion(layer, scrubber->slabJournalSize,
+                                       rebuildPtr);
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+
+    scrubber->idleRebuilds[scrubber->idleCount++] = *rebuildPtr;
+    scrubber->rebuildCount++;
+  }
+
+  return VDO_SUCCESS;
+}
+
+/**
+ * Free the slab rebuild completions of a scrubber, none of which may be in
+ * use.
+ *
+ * @param scrubber  The scrubber
+ **/
+static void freeSlabRebuilds(SlabScrubber *scrubber)
+{
+  for (unsigned int i = 0; i < scrubber->rebuildCount; i++) {
+    freeSlabRebuildCompletion(&scrubber->slabRebuilds[i]);
+  }
+
+  scrubber->rebuildCount = 0;
+  scrubber->idleCount    = 0;
+}
+
 /**********************************************************************/
 void freeSlabScrubber(SlabScrubber **scrubberPtr)
 {
@@ -63,7 +118,7 @@ void freeSlabScrubber(SlabScrubber **scrubberPtr)
   }
 
   SlabScrubber *scrubber = *scrubberPtr;
-  freeSlabRebuildCompletion(&scrubber->slabRebuildCompletion);
+  freeSlabRebuilds(scrubber);
   FREE(scrubber);
   *scrubberPtr = NULL;
 }
@@ -144,66 +199,124 @@ static void finishScrubbing(SlabScrubber *scrubber)
   scrubber->isScrubbing      = false;
   scrubber->highPriorityOnly = false;
   notifyAllWaiters(&scrubber->waiters, NULL, NULL);
-  if (!hasSlabsToScrub(scrubber)) {
-    freeSlabRebuildCompletion(&scrubber->slabRebuildCompletion);
-  }
+  // The slab rebuild completions are kept until the scrubber is freed, since
+  // more slabs may be registered for scrubbing later.
   completeCompletion(&scrubber->completion);
 }
 
-/**********************************************************************/
-static void scrubNextSlab(SlabScrubber *scrubber);
-
 /**
- * Notify the scrubber that a slab has been scrubbed. This callback is
- * registered in scrubSlabs().
+ * Check whether the scrubber should start scrubbing another slab.
  *
- * @param completion  The slab rebuild completion
+ * @param scrubber  The scrubber
+ *
+ * @return <code>true</code> if another slab scrub should be launched
  **/
-static void slabScrubbed(VDOCompletion *completion)
+static bool shouldScrubAnotherSlab(SlabScrubber *scrubber)
 {
-  SlabScrubber *scrubber = completion->parent;
-  relaxedAdd64(&scrubber->slabCount, -1);
-  notifyAllWaiters(&scrubber->waiters, NULL, NULL);
-  scrubNextSlab(scrubber);
+  if ((scrubber->idleCount == 0) || scrubber->stopScrubbing
+      || (scrubber->completion.result != VDO_SUCCESS)) {
+    return false;
+  }
+
+  if (!isRingEmpty(&scrubber->highPrioritySlabs)) {
+    // High priority slabs are being scrubbed while the VDO is loading.
+    return true;
+  }
+
+  if (scrubber->highPriorityOnly || isRingEmpty(&scrubber->slabs)) {
+    return false;
+  }
+
+  unsigned int activeCount = scrubber->rebuildCount - scrubber->idleCount;
+  if ((activeCount == 0) || hasWaiters(&scrubber->waiters)) {
+    // Always make progress, and go as fast as possible while allocations
+    // are waiting for a clean slab.
+    return true;
+  }
+
+  // Otherwise, keep background scrubbing within its I/O budget so that it
+  // does not crowd out user I/O.
+  return ((scrubber->ioBudget == 0)
+          || (((activeCount + 1) * scrubber->scrubCost)
+              <= scrubber->ioBudget));
 }
 
 /**
- * Scrub the next slab if there is one.
+ * Start scrubbing as many slabs as the scrubber's concurrency and I/O budget
+ * allow, and finish scrubbing if there is nothing left to do.
  *
  * @param scrubber  The scrubber
  **/
-static void scrubNextSlab(SlabScrubber *scrubber)
+static void scrubMoreSlabs(SlabScrubber *scrubber)
 {
+  if (scrubber->launching) {
+    // A scrub finished synchronously inside the loop below, which will
+    // take care of launching its replacement.
+    return;
+  }
+
   if (isReadOnly(scrubber->readOnlyContext)) {
     setCompletionResult(&scrubber->completion, VDO_READ_ONLY);
-    finishScrubbing(scrubber);
-    return;
   }
 
-  Slab *slab = getNextSlab(scrubber);
-  if (scrubber->stopScrubbing || (slab == NULL)
-      || (scrubber->highPriorityOnly
-          && isRingEmpty(&scrubber->highPrioritySlabs))) {
+  scrubber->launching = true;
+  while (shouldScrubAnotherSlab(scrubber)) {
+    Slab *slab = getNextSlab(scrubber);
+    unspliceRingNode(&slab->ringNode);
+    VDOCompletion *rebuild = scrubber->idleRebuilds[--scrubber->idleCount];
+    relaxedAdd64(&scrubber->slabsInProgress, 1);
+    resetCompletion(rebuild);
+    scrubSlab(slab, rebuild);
+  }
+  scrubber->launching = false;
+
+  if (scrubber->idleCount == scrubber->rebuildCount) {
     finishScrubbing(scrubber);
-    return;
   }
+}
 
-  unspliceRingNode(&slab->ringNode);
-  resetCompletion(scrubber->slabRebuildCompletion);
-  scrubSlab(slab, scrubber->slabRebuildCompletion);
+/**
+ * Return a slab rebuild completion to the scrubber once it has finished
+ * scrubbing a slab.
+ *
+ * @param scrubber  The scrubber
+ * @param rebuild   The completion which is no longer in use
+ **/
+static void returnSlabRebuild(SlabScrubber *scrubber, VDOCompletion *rebuild)
+{
+  scrubber->idleRebuilds[scrubber->idleCount++] = rebuild;
+  relaxedAdd64(&scrubber->slabsInProgress, -1);
 }
 
 /**
- * Handle errors while rebuilding a slab.
+ * Notify the scrubber that a slab has been scrubbed. This callback is
+ * registered in scrubSlabs().
+ *
+ * @param completion  The slab rebuild completion
+ **/
+static void slabScrubbed(VDOCompletion *completion)
+{
+  SlabScrubber *scrubber = completion->parent;
+  returnSlabRebuild(scrubber, completion);
+  relaxedAdd64(&scrubber->slabCount, -1);
+  relaxedAdd64(&scrubber->slabsScrubbed, 1);
+  notifyAllWaiters(&scrubber->waiters, NULL, NULL);
+  scrubMoreSlabs(scrubber);
+}
+
+/**
+ * Handle errors while rebuilding a slab. Scrubbing finishes once any other
+ * slabs being scrubbed are done.
  *
  * @param completion  The slab rebuild completion
  **/
 static void handleScrubberError(VDOCompletion *completion)
 {
   SlabScrubber *scrubber = completion->parent;
+  returnSlabRebuild(scrubber, completion);
   enterReadOnlyMode(scrubber->readOnlyContext, completion->result);
   setCompletionResult(&scrubber->completion, completion->result);
-  finishScrubbing(scrubber);
+  scrubMoreSlabs(scrubber);
 }
 
 /**********************************************************************/
@@ -221,9 +334,17 @@ void scrubSlabs(SlabScrubber *scrubber,
     return;
   }
 
-  prepareCompletion(scrubber->slabRebuildCompletion, slabScrubbed,
-                    handleScrubberError, getCallbackThreadID(), scrubber);
-  scrubNextSlab(scrubber);
+  for (unsigned int i = 0; i < scrubber->rebuildCount; i++) {
+    prepareCompletion(scrubber->slabRebuilds[i], slabScrubbed,
+                      handleScrubberError, getCallbackThreadID(), scrubber);
+  }
+
+  // Measure the scrubbing rate from the start of this pass, so that the time
+  // between passes does not count against it.
+  relaxedStore64(&scrubber->passStartScrubbed,
+                 relaxedLoad64(&scrubber->slabsScrubbed));
+  relaxedStore64(&scrubber->startTime, nowUsec());
+  scrubMoreSlabs(scrubber);
 }
 
 /**********************************************************************/
@@ -260,11 +381,38 @@ int enqueueCleanSlabWaiter(SlabScrubber *scrubber, Waiter *waiter)
   return enqueueWaiter(&scrubber->waiters, waiter);
 }
 
+/**********************************************************************/
+SlabScrubbingStatistics getSlabScrubbingStatistics(const SlabScrubber *scrubber)
+{
+  SlabScrubbingStatistics stats = {
+    .slabsRemaining  = getScrubberSlabCount(scrubber),
+    .slabsInProgress = relaxedLoad64(&scrubber->slabsInProgress),
+    .slabsScrubbed   = relaxedLoad64(&scrubber->slabsScrubbed),
+  };
+
+  uint64_t startTime    = relaxedLoad64(&scrubber->startTime);
+  uint64_t startCount   = relaxedLoad64(&scrubber->passStartScrubbed);
+  uint64_t passScrubbed = ((stats.slabsScrubbed > startCount)
+                           ? (stats.slabsScrubbed - startCount) : 0);
+  uint64_t elapsed      = ((startTime == 0) ? 0 : (nowUsec() - startTime));
+  if (elapsed > 0) {
+    stats.slabsPerMinute = (passScrubbed * 60 * 1000000) / elapsed;
+  }
+
+  if (stats.slabsPerMinute > 0) {
+    stats.secondsRemaining = (stats.slabsRemaining * 60) / stats.slabsPerMinute;
+  }
+
+  return stats;
+}
+
 /**********************************************************************/
 void dumpSlabScrubber(const SlabScrubber *scrubber)
 {
-  logInfo("slabScrubber slabCount %u waiters %zu %s%s%s",
+  logInfo("slabScrubber slabCount %u active %u/%u waiters %zu %s%s%s",
           getScrubberSlabCount(scrubber),
+          (scrubber->rebuildCount - scrubber->idleCount),
+          scrubber->rebuildCount,
           countWaiters(&scrubber->waiters),
           scrubber->isScrubbing ? "isScrubbing " : "",
           scrubber->stopScrubbing ? "stopScrubbing " : "",
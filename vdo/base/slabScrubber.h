@@ -23,9 +23,15 @@
 #define SLAB_SCRUBBER_H
 
 #include "completion.h"
+#include "statistics.h"
 #include "types.h"
 #include "waitQueue.h"
 
+enum {
+  /** The most slabs which one slab scrubber may scrub at once */
+  MAX_SCRUBBING_CONCURRENCY = 16,
+};
+
 /**
  * Create a slab scrubber
  *
@@ -42,6 +48,27 @@ int makeSlabScrubber(PhysicalLayer                  *layer,
                      SlabScrubber                  **scrubberPtr)
   __attribute__((warn_unused_result));
 
+/**
+ * Set how many slabs a slab scrubber may scrub at once, and how much slab
+ * metadata it may be reading at once while no allocation is waiting for a
+ * clean slab. This must be called before the scrubber starts scrubbing.
+ *
+ * @param scrubber     The scrubber to configure
+ * @param layer        The physical layer of the VDO
+ * @param concurrency  The most slabs to scrub at once
+ * @param scrubCost    The number of metadata blocks read to scrub one slab
+ * @param ioBudget     The number of metadata blocks which background
+ *                     scrubbing may be reading at once, or 0 for no limit
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+int configureSlabScrubber(SlabScrubber  *scrubber,
+                          PhysicalLayer *layer,
+                          unsigned int   concurrency,
+                          BlockCount     scrubCost,
+                          BlockCount     ioBudget)
+  __attribute__((warn_unused_result));
+
 /**
  * Free a slab scrubber and null out the reference to it.
  *
@@ -115,7 +142,7 @@ void scrubHighPrioritySlabs(SlabScrubber  *scrubber,
                             VDOAction     *errorHandler);
 
 /**
- * Tell the scrubber to stop scrubbing after it finishes the slab it is
+ * Tell the scrubber to stop scrubbing after it finishes the slabs it is
  * currently working on.
  *
  * @param scrubber  The scrubber to stop
@@ -143,6 +170,17 @@ int enqueueCleanSlabWaiter(SlabScrubber *scrubber, Waiter *waiter);
 SlabCount getScrubberSlabCount(const SlabScrubber *scrubber)
   __attribute__((warn_unused_result));
 
+/**
+ * Get the scrubbing progress of a slab scrubber. This may be called from any
+ * thread.
+ *
+ * @param scrubber  The scrubber to query
+ *
+ * @return The progress of the scrubber
+ **/
+SlabScrubbingStatistics getSlabScrubbingStatistics(const SlabScrubber *scrubber)
+  __attribute__((warn_unused_result));
+
 /**
  * Dump information about a slab scrubber to the log for debugging.
  *
@@ -39,6 +39,16 @@ struct slabScrubber {
   // The number of slabs that are unrecovered or being scrubbed. This field is
   // modified by the physical zone thread, but is queried by other threads.
   Atomic64                       slabCount;
+  // The progress counters below are likewise only modified by the physical
+  // zone thread.
+  /** The number of slabs scrubbed since the scrubber was made */
+  Atomic64                       slabsScrubbed;
+  /** The number of slabs being scrubbed right now */
+  Atomic64                       slabsInProgress;
+  /** The time (in microseconds) at which the current scrubbing pass started */
+  Atomic64                       startTime;
+  /** The value of slabsScrubbed when the current scrubbing pass started */
+  Atomic64                       passStartScrubbed;
 
   /** Whether the scrubber is actively scrubbing */
   bool                           isScrubbing;
@@ -46,8 +56,23 @@ struct slabScrubber {
   bool                           stopScrubbing;
   /** Whether to only scrub high-priority slabs */
   bool                           highPriorityOnly;
-  /** The completion for rebuilding a slab */
-  VDOCompletion                 *slabRebuildCompletion;
+  /** Whether slab scrubs are being launched */
+  bool                           launching;
+  /** The size of a slab journal in blocks */
+  BlockCount                     slabJournalSize;
+  /** The number of metadata blocks read to scrub one slab */
+  BlockCount                     scrubCost;
+  /** The number of metadata blocks which background scrubbing may be
+      reading at once, or 0 for no limit */
+  BlockCount                     ioBudget;
+  /** The number of slab rebuild completions */
+  unsigned int                   rebuildCount;
+  /** The number of slab rebuild completions which are not in use */
+  unsigned int                   idleCount;
+  /** The completions for rebuilding slabs */
+  VDOCompletion                 *slabRebuilds[MAX_SCRUBBING_CONCURRENCY];
+  /** The slab rebuild completions which are not in use */
+  VDOCompletion                 *idleRebuilds[MAX_SCRUBBING_CONCURRENCY];
   /** The context for entering read-only mode */
   ReadOnlyModeContext           *readOnlyContext;
 };
@@ -104,6 +104,7 @@ static BlockCount getApproximateFreeBlocks(SlabSummary *summary,
 static void finishUpdatingSlabSummaryBlock(VDOCompletion *completion);
 static void handleWriteError(VDOCompletion *completion);
 static void launchWrite(SlabSummaryBlock *summaryBlock);
+static void launchBatchedWrites(VDOCompletion *completion);
 
 /**
  * Initialize a SlabSummaryBlock.
@@ -174,6 +175,7 @@ static int makeSlabSummaryZone(SlabSummary         *summary,
   SlabSummaryZone *summaryZone = summary->zones[zoneNumber];
   summaryZone->summary         = summary;
   summaryZone->zoneNumber      = zoneNumber;
+  summaryZone->threadID        = threadID;
   summaryZone->entries         = entries;
 
   if (layer->createMetadataVIO == NULL) {
@@ -182,6 +184,12 @@ static int makeSlabSummaryZone(SlabSummary         *summary,
     return VDO_SUCCESS;
   }
 
+  result = initializeEnqueueableCompletion(&summaryZone->batchCompletion,
+                                           SLAB_SUMMARY_COMPLETION, layer);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
   // Initialize each block.
   for (BlockCount i = 0; i < summary->blocksPerZone; i++, pbn++) {
     result = initializeSlabSummaryBlock(layer, summaryZone, threadID, entries,
@@ -286,6 +294,7 @@ void freeSlabSummary(SlabSummary **slabSummaryPtr)
         freeVIO(&summaryZone->summaryBlocks[i].vio);
         FREE(summaryZone->summaryBlocks[i].outgoingEntries);
       }
+      destroyEnqueueable(&summaryZone->batchCompletion);
       FREE(summaryZone);
     }
   }
@@ -309,7 +318,7 @@ SlabSummaryZone *getSummaryForZone(SlabSummary *summary, ZoneCount zone)
  **/
 static void checkForSaveComplete(SlabSummaryZone *summaryZone)
 {
-  if (summaryZone->saveWaiter == NULL) {
+  if ((summaryZone->saveWaiter == NULL) || summaryZone->batchPending) {
     return;
   }
 
@@ -459,6 +468,20 @@ static void launchWriteOfAllBlocks(SlabSummaryZone *summaryZone,
   }
 }
 
+/**
+ * Launch the writes of every block updated since the batch completion was
+ * queued. This callback is registered in updateSlabSummaryEntry().
+ *
+ * @param completion  The batch completion of a zone
+ **/
+static void launchBatchedWrites(VDOCompletion *completion)
+{
+  SlabSummaryZone *summaryZone = completion->parent;
+  summaryZone->batchPending    = false;
+  launchWriteOfAllBlocks(summaryZone, false);
+  checkForSaveComplete(summaryZone);
+}
+
 /**********************************************************************/
 void saveSlabSummaryZone(SlabSummaryZone *summaryZone, VDOCompletion *parent)
 {
@@ -533,14 +556,20 @@ void updateSlabSummaryEntry(SlabSummaryZone *summaryZone,
     return;
   }
 
-  SlabSummaryBlock *block = getSummaryBlockForSlab(summaryZone, slabNumber);
+  SlabSummary      *summary = summaryZone->summary;
+  SlabSummaryBlock *block   = getSummaryBlockForSlab(summaryZone, slabNumber);
+  atomicAdd64(&summary->statistics.entryUpdates, 1);
+  if (block->needsWriting) {
+    // This update will go out with the write an earlier one is waiting for.
+    atomicAdd64(&summary->statistics.updatesCoalesced, 1);
+  }
+
   block->needsWriting     = true;
   SlabSummaryEntry *entry = &summaryZone->entries[slabNumber];
   entry->tailBlockOffset  = tailBlockOffset;
   entry->loadRefCounts    = (entry->loadRefCounts || loadRefCounts);
   entry->isDirty          = !isClean;
-  entry->fullnessHint
-    = computeFullnessHint(summaryZone->summary, freeBlocks);
+  entry->fullnessHint     = computeFullnessHint(summary, freeBlocks);
 
   result = enqueueWaiter(&block->nextUpdateWaiters, waiter);
   if (result != VDO_SUCCESS) {
@@ -548,7 +577,20 @@ void updateSlabSummaryEntry(SlabSummaryZone *summaryZone,
     return;
   }
 
-  launchWrite(block);
+  if (summaryZone->batchPending) {
+    return;
+  }
+
+  /*
+   * Rather than writing the block now, requeue the launch of the write behind
+   * the work already queued on this thread, so that every update made by that
+   * work goes out in the same write, and all their waiters are notified when
+   * it completes.
+   */
+  summaryZone->batchPending = true;
+  prepareForRequeue(&summaryZone->batchCompletion, launchBatchedWrites,
+                    launchBatchedWrites, summaryZone->threadID, summaryZone);
+  invokeCallback(&summaryZone->batchCompletion);
 }
 
 /**********************************************************************/
@@ -724,6 +766,8 @@ SlabSummaryStatistics getSlabSummaryStatistics(const SlabSummary *summary)
 {
   const AtomicSlabSummaryStatistics *atoms = &summary->statistics;
   return (SlabSummaryStatistics) {
-    .blocksWritten = atomicLoad64(&atoms->blocksWritten),
+    .blocksWritten    = atomicLoad64(&atoms->blocksWritten),
+    .entryUpdates     = atomicLoad64(&atoms->entryUpdates),
+    .updatesCoalesced = atomicLoad64(&atoms->updatesCoalesced),
   };
 }
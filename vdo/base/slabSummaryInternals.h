@@ -76,6 +76,10 @@ typedef struct slabSummaryBlock {
 typedef struct atomicSlabSummaryStatistics {
   /** Number of blocks written */
   Atomic64 blocksWritten;
+  /** Number of entry updates made */
+  Atomic64 entryUpdates;
+  /** Number of entry updates which shared a block write with another */
+  Atomic64 updatesCoalesced;
 } AtomicSlabSummaryStatistics;
 
 /**
@@ -93,6 +97,12 @@ struct slabSummaryZone {
   SlabSummary      *summary;
   /** The number of this zone */
   ZoneCount         zoneNumber;
+  /** The ID of the physical zone thread of this zone */
+  ThreadID          threadID;
+  /** The completion which launches the writes of a batch of updates */
+  VDOCompletion     batchCompletion;
+  /** Whether the batch completion is queued */
+  bool              batchPending;
   /** The completion waiting on the zone to be saved */
   VDOCompletion    *saveWaiter;
   /** The pending action, if any */
@@ -24,7 +24,9 @@
 #include "types.h"
 
 enum {
-  STATISTICS_VERSION = 30,
+  STATISTICS_VERSION = 42,
+  /** The number of power-of-two buckets in a journal commit histogram */
+  JOURNAL_HISTOGRAM_BUCKETS = 16,
 };
 
 typedef struct {
@@ -34,6 +36,10 @@ typedef struct {
   uint64_t slabsOpened;
   /** The number of times since loading that a slab has been re-opened */
   uint64_t slabsReopened;
+  /** The number of allocations which continued a sequential logical run */
+  uint64_t sequentialAllocations;
+  /** The number of those allocations which were physically contiguous */
+  uint64_t contiguousAllocations;
 } BlockAllocatorStatistics;
 
 /**
@@ -62,8 +68,46 @@ typedef struct {
   CommitStatistics entries;
   /** Write/Commit totals for journal blocks */
   CommitStatistics blocks;
+  /** Number of partial block commits delayed to gather more entries */
+  uint64_t groupCommits;
+  /** Commits by entry count; bucket i counts [2^i, 2^(i+1)), from 1 */
+  uint64_t entriesPerCommit[JOURNAL_HISTOGRAM_BUCKETS];
+  /** Commits by latency; bucket i counts [2^i, 2^(i+1)) microseconds */
+  uint64_t commitLatency[JOURNAL_HISTOGRAM_BUCKETS];
+  /** Number of entries not made because a write would not change a mapping */
+  uint64_t entriesElided;
+  /** Number of times the journal heads were advanced */
+  uint64_t reaps;
+  /** Number of flushes issued before advancing the journal heads */
+  uint64_t reapFlushes;
 } RecoveryJournalStatistics;
 
+/** Throughput of the most recent recovery journal replay */
+typedef struct {
+  /** Number of journal entries replayed into slab journals */
+  uint64_t slabJournalEntries;
+  /** Microseconds spent replaying entries into slab journals */
+  uint64_t slabJournalTime;
+  /** Number of journal entries replayed into the block map */
+  uint64_t blockMapEntries;
+  /** Microseconds spent replaying entries into the block map */
+  uint64_t blockMapTime;
+} RecoveryStatistics;
+
+/** The progress of scrubbing unrecovered slabs. */
+typedef struct {
+  /** The number of slabs which are unrecovered or being scrubbed */
+  uint64_t slabsRemaining;
+  /** The number of slabs being scrubbed right now */
+  uint64_t slabsInProgress;
+  /** The number of slabs scrubbed since the VDO was loaded */
+  uint64_t slabsScrubbed;
+  /** The average rate of the current scrubbing pass, in slabs per minute */
+  uint64_t slabsPerMinute;
+  /** The estimated time until every slab is scrubbed, in seconds */
+  uint64_t secondsRemaining;
+} SlabScrubbingStatistics;
+
 /** The statistics for the compressed block packer. */
 typedef struct {
   /** Number of compressed data items written since startup */
@@ -86,18 +130,40 @@ typedef struct {
   uint64_t blocksWritten;
   /** Number of times we had to wait for the tail to write */
   uint64_t tailBusyCount;
+  /** Number of batches of reference count updates applied */
+  uint64_t updateBatches;
+  /** Number of reference count updates applied in those batches */
+  uint64_t updatesApplied;
+  /** Time spent applying those updates, in nanoseconds */
+  uint64_t updateNanoseconds;
+  /** Average number of reference count updates per batch */
+  uint64_t updatesPerBatch;
+  /** Average time to apply a reference count update, in nanoseconds */
+  uint64_t nanosecondsPerUpdate;
 } SlabJournalStatistics;
 
 /** The statistics for the slab summary. */
 typedef struct {
   /** Number of blocks written */
   uint64_t blocksWritten;
+  /** Number of entry updates made */
+  uint64_t entryUpdates;
+  /** Number of entry updates which shared a block write with another */
+  uint64_t updatesCoalesced;
 } SlabSummaryStatistics;
 
 /** The statistics for the reference counts. */
 typedef struct {
   /** Number of reference blocks written */
   uint64_t blocksWritten;
+  /** Number of slabs whose counters are currently compact */
+  uint64_t compactSlabs;
+  /** Bytes of counter memory currently released by compaction */
+  uint64_t memorySaved;
+  /** Number of times compact counters have been expanded */
+  uint64_t slabsExpanded;
+  /** Number of runs of adjacent reference blocks written together */
+  uint64_t writeRuns;
 } RefCountsStatistics;
 
 /** The statistics for the block map. */
@@ -130,6 +196,14 @@ typedef struct {
   uint64_t readOutgoing;
   /** number of gets that were already there */
   uint64_t foundInCache;
+  /** number of fetches of pages recently evicted from probation */
+  uint64_t ghostHits;
+  /** number of leaf page prefetches issued */
+  uint64_t prefetchIssued;
+  /** number of prefetched pages which were later requested */
+  uint64_t prefetchUsed;
+  /** number of prefetched pages discarded without being requested */
+  uint64_t prefetchWasted;
   /** number of gets requiring discard */
   uint64_t discardRequired;
   /** number of gets enqueued for their page */
@@ -142,6 +216,12 @@ typedef struct {
   uint64_t pagesSaved;
   /** the number of flushes issued */
   uint64_t flushCount;
+  /** number of pages written early by background writeback */
+  uint64_t writebackPages;
+  /** the current limit on background writes in flight */
+  uint64_t writebackLimit;
+  /** the most pages written in a single batch */
+  uint64_t largestWriteBatch;
 } BlockMapStatistics;
 
 /** The dedupe statistics from hash locks */
@@ -204,6 +284,10 @@ struct vdoStatistics {
   BlockAllocatorStatistics allocator;
   /** Counters for events in the recovery journal */
   RecoveryJournalStatistics journal;
+  /** Throughput of the most recent recovery journal replay */
+  RecoveryStatistics recovery;
+  /** The progress of slab scrubbing */
+  SlabScrubbingStatistics scrubbing;
   /** The statistics for the slab journals */
   SlabJournalStatistics slabJournal;
   /** The statistics for the slab summary */
@@ -330,6 +330,31 @@ static void setReadOnlyState(VDOCompletion *completion, bool saveSuperBlock)
   saveVDOComponentsAsync(vdo, completion);
 }
 
+/**********************************************************************/
+void beginSuperBlockWrite(VDO *vdo)
+{
+  vdo->threadData[0].superBlockAccessState = WRITING_SUPER_BLOCK;
+}
+
+/**********************************************************************/
+void finishSuperBlockWrite(VDO *vdo)
+{
+  ThreadData *adminThreadData = &vdo->threadData[0];
+  adminThreadData->superBlockAccessState = NOT_ACCESSING_SUPER_BLOCK;
+  VDOCompletion *waiter = adminThreadData->readOnlyModeWaiter;
+  if (waiter == NULL) {
+    return;
+  }
+
+  // The waiter has already set the read-only state in memory, but had to
+  // wait for this write to finish before saving it.
+  adminThreadData->readOnlyModeWaiter    = NULL;
+  adminThreadData->superBlockAccessState = WRITING_SUPER_BLOCK;
+  waiter->callback                       = readOnlyStateSaved;
+  waiter->errorHandler                   = handleSaveError;
+  saveVDOComponentsAsync(vdo, waiter);
+}
+
 /**
  * Set the VDO's state to read-only in memory only. This callback is registered
  * in makeVDOReadOnly().
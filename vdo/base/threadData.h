@@ -118,4 +118,23 @@ void waitUntilNotEnteringReadOnlyMode(VDO *vdo, VDOCompletion *waiter);
  **/
 void makeVDOReadOnly(VDO *vdo, int errorCode, bool saveSuperBlock);
 
+/**
+ * Note that the admin thread is writing the super block outside of a normal
+ * administrative operation, so that any attempt to enter read-only mode will
+ * wait for the write to finish before saving the read-only state. This must
+ * be called on the admin thread.
+ *
+ * @param vdo  The VDO whose super block is being written
+ **/
+void beginSuperBlockWrite(VDO *vdo);
+
+/**
+ * Note that a super block write started with beginSuperBlockWrite() has
+ * finished, and save the read-only state if a thread entered read-only mode
+ * while the write was in progress. This must be called on the admin thread.
+ *
+ * @param vdo  The VDO whose super block was written
+ **/
+void finishSuperBlockWrite(VDO *vdo);
+
 #endif /* THREAD_DATA_H */
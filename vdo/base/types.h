@@ -275,6 +275,17 @@ typedef enum {
   COMPRESS_POLICY_QAT,
 } CompressPolicy;
 
+/**
+ * The possible replacement policies for the block map page cache.
+ **/
+typedef enum {
+  PAGE_CACHE_POLICY_LRU,  ///< Evict the least recently used idle page.
+  PAGE_CACHE_POLICY_2Q,   ///< Admit new pages to a probationary FIFO and
+                          ///< only promote pages which are re-fetched
+                          ///< shortly after eviction, so that a single scan
+                          ///< cannot flush the working set.
+} PageCachePolicy;
+
 typedef enum {
   ZONE_TYPE_JOURNAL,
   ZONE_TYPE_LOGICAL,
@@ -368,6 +379,23 @@ typedef struct vdoLoadConfig {
   CompressPolicy        compressPolicy;
   /** the maximum age of a dirty block map page in recovery journal blocks */
   BlockCount            maximumAge;
+  /** the replacement policy for the block map page cache */
+  PageCachePolicy       cachePolicy;
+  /** whether to write dirty block map pages out gradually */
+  bool                  backgroundWriteback;
+  /** whether to come online before the block map has been recovered */
+  bool                  onlineRecovery;
+  /** whether to load the reference counts of clean slabs after coming
+      online */
+  bool                  lazyRefCountLoad;
+  /** the most slabs each physical zone may scrub at once */
+  unsigned int          scrubConcurrency;
+  /** the slab metadata blocks each zone's background scrubbing may be
+      reading at once (0 for no limit) */
+  BlockCount            scrubIOBudget;
+  /** whether to compact the reference counts of slabs which have gone
+      cold */
+  bool                  compactColdSlabs;
 } VDOLoadConfig;
 
 /**
@@ -377,6 +405,7 @@ typedef struct adminCompletion     AdminCompletion;
 typedef struct allocatingVIO       AllocatingVIO;
 typedef struct blockAllocator      BlockAllocator;
 typedef struct blockMap            BlockMap;
+typedef struct blockMapReplay      BlockMapReplay;
 typedef struct blockMapTree        BlockMapTree;
 typedef struct blockMapTreeZone    BlockMapTreeZone;
 typedef struct blockMapZone        BlockMapZone;
@@ -391,6 +420,7 @@ typedef struct lbnLock             LBNLock;
 typedef struct lockCounter         LockCounter;
 typedef struct logicalZone         LogicalZone;
 typedef struct objectPool          ObjectPool;
+typedef struct onlineRecovery      OnlineRecovery;
 typedef struct pbnLock             PBNLock;
 typedef struct physicalLayer       PhysicalLayer;
 typedef struct physicalZone        PhysicalZone;
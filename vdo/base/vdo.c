@@ -47,6 +47,7 @@
 #include "statusCodes.h"
 #include "threadConfig.h"
 #include "vdoLayout.h"
+#include "vdoRecovery.h"
 #include "vioWrite.h"
 #include "volumeGeometry.h"
 
@@ -156,6 +157,7 @@ int makeVDO(PhysicalLayer *layer, VDO **vdoPtr)
 /**********************************************************************/
 void destroyVDO(VDO *vdo)
 {
+  freeOnlineRecovery(&vdo->onlineRecovery);
   freeFlusher(&vdo->flusher);
   freePacker(&vdo->packer);
   freeRecoveryJournal(&vdo->recoveryJournal);
@@ -272,12 +274,13 @@ static int encodeVDOConfig(const VDOConfig *config, Buffer *buffer)
  * Encode the component data for the VDO itself.
  *
  * @param vdo     The vdo to encode
+ * @param state   The state to record for the VDO
  * @param buffer  The buffer in which to encode the VDO
  *
  * @return VDO_SUCCESS or an error
  **/
 __attribute__((warn_unused_result))
-static int encodeVDOComponent(const VDO *vdo, Buffer *buffer)
+static int encodeVDOComponent(const VDO *vdo, VDOState state, Buffer *buffer)
 {
   int result = encodeVersionNumber(VDO_COMPONENT_DATA_41_0, buffer);
   if (result != VDO_SUCCESS) {
@@ -286,7 +289,7 @@ static int encodeVDOComponent(const VDO *vdo, Buffer *buffer)
 
   size_t initialLength = contentLength(buffer);
 
-  result = putUInt32LEIntoBuffer(buffer, vdo->state);
+  result = putUInt32LEIntoBuffer(buffer, state);
   if (result != VDO_SUCCESS) {
     return result;
   }
@@ -316,8 +319,16 @@ static int encodeVDOComponent(const VDO *vdo, Buffer *buffer)
                 "encoded VDO component size must match structure size");
 }
 
-/**********************************************************************/
-static int encodeVDO(VDO *vdo)
+/**
+ * Encode the VDO and all of its components into the super block's component
+ * buffer.
+ *
+ * @param vdo    The VDO to encode
+ * @param state  The state to record for the VDO
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+static int encodeVDO(VDO *vdo, VDOState state)
 {
   Buffer *buffer = getComponentBuffer(vdo->superBlock);
   int result = resetBufferEnd(buffer, 0);
@@ -330,7 +341,7 @@ static int encodeVDO(VDO *vdo)
     return result;
   }
 
-  result = encodeVDOComponent(vdo, buffer);
+  result = encodeVDOComponent(vdo, state, buffer);
   if (result != VDO_SUCCESS) {
     return result;
   }
@@ -363,7 +374,7 @@ static int encodeVDO(VDO *vdo)
 /**********************************************************************/
 int saveVDOComponents(VDO *vdo)
 {
-  int result = encodeVDO(vdo);
+  int result = encodeVDO(vdo, vdo->state);
   if (result != VDO_SUCCESS) {
     return result;
   }
@@ -374,7 +385,15 @@ int saveVDOComponents(VDO *vdo)
 /**********************************************************************/
 void saveVDOComponentsAsync(VDO *vdo, VDOCompletion *parent)
 {
-  int result = encodeVDO(vdo);
+  saveVDOComponentsInStateAsync(vdo, vdo->state, parent);
+}
+
+/**********************************************************************/
+void saveVDOComponentsInStateAsync(VDO           *vdo,
+                                   VDOState       state,
+                                   VDOCompletion *parent)
+{
+  int result = encodeVDO(vdo, state);
   if (result != VDO_SUCCESS) {
     finishCompletion(parent, result);
     return;
@@ -407,7 +426,7 @@ int saveReconfiguredVDO(VDO *vdo)
     return result;
   }
 
-  result = encodeVDOComponent(vdo, buffer);
+  result = encodeVDOComponent(vdo, vdo->state, buffer);
   if (result != VDO_SUCCESS) {
     FREE(components);
     return result;
@@ -775,6 +794,12 @@ bool getVDOCompressing(VDO *vdo)
   return atomicLoadBool(&vdo->compressing);
 }
 
+/**********************************************************************/
+bool areVDOWritesHeld(VDO *vdo)
+{
+  return areRecoveryJournalEntriesHeld(vdo->recoveryJournal);
+}
+
 /**********************************************************************/
 static size_t getBlockMapCacheSize(const VDO *vdo)
 {
@@ -865,6 +890,8 @@ void getVDOStatistics(const VDO *vdo, VDOStatistics *stats)
   stats->blockSize          = VDO_BLOCK_SIZE;
   stats->completeRecoveries = vdo->completeRecoveries;
   stats->readOnlyRecoveries = vdo->readOnlyRecoveries;
+  stats->recovery           = vdo->recoveryStatistics;
+  stats->scrubbing          = getDepotScrubbingStatistics(depot);
   stats->blockMapCacheSize  = getBlockMapCacheSize(vdo);
 
   snprintf(stats->writePolicy, sizeof(stats->writePolicy), "%s",
@@ -987,6 +1014,48 @@ PageCount getConfiguredCacheSize(const VDO *vdo)
   return vdo->loadConfig.cacheSize;
 }
 
+/**********************************************************************/
+PageCachePolicy getConfiguredCachePolicy(const VDO *vdo)
+{
+  return vdo->loadConfig.cachePolicy;
+}
+
+/**********************************************************************/
+bool getConfiguredBackgroundWriteback(const VDO *vdo)
+{
+  return vdo->loadConfig.backgroundWriteback;
+}
+
+/**********************************************************************/
+bool getConfiguredOnlineRecovery(const VDO *vdo)
+{
+  return vdo->loadConfig.onlineRecovery;
+}
+
+/**********************************************************************/
+bool getConfiguredLazyRefCountLoad(const VDO *vdo)
+{
+  return vdo->loadConfig.lazyRefCountLoad;
+}
+
+/**********************************************************************/
+unsigned int getConfiguredScrubConcurrency(const VDO *vdo)
+{
+  return vdo->loadConfig.scrubConcurrency;
+}
+
+/**********************************************************************/
+BlockCount getConfiguredScrubIOBudget(const VDO *vdo)
+{
+  return vdo->loadConfig.scrubIOBudget;
+}
+
+/**********************************************************************/
+bool getConfiguredCompactColdSlabs(const VDO *vdo)
+{
+  return vdo->loadConfig.compactColdSlabs;
+}
+
 /**********************************************************************/
 PhysicalBlockNumber getFirstBlockOffset(const VDO *vdo)
 {
@@ -79,6 +79,17 @@ bool setVDOCompressing(VDO *vdo, bool enableCompression);
  **/
 bool getVDOCompressing(VDO *vdo);
 
+/**
+ * Check whether writes must be held back while the block map is recovered in
+ * the background. This may be called from any thread once the VDO has been
+ * loaded.
+ *
+ * @param vdo  The VDO
+ *
+ * @return <code>true</code> if writes are being held
+ **/
+bool areVDOWritesHeld(VDO *vdo);
+
 /**
  * Get the VDO statistics.
  *
@@ -211,6 +222,82 @@ BlockCount getConfiguredBlockMapMaximumAge(const VDO *vdo)
 PageCount getConfiguredCacheSize(const VDO *vdo)
   __attribute__((warn_unused_result));
 
+/**
+ * Get the configured block map page cache replacement policy of the VDO.
+ *
+ * @param vdo  The VDO
+ *
+ * @return The replacement policy for the block map page cache
+ **/
+PageCachePolicy getConfiguredCachePolicy(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Check whether the VDO is configured to write dirty block map pages out
+ * gradually rather than only when they expire.
+ *
+ * @param vdo  The VDO
+ *
+ * @return <code>true</code> if background writeback is enabled
+ **/
+bool getConfiguredBackgroundWriteback(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Check whether the VDO is configured to come online after a crash before
+ * the recovery journal has been replayed into the block map.
+ *
+ * @param vdo  The VDO
+ *
+ * @return <code>true</code> if online recovery is enabled
+ **/
+bool getConfiguredOnlineRecovery(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Check whether the VDO is configured to come online before the reference
+ * counts of its clean slabs have been loaded.
+ *
+ * @param vdo  The VDO
+ *
+ * @return <code>true</code> if reference counts are loaded lazily
+ **/
+bool getConfiguredLazyRefCountLoad(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Get the number of slabs each physical zone of the VDO is configured to
+ * scrub at once.
+ *
+ * @param vdo  The VDO
+ *
+ * @return The configured scrubbing concurrency (0 for the default)
+ **/
+unsigned int getConfiguredScrubConcurrency(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Get the number of slab metadata blocks which background scrubbing in each
+ * physical zone of the VDO is configured to be reading at once.
+ *
+ * @param vdo  The VDO
+ *
+ * @return The configured scrubbing I/O budget (0 for no limit)
+ **/
+BlockCount getConfiguredScrubIOBudget(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Check whether the VDO is configured to compact the reference counts of
+ * slabs which have gone cold.
+ *
+ * @param vdo  The VDO
+ *
+ * @return <code>true</code> if cold slabs are compacted
+ **/
+bool getConfiguredCompactColdSlabs(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
 /**
  * Get the location of the first block of the VDO.
  *
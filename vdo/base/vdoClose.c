@@ -32,6 +32,7 @@
 #include "slabSummary.h"
 #include "threadConfig.h"
 #include "vdoInternal.h"
+#include "vdoRecovery.h"
 
 /**
  * Extract the VDO from an AdminCompletion, checking that the current operation
@@ -210,6 +211,13 @@ static void closeCallback(VDOCompletion *completion)
     return;
   }
 
+  if (isRecoveringOnline(vdo)) {
+    // Nothing can be closed until the block map has been recovered.
+    prepareSubTask(vdo, closeCallback, getAdminThread(getThreadConfig(vdo)));
+    waitForOnlineRecovery(vdo, completion);
+    return;
+  }
+
   prepareSubTask(vdo, closeCompressionPacker,
                  getPackerZoneThread(getThreadConfig(vdo)));
   waitUntilNotEnteringReadOnlyMode(vdo, completion);
@@ -54,6 +54,8 @@ struct vdo {
   uint64_t              completeRecoveries;
   /* The number of times this VDO has recovered from a read-only state */
   uint64_t              readOnlyRecoveries;
+  /* The throughput of the most recent journal replay */
+  RecoveryStatistics    recoveryStatistics;
   /* The format-time configuration of this VDO */
   VDOConfig             config;
   /* The load-time configuration of this VDO */
@@ -76,6 +78,9 @@ struct vdo {
   /* The journal for block map recovery */
   RecoveryJournal      *recoveryJournal;
 
+  /* The recovery being completed while online, if any */
+  OnlineRecovery       *onlineRecovery;
+
   /* The slab depot */
   SlabDepot            *depot;
 
@@ -149,6 +154,19 @@ int saveVDOComponents(VDO *vdo)
  **/
 void saveVDOComponentsAsync(VDO *vdo, VDOCompletion *parent);
 
+/**
+ * Encode the VDO and save the super block asynchronously, recording the given
+ * state in place of the VDO's current one. This is for saves made while the
+ * VDO is in a state which must not be written to disk.
+ *
+ * @param vdo     The VDO whose state is being saved
+ * @param state   The state to record in the super block
+ * @param parent  The completion to notify when the save is complete
+ **/
+void saveVDOComponentsInStateAsync(VDO           *vdo,
+                                   VDOState       state,
+                                   VDOCompletion *parent);
+
 /**
  * Re-encode the VDO component after a reconfiguration and save the super
  * block synchronously. This function avoids the need to decode and re-encode
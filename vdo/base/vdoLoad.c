@@ -214,6 +214,10 @@ static void prepareToComeOnline(VDOCompletion *completion)
 {
   VDO               *vdo      = vdoFromLoadSubTask(completion);
   SlabDepotLoadType  loadType = NORMAL_LOAD;
+  if (getConfiguredLazyRefCountLoad(vdo)) {
+    loadType = LAZY_LOAD;
+  }
+
   if (requiresReadOnlyRebuild(vdo)) {
     loadType = NO_LOAD;
   } else if (requiresRecovery(vdo)) {
@@ -240,8 +244,17 @@ static void makeDirty(VDOCompletion *completion)
     return;
   }
 
-  vdo->state = VDO_DIRTY;
   prepareAdminSubTask(vdo, prepareToComeOnline, continueLoadReadOnly);
+  if (vdo->onlineRecovery != NULL) {
+    // The super block must keep saying that the journal is being replayed
+    // until the block map has been recovered, so it will be saved when the
+    // background replay is done.
+    launchOnlineRecovery(vdo);
+    completeCompletion(completion);
+    return;
+  }
+
+  vdo->state = VDO_DIRTY;
   saveVDOComponentsAsync(vdo, completion);
 }
 
@@ -353,6 +366,15 @@ static int decodeVDO(VDO *vdo, bool validateConfig)
     return result;
   }
 
+  result = configureSlabScrubbing(vdo->depot, vdo->layer,
+                                  getConfiguredScrubConcurrency(vdo),
+                                  getConfiguredScrubIOBudget(vdo));
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  setDepotColdSlabCompaction(vdo->depot, getConfiguredCompactColdSlabs(vdo));
+
   result = makeFlusher(vdo);
   if (result != VDO_SUCCESS) {
     return result;
@@ -367,7 +389,8 @@ static int decodeVDO(VDO *vdo, bool validateConfig)
   result = makeBlockMapCaches(vdo->blockMap, vdo->layer,
                               &vdo->readOnlyContext, vdo->recoveryJournal,
                               vdo->nonce, getConfiguredCacheSize(vdo),
-                              maximumAge);
+                              maximumAge, getConfiguredCachePolicy(vdo),
+                              getConfiguredBackgroundWriteback(vdo));
   if (result != VDO_SUCCESS) {
     return result;
   }
@@ -21,6 +21,7 @@
 
 #include "vdoPageCacheInternals.h"
 
+#include "cpu.h"
 #include "errors.h"
 #include "logger.h"
 #include "memoryAlloc.h"
@@ -42,13 +43,113 @@ enum {
 static char *getPageBuffer(PageInfo *info)
 {
   VDOPageCache *cache = info->cache;
-  return &cache->pages[(info - cache->infos) * VDO_BLOCK_SIZE];
+  size_t        index = info - cache->infos;
+  return &cache->pageChunks[index / PAGES_PER_CHUNK]
+    [(index % PAGES_PER_CHUNK) * VDO_BLOCK_SIZE];
+}
+
+/**
+ * Empty the map of pbn to page info.
+ *
+ * @param cache  The cache
+ **/
+static void clearPageMap(VDOPageCache *cache)
+{
+  for (size_t slot = 0; slot <= cache->pageMapMask; slot++) {
+    cache->pageMap[slot] = (PageMapSlot) {
+      .pbn  = NO_PAGE,
+      .info = NULL,
+    };
+  }
+  cache->lastFound = NULL;
+}
+
+/**
+ * Find the slot in which the search for a pbn begins.
+ *
+ * @param cache  The cache
+ * @param pbn    The pbn
+ *
+ * @return The home slot of the pbn
+ **/
+static inline size_t getHomeSlot(VDOPageCache *cache, PhysicalBlockNumber pbn)
+{
+  // Fibonacci hashing spreads the mostly sequential block map pbns.
+  return (size_t) ((pbn * 0x9E3779B97F4A7C15ULL) >> cache->pageMapShift);
+}
+
+/**
+ * Find the slot holding a pbn, or the empty slot which ends its probe
+ * sequence.
+ *
+ * @param cache  The cache
+ * @param pbn    The pbn to find
+ *
+ * @return The slot for the pbn
+ **/
+static inline PageMapSlot *findPageMapSlot(VDOPageCache        *cache,
+                                           PhysicalBlockNumber  pbn)
+{
+  size_t slot = getHomeSlot(cache, pbn);
+  while ((cache->pageMap[slot].pbn != pbn)
+         && (cache->pageMap[slot].pbn != NO_PAGE)) {
+    slot = (slot + 1) & cache->pageMapMask;
+  }
+  return &cache->pageMap[slot];
+}
+
+/**
+ * Remove a pbn from the page map. Later entries in its probe sequence are
+ * shifted back over the hole, so that the map never needs tombstones.
+ *
+ * @param cache  The cache
+ * @param pbn    The pbn to remove
+ **/
+static void removeFromPageMap(VDOPageCache *cache, PhysicalBlockNumber pbn)
+{
+  size_t mask = cache->pageMapMask;
+  size_t hole = findPageMapSlot(cache, pbn) - cache->pageMap;
+  if (cache->pageMap[hole].pbn == NO_PAGE) {
+    return;
+  }
+
+  for (size_t next = (hole + 1) & mask;
+       cache->pageMap[next].pbn != NO_PAGE;
+       next = (next + 1) & mask) {
+    // An entry may fill the hole only if the hole is not before its home.
+    size_t home = getHomeSlot(cache, cache->pageMap[next].pbn);
+    if (((next - home) & mask) >= ((next - hole) & mask)) {
+      cache->pageMap[hole] = cache->pageMap[next];
+      hole = next;
+    }
+  }
+
+  cache->pageMap[hole] = (PageMapSlot) {
+    .pbn  = NO_PAGE,
+    .info = NULL,
+  };
+}
+
+/**
+ * Compare the pbns of two pages in a write batch. Implements HeapComparator.
+ **/
+static int comparePagePBNs(const void *item1, const void *item2)
+{
+  PhysicalBlockNumber pbn1 = (*((PageInfo *const *) item1))->pbn;
+  PhysicalBlockNumber pbn2 = (*((PageInfo *const *) item2))->pbn;
+  if (pbn1 == pbn2) {
+    return 0;
+  }
+  return ((pbn1 < pbn2) ? -1 : 1);
 }
 
 /**
  * Allocate components of the cache which require their own allocation. The
  * caller is responsible for all clean up on errors.
  *
+ * <p>The page memory is allocated in chunks small enough to be physically
+ * contiguous, and on the NUMA node of the cache's thread if it has one.
+ *
  * @param cache     The cache being constructed
  *
  * @return VDO_SUCCESS or an error code
@@ -62,13 +163,63 @@ static int allocateCacheComponents(VDOPageCache *cache)
     return result;
   }
 
-  uint64_t size = cache->pageCount * (uint64_t) VDO_BLOCK_SIZE;
-  result = allocateMemory(size, VDO_BLOCK_SIZE, "cache pages", &cache->pages);
+  cache->chunkCount = computeBucketCount(cache->pageCount, PAGES_PER_CHUNK);
+  result = ALLOCATE(cache->chunkCount, char *, "cache page chunks",
+                    &cache->pageChunks);
   if (result != UDS_SUCCESS) {
     return result;
   }
 
-  return makeIntMap(cache->pageCount, 0, &cache->pageMap);
+  PhysicalLayer *layer = cache->layer;
+  int node = ((layer->getThreadNode != NULL)
+              ? layer->getThreadNode(layer, cache->threadID)
+              : ANY_MEMORY_NODE);
+  for (size_t chunk = 0; chunk < cache->chunkCount; chunk++) {
+    PageCount pages = minPageCount(cache->pageCount - (chunk * PAGES_PER_CHUNK),
+                                   PAGES_PER_CHUNK);
+    result = allocateLargeMemory(pages * (size_t) VDO_BLOCK_SIZE, node,
+                                 "cache pages", &cache->pageChunks[chunk]);
+    if (result != UDS_SUCCESS) {
+      return result;
+    }
+  }
+
+  // A power of two at least twice the page count keeps probes short.
+  unsigned int bits = logBaseTwo(cache->pageCount) + 2;
+  cache->pageMapMask  = (1UL << bits) - 1;
+  cache->pageMapShift = 64 - bits;
+  result = allocateMemory((cache->pageMapMask + 1) * sizeof(PageMapSlot),
+                          CACHE_LINE_BYTES, "page map", &cache->pageMap);
+  if (result != UDS_SUCCESS) {
+    return result;
+  }
+  clearPageMap(cache);
+
+  result = ALLOCATE(cache->pageCount, PageInfo *, "page write batch",
+                    &cache->writeBatch);
+  if (result != UDS_SUCCESS) {
+    return result;
+  }
+  initializeHeap(&cache->writeHeap, comparePagePBNs, cache->writeBatch,
+                 cache->pageCount, sizeof(PageInfo *));
+
+  if (cache->policy != PAGE_CACHE_POLICY_2Q) {
+    return VDO_SUCCESS;
+  }
+
+  cache->ghostCapacity   = maxPageCount(cache->pageCount / 2, 1);
+  cache->probationTarget = maxPageCount(cache->pageCount / 4, 1);
+  result = ALLOCATE(cache->ghostCapacity, PhysicalBlockNumber, "page ghosts",
+                    &cache->ghosts);
+  if (result != UDS_SUCCESS) {
+    return result;
+  }
+
+  for (PageCount i = 0; i < cache->ghostCapacity; i++) {
+    cache->ghosts[i] = NO_PAGE;
+  }
+
+  return makeIntMap(cache->ghostCapacity, 0, &cache->ghostMap);
 }
 
 /**
@@ -122,6 +273,8 @@ int makeVDOPageCache(ThreadID               threadID,
                      void                  *clientContext,
                      size_t                 pageContextSize,
                      BlockCount             maximumAge,
+                     PageCachePolicy        policy,
+                     bool                   background,
                      VDOPageCache         **cachePtr)
 {
   int result = ASSERT(pageContextSize <= MAX_PAGE_CONTEXT_SIZE,
@@ -144,6 +297,9 @@ int makeVDOPageCache(ThreadID               threadID,
   cache->readHook        = readHook;
   cache->writeHook       = writeHook;
   cache->context         = clientContext;
+  cache->policy          = policy;
+  cache->background      = background;
+  cache->maximumAge      = maximumAge;
 
   result = allocateCacheComponents(cache);
   if (result != VDO_SUCCESS) {
@@ -166,6 +322,7 @@ int makeVDOPageCache(ThreadID               threadID,
 
   // initialize empty circular queues
   initializeRing(&cache->lruList);
+  initializeRing(&cache->probationList);
   initializeRing(&cache->outgoingList);
 
   *cachePtr = cache;
@@ -188,9 +345,17 @@ void freeVDOPageCache(VDOPageCache **cachePtr)
   }
 
   freeDirtyLists(&cache->dirtyLists);
-  freeIntMap(&cache->pageMap);
+  FREE(cache->pageMap);
+  FREE(cache->writeBatch);
+  freeIntMap(&cache->ghostMap);
+  FREE(cache->ghosts);
   FREE(cache->infos);
-  FREE(cache->pages);
+  if (cache->pageChunks != NULL) {
+    for (size_t chunk = 0; chunk < cache->chunkCount; chunk++) {
+      freeLargeMemory(cache->pageChunks[chunk]);
+    }
+    FREE(cache->pageChunks);
+  }
   FREE(cache);
   *cachePtr = NULL;
 }
@@ -303,18 +468,137 @@ static void updateCounter(PageInfo *info, int32_t delta)
   }
 }
 
+/**
+ * Remember the pbn of a page evicted from the probation list so that a prompt
+ * re-fetch of it can be recognized. The oldest ghost is forgotten to make
+ * room.
+ *
+ * @param cache  The page cache
+ * @param pbn    The pbn of the evicted page
+ **/
+static void rememberGhost(VDOPageCache *cache, PhysicalBlockNumber pbn)
+{
+  PhysicalBlockNumber *slot = &cache->ghosts[cache->nextGhost];
+  cache->nextGhost = (cache->nextGhost + 1) % cache->ghostCapacity;
+
+  // A ghost which has already been claimed by a re-fetch leaves its slot
+  // empty, and a pbn which has been evicted again maps to a newer slot.
+  if ((*slot != NO_PAGE) && (intMapGet(cache->ghostMap, *slot) == slot)) {
+    intMapRemove(cache->ghostMap, *slot);
+  }
+
+  *slot = pbn;
+  if (intMapPut(cache->ghostMap, pbn, slot, true, NULL) != UDS_SUCCESS) {
+    // Losing a ghost only costs a promotion, so don't fail the eviction.
+    *slot = NO_PAGE;
+  }
+}
+
+/**
+ * Check whether a newly resident page was recently evicted from the
+ * probation list, forgetting the ghost if so.
+ *
+ * @param cache  The page cache
+ * @param pbn    The pbn of the page which has just been fetched
+ *
+ * @return <code>true</code> if the page was a ghost
+ **/
+static bool claimGhost(VDOPageCache *cache, PhysicalBlockNumber pbn)
+{
+  PhysicalBlockNumber *slot = intMapRemove(cache->ghostMap, pbn);
+  if (slot == NULL) {
+    return false;
+  }
+
+  *slot = NO_PAGE;
+  relaxedAdd64(&cache->stats.ghostHits, 1);
+  return true;
+}
+
 /**
  * Update the lru information for an active page.
+ *
+ * <p>Under the 2Q policy a newly fetched page goes on the probation list
+ * unless it is a ghost, in which case it has proven it is part of the working
+ * set and goes straight to the LRU list. Further references to a page on
+ * probation do not move it; they are usually the rest of the block map
+ * entries on the page being visited by the same scan.
  **/
 static void updateLru(PageInfo *info)
 {
   VDOPageCache *cache = info->cache;
 
+  if (isRingEmpty(&info->lruNode) && info->prefetched) {
+    // Nothing has asked for this page yet, so it should be the first to go.
+    PageInfoNode *ring = &cache->lruList;
+    if (cache->policy == PAGE_CACHE_POLICY_2Q) {
+      info->onProbation = true;
+      cache->probationCount++;
+      ring = &cache->probationList;
+    }
+    spliceRingChainAfter(&info->lruNode, &info->lruNode, ring);
+    return;
+  }
+
+  if (isRingEmpty(&info->lruNode)) {
+    if ((cache->policy == PAGE_CACHE_POLICY_2Q)
+        && !claimGhost(cache, info->pbn)) {
+      info->onProbation = true;
+      cache->probationCount++;
+      pushRingNode(&cache->probationList, &info->lruNode);
+      return;
+    }
+  } else if (info->onProbation) {
+    return;
+  }
+
   if (cache->lruList.prev != &info->lruNode) {
     pushRingNode(&cache->lruList, &info->lruNode);
   }
 }
 
+/**
+ * Note the first request for a prefetched page. If the page has already
+ * arrived, it is moved from the head of its list to the tail as though it
+ * had just been fetched.
+ *
+ * @param info  The prefetched page
+ **/
+static void notePrefetchUsed(PageInfo *info)
+{
+  VDOPageCache *cache = info->cache;
+  info->prefetched = false;
+  relaxedAdd64(&cache->stats.prefetchUsed, 1);
+  if (!isRingEmpty(&info->lruNode)) {
+    pushRingNode((info->onProbation ? &cache->probationList : &cache->lruList),
+                 &info->lruNode);
+  }
+}
+
+/**
+ * Take a page which is being evicted off of the replacement lists.
+ *
+ * @param info  The page being evicted
+ **/
+static void removeFromLru(PageInfo *info)
+{
+  bool wasted = info->prefetched;
+  if (wasted) {
+    info->prefetched = false;
+    relaxedAdd64(&info->cache->stats.prefetchWasted, 1);
+  }
+
+  if (info->onProbation) {
+    info->onProbation = false;
+    info->cache->probationCount--;
+    if (!wasted) {
+      rememberGhost(info->cache, info->pbn);
+    }
+  }
+
+  unspliceRingNode(&info->lruNode);
+}
+
 /**
  * Set the state of a PageInfo and put it on the right list, adjusting
  * counters.
@@ -369,16 +653,17 @@ static int setInfoPBN(PageInfo *info, PhysicalBlockNumber pbn)
   }
 
   if (info->pbn != NO_PAGE) {
-    intMapRemove(cache->pageMap, info->pbn);
+    removeFromPageMap(cache, info->pbn);
   }
 
   info->pbn = pbn;
 
   if (pbn != NO_PAGE) {
-    result = intMapPut(cache->pageMap, pbn, info, true, NULL);
-    if (result != UDS_SUCCESS) {
-      return result;
-    }
+    // The map has room for every page, so an insert can't fail.
+    *findPageMapSlot(cache, pbn) = (PageMapSlot) {
+      .pbn  = pbn,
+      .info = info,
+    };
   }
   return VDO_SUCCESS;
 }
@@ -399,9 +684,9 @@ static int resetPageInfo(PageInfo *info)
     return result;
   }
 
+  removeFromLru(info);
   result = setInfoPBN(info, NO_PAGE);
   setInfoState(info, PS_FREE);
-  unspliceRingNode(&info->lruNode);
   return result;
 }
 
@@ -430,12 +715,47 @@ PageInfo *vpcFindPage(VDOPageCache *cache, PhysicalBlockNumber pbn)
       && (cache->lastFound->pbn == pbn)) {
     return cache->lastFound;
   }
-  cache->lastFound = intMapGet(cache->pageMap, pbn);
-  return cache->lastFound;
+  PageInfo *info = findPageMapSlot(cache, pbn)->info;
+  if (info != NULL) {
+    cache->lastFound = info;
+  }
+  return info;
 }
 
 /**
- * Determine which page is least recently used.
+ * Find the oldest page on a replacement list which can be discarded.
+ *
+ * @param ring  the LRU or probation list
+ *
+ * @return the info for the oldest idle page, or NULL if every page on the
+ *         list is busy or in flight
+ *
+ * @note Busy and in-flight pages passed over are rotated to the tail of the
+ *       list, so that later selections do not have to walk over them again
+ *       while they remain unavailable.
+ **/
+__attribute__((warn_unused_result))
+static PageInfo *selectIdlePage(PageInfoNode *ring)
+{
+  PageInfoNode *last = ring->prev;
+  while (!isRingEmpty(ring)) {
+    PageInfoNode *node = ring->next;
+    PageInfo     *info = pageInfoFromLRUNode(node);
+    if ((info->busy == 0) && !isInFlight(info)) {
+      return info;
+    }
+
+    pushRingNode(ring, node);
+    if (node == last) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * Determine which page should be evicted next.
  *
  * @param cache         the page cache structure
  *
@@ -443,25 +763,27 @@ PageInfo *vpcFindPage(VDOPageCache *cache, PhysicalBlockNumber pbn)
  *         or NULL if no such page can be found. The page can be
  *         dirty or resident.
  *
- * @note Picks the least recently used from among the non-busy entries
- *       at the front of each of the lru ring.
- *       Since whenever we mark a page busy we also put it to the end
- *       of the ring it is unlikely that the entries at the front
- *       are busy unless the queue is very short, but not impossible.
+ * @note Under 2Q, victims come from the probation list while it is longer
+ *       than its target, so that a scan evicts its own pages rather than
+ *       the working set on the LRU list.
  **/
 __attribute__((warn_unused_result))
 static PageInfo *selectLRUPage(VDOPageCache *cache)
 {
-  for (PageInfoNode *lru = cache->lruList.next;
-       lru != &cache->lruList;
-       lru = lru->next) {
-    PageInfo *info = pageInfoFromLRUNode(lru);
-    if ((info->busy == 0) && !isInFlight(info)) {
-      return info;
-    }
+  PageInfo *info = NULL;
+  if (cache->probationCount > cache->probationTarget) {
+    info = selectIdlePage(&cache->probationList);
   }
 
-  return NULL;
+  if (info == NULL) {
+    info = selectIdlePage(&cache->lruList);
+  }
+
+  if (info == NULL) {
+    info = selectIdlePage(&cache->probationList);
+  }
+
+  return info;
 }
 
 /**********************************************************************/
@@ -831,6 +1153,9 @@ static void savePages(VDOPageCache *cache)
   cache->pagesInFlush = cache->pagesToFlush;
   cache->pagesToFlush = 0;
   relaxedAdd64(&cache->stats.flushCount, 1);
+  if (cache->pagesInFlush > relaxedLoad64(&cache->stats.largestWriteBatch)) {
+    relaxedStore64(&cache->stats.largestWriteBatch, cache->pagesInFlush);
+  }
 
   VIO           *vio   = info->vio;
   PhysicalLayer *layer = vio->completion.layer;
@@ -870,6 +1195,66 @@ static void writeDirtyPagesCallback(RingNode *expired, void *context)
   savePages((VDOPageCache *) context);
 }
 
+/**
+ * Compute how many page writes background writeback may have in flight. The
+ * limit rises with the fraction of the cache which is dirty, or with the age
+ * of the oldest dirty pages relative to the age at which they would expire
+ * and be written in a burst, whichever is greater.
+ *
+ * @param cache  The cache
+ *
+ * @return The number of writes which may be in flight
+ **/
+static PageCount computeWritebackLimit(VDOPageCache *cache)
+{
+  uint64_t dirtyPages = relaxedLoad64(&cache->stats.counts.dirtyPages);
+  uint64_t pressure   = (dirtyPages * 100) / cache->pageCount;
+  uint64_t agePressure
+    = (getOldestDirtyAge(cache->dirtyLists) * 100) / cache->maximumAge;
+  if (agePressure > pressure) {
+    pressure = agePressure;
+  }
+
+  if (pressure < WRITEBACK_THRESHOLD) {
+    return 0;
+  }
+
+  PageCount limit = 1 + (((MAXIMUM_WRITEBACK - 1)
+                          * (pressure - WRITEBACK_THRESHOLD))
+                         / (100 - WRITEBACK_THRESHOLD));
+  return minPageCount(minPageCount(limit, MAXIMUM_WRITEBACK),
+                      maxPageCount(cache->pageCount / 8, 1));
+}
+
+/**
+ * Write out some of the oldest dirty pages if background writeback is
+ * enabled and there is room under the current writeback limit. Pages are
+ * only started when no flush is in progress, so each flush covers a batch.
+ * Pages dirtied in the current period are left for later, so a hot page is
+ * not rewritten every time it is modified.
+ *
+ * @param cache  The cache
+ **/
+static void writeBackDirtyPages(VDOPageCache *cache)
+{
+  if (!cache->background || cache->rebuilding
+      || (cache->flushCompletion != NULL) || (cache->pagesInFlush > 0)
+      || isReadOnly(cache->readOnlyContext)) {
+    return;
+  }
+
+  PageCount limit = computeWritebackLimit(cache);
+  relaxedStore64(&cache->stats.writebackLimit, limit);
+  if (cache->outstandingWrites >= limit) {
+    return;
+  }
+
+  BlockCount expired
+    = expireOldestElements(cache->dirtyLists,
+                           limit - cache->outstandingWrites);
+  relaxedAdd64(&cache->stats.writebackPages, expired);
+}
+
 /**
  * Add a page to outgoing pages waiting to be saved, and then start saving
  * pages if another save is not in progress.
@@ -1006,6 +1391,7 @@ void advanceVDOPageCachePeriod(VDOPageCache *cache, SequenceNumber period)
 {
   assertOnCacheThread(cache, __func__);
   advancePeriod(cache->dirtyLists, period);
+  writeBackDirtyPages(cache);
 }
 
 /**
@@ -1091,6 +1477,7 @@ static void pageIsWrittenOut(VDOCompletion *completion)
     allocateFreePage(info);
   }
 
+  writeBackDirtyPages(cache);
   checkForIOComplete(cache);
 }
 
@@ -1103,9 +1490,20 @@ static void pageIsWrittenOut(VDOCompletion *completion)
 static void writePages(VDOCompletion *flushCompletion)
 {
   VDOPageCache *cache = ((PageInfo *) flushCompletion->parent)->cache;
-  while (cache->pagesInFlush > 0) {
+
+  // Issue the batch in pbn order so that writes of adjacent pages can be
+  // merged into larger I/Os.
+  PageCount count = cache->pagesInFlush;
+  for (PageCount i = 0; i < count; i++) {
+    cache->writeBatch[i]
+      = pageInfoFromListNode(chopRingNode(&cache->outgoingList));
+  }
+  buildHeap(&cache->writeHeap, count);
+  sortHeap(&cache->writeHeap);
+
+  for (PageCount i = 0; i < count; i++) {
     cache->pagesInFlush--;
-    PageInfo *info = pageInfoFromListNode(chopRingNode(&cache->outgoingList));
+    PageInfo *info = cache->writeBatch[i];
     if (isReadOnly(info->cache->readOnlyContext)) {
       VDOCompletion *completion = &info->vio->completion;
       resetCompletion(completion);
@@ -1200,6 +1598,10 @@ void getVDOPageAsync(VDOCompletion *completion)
   PageInfo *info = vpcFindPage(cache, vdoPageComp->pbn);
   if (info != NULL) {
     // The page is in the cache already.
+    if (info->prefetched) {
+      notePrefetchUsed(info);
+    }
+
     if ((info->writeStatus == WRITE_STATUS_DEFERRED) || isIncoming(info)
         || (isOutgoing(info) && vdoPageComp->writable)) {
       // The page is unusable until it has finished I/O.
@@ -1240,6 +1642,38 @@ void getVDOPageAsync(VDOCompletion *completion)
   discardPageForCompletion(vdoPageComp);
 }
 
+/**********************************************************************/
+bool prefetchVDOPage(VDOPageCache *cache, PhysicalBlockNumber pbn)
+{
+  assertOnCacheThread(cache, __func__);
+  if (vpcFindPage(cache, pbn) != NULL) {
+    return true;
+  }
+
+  if (cache->rebuilding || isReadOnly(cache->readOnlyContext)
+      || hasWaiters(&cache->freeWaiters)) {
+    return false;
+  }
+
+  PageInfo *info = findFreePage(cache);
+  if (info == NULL) {
+    return false;
+  }
+
+  info->prefetched = true;
+  if (launchPageLoad(info, pbn) != VDO_SUCCESS) {
+    // The load never started, so the page is still free, but it may already
+    // be in the page map.
+    info->prefetched = false;
+    setInfoPBN(info, NO_PAGE);
+    pushRingNode(&cache->freeList, &info->listNode);
+    return false;
+  }
+
+  relaxedAdd64(&cache->stats.prefetchIssued, 1);
+  return true;
+}
+
 /**********************************************************************/
 void markCompletedVDOPageDirty(VDOCompletion  *completion,
                                SequenceNumber  oldDirtyPeriod,
@@ -1254,6 +1688,7 @@ void markCompletedVDOPageDirty(VDOCompletion  *completion,
   setInfoState(info, PS_DIRTY);
   addToDirtyLists(info->cache->dirtyLists, &info->listNode, oldDirtyPeriod,
                   newDirtyPeriod);
+  writeBackDirtyPages(info->cache);
 }
 
 /**********************************************************************/
@@ -1331,15 +1766,39 @@ int invalidateVDOPageCache(VDOPageCache *cache)
   for (PageInfo *info = cache->infos;
        info < cache->infos + cache->pageCount;
        info++) {
-    int result = ASSERT(!isDirty(info), "cache must have no dirty pages");
+    int result = ASSERT(!isDirty(info) && !isInFlight(info),
+                        "cache must have no dirty or in-flight pages");
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+  }
+
+  // Free every cached page, so that no stale copy can be found later and
+  // no stale page can remove a newer mapping of its pbn from the map.
+  for (PageInfo *info = cache->infos;
+       info < cache->infos + cache->pageCount;
+       info++) {
+    if (isFree(info)) {
+      continue;
+    }
+
+    int result = resetPageInfo(info);
     if (result != VDO_SUCCESS) {
       return result;
     }
   }
 
-  // Reset the pageMap by re-allocating it.
-  freeIntMap(&cache->pageMap);
-  return makeIntMap(cache->pageCount, 0, &cache->pageMap);
+  clearPageMap(cache);
+  if (cache->ghostMap == NULL) {
+    return VDO_SUCCESS;
+  }
+
+  // Forget any ghosts, since their pbns may no longer be block map pages.
+  for (PageCount i = 0; i < cache->ghostCapacity; i++) {
+    cache->ghosts[i] = NO_PAGE;
+  }
+  freeIntMap(&cache->ghostMap);
+  return makeIntMap(cache->ghostCapacity, 0, &cache->ghostMap);
 }
 
 /**********************************************************************/
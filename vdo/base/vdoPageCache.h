@@ -83,6 +83,14 @@ typedef struct {
   Atomic64              readOutgoing;
   /* number of gets that were already there */
   Atomic64              foundInCache;
+  /* number of fetched pages which had recently been evicted from probation */
+  Atomic64              ghostHits;
+  /* number of page loads started by prefetchVDOPage() */
+  Atomic64              prefetchIssued;
+  /* number of prefetched pages which were later requested */
+  Atomic64              prefetchUsed;
+  /* number of prefetched pages discarded without being requested */
+  Atomic64              prefetchWasted;
   /* number of gets requiring discard */
   Atomic64              discardRequired;
   /* number of gets enqueued for their page */
@@ -95,6 +103,12 @@ typedef struct {
   Atomic64              pagesSaved;
   /* number of flushes initiated */
   Atomic64              flushCount;
+  /* number of pages written early by background writeback */
+  Atomic64              writebackPages;
+  /* the current limit on background writes in flight */
+  Atomic64              writebackLimit;
+  /* the most pages written in a single batch */
+  Atomic64              largestWriteBatch;
 } AtomicPageCacheStatistics;
 
 /**
@@ -147,6 +161,9 @@ typedef bool VDOPageWriteFunction(void *rawPage,
  *                               be passed to the read and write hooks
  * @param [in]  maximumAge       The number of journal blocks before a dirtied
  *                               page is considered old and must be written out
+ * @param [in]  policy           The replacement policy for the cache
+ * @param [in]  background       Whether to write dirty pages out gradually
+ *                               rather than only when they expire
  * @param [out] cachePtr         A pointer to hold the cache
  *
  * @return a success or error code
@@ -160,6 +177,8 @@ int makeVDOPageCache(ThreadID               threadID,
                      void                  *clientContext,
                      size_t                 pageContextSize,
                      BlockCount             maximumAge,
+                     PageCachePolicy        policy,
+                     bool                   background,
                      VDOPageCache         **cachePtr)
   __attribute__((warn_unused_result));
 
@@ -293,6 +312,20 @@ void releaseVDOPageCompletion(VDOCompletion *completion);
  **/
 void getVDOPageAsync(VDOCompletion *completion);
 
+/**
+ * Start loading a page into a free cache slot ahead of any request for it.
+ * A prefetched page which is never requested is the first page discarded.
+ * Nothing is done if the page is already cached, if there is no free slot,
+ * or if requests are already waiting for free slots.
+ *
+ * @param cache  the page cache
+ * @param pbn    the absolute pbn of the page to prefetch
+ *
+ * @return <code>true</code> if the page is cached or is now being loaded,
+ *         <code>false</code> if the cache could not take it
+ **/
+bool prefetchVDOPage(VDOPageCache *cache, PhysicalBlockNumber pbn);
+
 /**
  * Mark a VDO page referenced by a completed VDOPageCompletion as dirty.
  *
@@ -30,6 +30,7 @@
 
 #include "completion.h"
 #include "dirtyLists.h"
+#include "heap.h"
 #include "intMap.h"
 #include "physicalLayer.h"
 #include "readOnlyModeContext.h"
@@ -39,6 +40,12 @@
 
 enum {
   MAX_PAGE_CONTEXT_SIZE = 8,
+  /** The number of cache pages in each separately allocated chunk (2 MB) */
+  PAGES_PER_CHUNK       = 512,
+  /** The dirty percentage at which background writeback begins */
+  WRITEBACK_THRESHOLD   = 25,
+  /** The most background writes in flight, at full pressure */
+  MAXIMUM_WRITEBACK     = 64,
 };
 
 static const PhysicalBlockNumber NO_PAGE = 0xFFFFFFFFFFFFFFFF;
@@ -48,6 +55,17 @@ static const PhysicalBlockNumber NO_PAGE = 0xFFFFFFFFFFFFFFFF;
  **/
 typedef RingNode PageInfoNode;
 
+/**
+ * A slot in the page cache's open-addressed map of pbn to page info. Several
+ * slots share a cache line, so a lookup rarely touches more than one.
+ **/
+typedef struct {
+  /** the pbn of the page, or NO_PAGE if the slot is empty */
+  PhysicalBlockNumber  pbn;
+  /** the info for the page */
+  PageInfo            *info;
+} PageMapSlot;
+
 /**
  * The VDO Page Cache abstraction.
  **/
@@ -70,19 +88,45 @@ struct vdoPageCache {
   PageCount                  pagesInBatch;
   /** Whether the VDO is doing a read-only rebuild */
   bool                       rebuilding;
+  /** the replacement policy */
+  PageCachePolicy            policy;
+  /** whether dirty pages are written out gradually ahead of expiration */
+  bool                       background;
 
   /** array of page information entries */
   PageInfo                  *infos;
-  /** raw memory for pages */
-  char                      *pages;
+  /** raw memory for pages, in chunks of PAGES_PER_CHUNK pages */
+  char                     **pageChunks;
+  /** the number of page chunks */
+  size_t                     chunkCount;
   /** cache last found page info */
   PageInfo                  *lastFound;
-  /** map of page number to info */
-  IntMap                    *pageMap;
-  /** master LRU list (all infos) */
+  /** map of page number to info, sized to stay at most half full */
+  PageMapSlot               *pageMap;
+  /** the number of slots in the page map, less one */
+  size_t                     pageMapMask;
+  /** the right shift which turns a pbn hash into a page map slot */
+  unsigned int               pageMapShift;
+  /** LRU list of resident pages (the protected queue under 2Q) */
   PageInfoNode               lruList;
+  /** FIFO of pages which have been admitted but not re-fetched (2Q only) */
+  PageInfoNode               probationList;
+  /** number of pages on the probation list */
+  PageCount                  probationCount;
+  /** probation list length above which victims come from probation */
+  PageCount                  probationTarget;
+  /** ring buffer of the pbns most recently evicted from probation */
+  PhysicalBlockNumber       *ghosts;
+  /** number of slots in the ghost ring buffer */
+  PageCount                  ghostCapacity;
+  /** the next ghost slot to overwrite */
+  PageCount                  nextGhost;
+  /** map of ghost pbn to its slot in the ghost ring buffer */
+  IntMap                    *ghostMap;
   /** dirty pages by period */
   DirtyLists                *dirtyLists;
+  /** the number of periods after which a dirty page must be written */
+  BlockCount                 maximumAge;
   /** free page list (oldest first) */
   PageInfoNode               freeList;
   /** outgoing page list */
@@ -95,6 +139,10 @@ struct vdoPageCache {
   PageCount                  pagesInFlush;
   /** number of pages waiting to be included in the next flush */
   PageCount                  pagesToFlush;
+  /** scratch space for sorting a batch of pages by pbn */
+  PageInfo                 **writeBatch;
+  /** heap used to sort the write batch */
+  Heap                       writeHeap;
   /** number of discards in progress */
   unsigned int               discardCount;
   /** how many VPCs waiting for free page */
@@ -161,11 +209,15 @@ struct pageInfo {
   WriteStatus          writeStatus;
   /** page state */
   PageState            state;
+  /** whether the LRU node is on the probation list rather than the LRU */
+  bool                 onProbation;
+  /** whether the page was prefetched and has not yet been requested */
+  bool                 prefetched;
   /** queue of completions awaiting this item */
   WaitQueue            waiting;
   /** state linked list node */
   PageInfoNode         listNode;
-  /** LRU node */
+  /** LRU or probation list node */
   PageInfoNode         lruNode;
   /** Space for per-page client data */
   byte                 context[MAX_PAGE_CONTEXT_SIZE];
@@ -23,7 +23,9 @@
 
 #include "logger.h"
 #include "memoryAlloc.h"
+#include "timeUtils.h"
 
+#include "blockAllocatorInternals.h"
 #include "blockMapInternals.h"
 #include "blockMapPage.h"
 #include "blockMapRecovery.h"
@@ -33,9 +35,12 @@
 #include "recoveryJournal.h"
 #include "recoveryUtils.h"
 #include "ringNode.h"
+#include "slab.h"
 #include "slabDepot.h"
 #include "slabJournal.h"
+#include "threadData.h"
 #include "vdoInternal.h"
+#include "vdoPageCache.h"
 
 enum {
   // The int map needs capacity of twice the number of VIOs in the system.
@@ -57,6 +62,30 @@ typedef struct missingDecref {
   VDOPageCompletion   pageCompletion;
 } MissingDecref;
 
+/**
+ * The state of a recovery whose block map replay is being completed in the
+ * background after the VDO has come online. Until the replay is done, pages
+ * have their journal entries applied as they are loaded, and new journal
+ * entries are held, since the journal can not be restarted until the old
+ * journal is no longer needed to recover the block map.
+ **/
+struct onlineRecovery {
+  /** The completion for the background replay */
+  VDOCompletion   completion;
+  /** The VDO being recovered */
+  VDO            *vdo;
+  /** The staged block map replay */
+  BlockMapReplay *replay;
+  /** The highest sequence number of the recovered journal */
+  SequenceNumber  highestTail;
+  /** Whether the background replay has been launched */
+  bool            launched;
+  /** Whether the super block is being saved */
+  bool            savingSuperBlock;
+  /** A completion waiting for the recovery to finish, if any */
+  VDOCompletion  *waiter;
+};
+
 /**
  * Convert a RingNode to the missing decref of which it is a part.
  *
@@ -109,6 +138,21 @@ static void freeMissingDecref(MissingDecref **decrefPtr)
   *decrefPtr = NULL;
 }
 
+/**
+ * Convert a generic completion to a SlabReplayZone.
+ *
+ * @param completion  The completion to convert
+ *
+ * @return The SlabReplayZone
+ **/
+__attribute__((warn_unused_result))
+static inline SlabReplayZone *asSlabReplayZone(VDOCompletion *completion)
+{
+  STATIC_ASSERT(offsetof(SlabReplayZone, completion) == 0);
+  assertCompletionType(completion->type, SUB_TASK_COMPLETION);
+  return (SlabReplayZone *) completion;
+}
+
 /**
  * Convert a BlockMapSlot into a unique uint64_t.
  *
@@ -232,6 +276,60 @@ int makeRecoveryCompletion(VDO *vdo, RecoveryCompletion **recoveryPtr)
   return VDO_SUCCESS;
 }
 
+/**
+ * Free the per-zone slab journal replays of a recovery.
+ *
+ * @param recovery  The recovery completion
+ **/
+static void freeReplayZones(RecoveryCompletion *recovery)
+{
+  if (recovery->replayZones == NULL) {
+    return;
+  }
+
+  for (ZoneCount zone = 0; zone < recovery->replayZoneCount; zone++) {
+    destroyEnqueueable(&recovery->replayZones[zone].completion);
+  }
+
+  FREE(recovery->replayZones);
+  recovery->replayZones     = NULL;
+  recovery->replayZoneCount = 0;
+  FREE(recovery->slabReplayEntries);
+  recovery->slabReplayEntries = NULL;
+}
+
+/**
+ * Make a slab journal replay for each physical zone.
+ *
+ * @param recovery  The recovery completion
+ *
+ * @return VDO_SUCCESS or an error code
+ **/
+static int makeReplayZones(RecoveryCompletion *recovery)
+{
+  VDO       *vdo       = recovery->vdo;
+  ZoneCount  zoneCount = getThreadConfig(vdo)->physicalZoneCount;
+  int result = ALLOCATE(zoneCount, SlabReplayZone, __func__,
+                        &recovery->replayZones);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  for (ZoneCount zone = 0; zone < zoneCount; zone++) {
+    SlabReplayZone *replayZone = &recovery->replayZones[zone];
+    result = initializeEnqueueableCompletion(&replayZone->completion,
+                                             SUB_TASK_COMPLETION, vdo->layer);
+    if (result != VDO_SUCCESS) {
+      return result;
+    }
+
+    recovery->replayZoneCount++;
+    replayZone->zoneNumber = zone;
+  }
+
+  return VDO_SUCCESS;
+}
+
 /**********************************************************************/
 void freeRecoveryCompletion(RecoveryCompletion **recoveryPtr)
 {
@@ -251,6 +349,7 @@ void freeRecoveryCompletion(RecoveryCompletion **recoveryPtr)
     freeMissingDecref(&currentDecref);
   }
 
+  freeReplayZones(recovery);
   freeIntMap(&recovery->slotEntryMap);
   FREE(recovery->journalData);
   FREE(recovery->entries);
@@ -267,12 +366,14 @@ void freeRecoveryCompletion(RecoveryCompletion **recoveryPtr)
  **/
 static void finishRecovery(VDOCompletion *completion)
 {
-  VDOCompletion      *parent        = completion->parent;
-  RecoveryCompletion *recovery      = asRecoveryCompletion(completion);
-  VDO                *vdo           = recovery->vdo;
-  uint64_t            recoveryCount = ++vdo->completeRecoveries;
-  initializeRecoveryJournalPostRecovery(vdo->recoveryJournal,
-                                        recoveryCount, recovery->highestTail);
+  VDOCompletion      *parent   = completion->parent;
+  RecoveryCompletion *recovery = asRecoveryCompletion(completion);
+  VDO                *vdo      = recovery->vdo;
+  if (vdo->onlineRecovery == NULL) {
+    uint64_t recoveryCount = ++vdo->completeRecoveries;
+    initializeRecoveryJournalPostRecovery(vdo->recoveryJournal, recoveryCount,
+                                          recovery->highestTail);
+  }
   freeRecoveryCompletion(&recovery);
   logInfo("Rebuild complete.");
 
@@ -389,6 +490,234 @@ static int extractJournalEntries(RecoveryCompletion *recovery)
   return result;
 }
 
+/**
+ * Convert a VDOCompletion to an OnlineRecovery.
+ *
+ * @param completion  The completion to convert
+ *
+ * @return The completion as an OnlineRecovery
+ **/
+__attribute__((warn_unused_result))
+static inline OnlineRecovery *asOnlineRecovery(VDOCompletion *completion)
+{
+  STATIC_ASSERT(offsetof(OnlineRecovery, completion) == 0);
+  assertCompletionType(completion->type, ONLINE_RECOVERY_COMPLETION);
+  return (OnlineRecovery *) completion;
+}
+
+/**********************************************************************/
+void freeOnlineRecovery(OnlineRecovery **onlineRecoveryPtr)
+{
+  OnlineRecovery *online = *onlineRecoveryPtr;
+  if (online == NULL) {
+    return;
+  }
+
+  freeBlockMapReplay(&online->replay);
+  destroyEnqueueable(&online->completion);
+  FREE(online);
+  *onlineRecoveryPtr = NULL;
+}
+
+/**
+ * Stage the block map replay of a recovery to be completed once the VDO is
+ * online, and hold any new journal entries until it has been.
+ *
+ * @param recovery  The recovery whose journal entries have been extracted
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+static int stageOnlineRecovery(RecoveryCompletion *recovery)
+{
+  VDO            *vdo = recovery->vdo;
+  OnlineRecovery *online;
+  int result = ALLOCATE(1, OnlineRecovery, __func__, &online);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  online->vdo         = vdo;
+  online->highestTail = recovery->highestTail;
+  result = initializeEnqueueableCompletion(&online->completion,
+                                           ONLINE_RECOVERY_COMPLETION,
+                                           vdo->layer);
+  if (result != VDO_SUCCESS) {
+    freeOnlineRecovery(&online);
+    return result;
+  }
+
+  result = stageBlockMapRecovery(vdo, recovery->entryCount, recovery->entries,
+                                 &online->replay);
+  if (result != VDO_SUCCESS) {
+    freeOnlineRecovery(&online);
+    return result;
+  }
+
+  // The replay now owns the journal entries.
+  recovery->entries = NULL;
+  holdRecoveryJournalEntries(vdo->recoveryJournal);
+  vdo->onlineRecovery = online;
+  return VDO_SUCCESS;
+}
+
+/**
+ * Free an online recovery which has finished and notify anything waiting for
+ * it. This callback is registered in releaseHeldWrites().
+ *
+ * @param completion  The OnlineRecovery
+ **/
+static void finishOnlineRecovery(VDOCompletion *completion)
+{
+  OnlineRecovery *online = asOnlineRecovery(completion);
+  VDO            *vdo    = online->vdo;
+  assertOnAdminThread(vdo, __func__);
+
+  if (online->savingSuperBlock) {
+    finishSuperBlockWrite(vdo);
+  }
+
+  logInfo("Online recovery complete");
+  VDOCompletion *waiter = online->waiter;
+  vdo->onlineRecovery   = NULL;
+  freeOnlineRecovery(&online);
+  if (waiter != NULL) {
+    completeCompletion(waiter);
+  }
+}
+
+/**
+ * Let held writes into the VDO now that the super block no longer requires
+ * the old journal to be replayed.
+ *
+ * @param completion  The OnlineRecovery
+ **/
+static void releaseHeldWrites(VDOCompletion *completion)
+{
+  VDO *vdo = asOnlineRecovery(completion)->vdo;
+  releaseRecoveryJournalEntries(vdo->recoveryJournal);
+  vdo->layer->releaseHeldWrites(vdo->layer);
+  launchCallback(completion, finishOnlineRecovery,
+                 getAdminThread(getThreadConfig(vdo)));
+}
+
+/**
+ * Handle an error saving the super block after the block map was recovered.
+ * This error handler is registered in saveRecoveredState().
+ *
+ * @param completion  The OnlineRecovery
+ **/
+static void handleRecoveredStateSaveError(VDOCompletion *completion)
+{
+  VDO *vdo = asOnlineRecovery(completion)->vdo;
+  logErrorWithStringError(completion->result,
+                          "Failed to save super block after online recovery");
+  enterReadOnlyMode(&vdo->readOnlyContext, completion->result);
+  resetCompletion(completion);
+  releaseHeldWrites(completion);
+}
+
+/**
+ * Mark the VDO dirty on disk now that the block map has been recovered. This
+ * callback is registered in finishOnlineReplay().
+ *
+ * @param completion  The OnlineRecovery
+ **/
+static void saveRecoveredState(VDOCompletion *completion)
+{
+  OnlineRecovery     *online       = asOnlineRecovery(completion);
+  VDO                *vdo          = online->vdo;
+  const ThreadConfig *threadConfig = getThreadConfig(vdo);
+  assertOnAdminThread(vdo, __func__);
+
+  if ((vdo->state == VDO_READ_ONLY_MODE)
+      || isReadOnly(&vdo->readOnlyContext)) {
+    launchCallback(completion, releaseHeldWrites,
+                   getJournalZoneThread(threadConfig));
+    return;
+  }
+
+  online->savingSuperBlock = true;
+  beginSuperBlockWrite(vdo);
+  prepareCompletion(completion, releaseHeldWrites,
+                    handleRecoveredStateSaveError,
+                    getJournalZoneThread(threadConfig), NULL);
+
+  // The super block must no longer say that the journal is being replayed,
+  // but slab scrubbing may still have the VDO in recovery mode, which is
+  // never saved, so record the VDO as dirty without leaving recovery mode.
+  if (vdo->state != VDO_RECOVERING) {
+    vdo->state = VDO_DIRTY;
+  }
+  saveVDOComponentsInStateAsync(vdo, VDO_DIRTY, completion);
+}
+
+/**
+ * Restart the recovery journal now that the block map has been recovered in
+ * the background. This callback is registered in launchOnlineRecovery().
+ *
+ * @param completion  The OnlineRecovery
+ **/
+static void finishOnlineReplay(VDOCompletion *completion)
+{
+  OnlineRecovery *online = asOnlineRecovery(completion);
+  VDO            *vdo    = online->vdo;
+
+  // The replay frees itself when it finishes.
+  online->replay = NULL;
+  if (completion->result != VDO_SUCCESS) {
+    enterReadOnlyMode(&vdo->readOnlyContext, completion->result);
+    resetCompletion(completion);
+    releaseHeldWrites(completion);
+    return;
+  }
+
+  uint64_t recoveryCount = ++vdo->completeRecoveries;
+  initializeRecoveryJournalPostRecovery(vdo->recoveryJournal, recoveryCount,
+                                        online->highestTail);
+  // Until held writes are released, nothing but loads touches the block map.
+  initializeBlockMapFromJournal(vdo->blockMap, vdo->recoveryJournal);
+  launchCallback(completion, saveRecoveredState,
+                 getAdminThread(getThreadConfig(vdo)));
+}
+
+/**********************************************************************/
+void launchOnlineRecovery(VDO *vdo)
+{
+  assertOnAdminThread(vdo, __func__);
+  OnlineRecovery *online = vdo->onlineRecovery;
+  if ((online == NULL) || online->launched) {
+    return;
+  }
+
+  online->launched = true;
+  prepareCompletion(&online->completion, finishOnlineReplay,
+                    finishOnlineReplay,
+                    getJournalZoneThread(getThreadConfig(vdo)), NULL);
+  replayStagedBlockMap(online->replay, &online->completion);
+}
+
+/**********************************************************************/
+bool isRecoveringOnline(const VDO *vdo)
+{
+  return ((vdo->onlineRecovery != NULL) && vdo->onlineRecovery->launched);
+}
+
+/**********************************************************************/
+void waitForOnlineRecovery(VDO *vdo, VDOCompletion *parent)
+{
+  assertOnAdminThread(vdo, __func__);
+  if (!isRecoveringOnline(vdo)) {
+    // A replay which was never launched will never finish.
+    completeCompletion(parent);
+    return;
+  }
+
+  OnlineRecovery *online = vdo->onlineRecovery;
+  ASSERT_LOG_ONLY((online->waiter == NULL),
+                  "only one completion waits for online recovery");
+  online->waiter = parent;
+}
+
 /**
  * Extract journal entries and recover the block map. This callback is
  * registered in startSuperBlockSave().
@@ -407,6 +736,27 @@ static void launchBlockMapRecovery(VDOCompletion *completion)
     return;
   }
 
+  // Decref synthesis read block map pages through zone 0's cache. The replay
+  // assigns pages to zones by PBN, and a staged replay only applies entries
+  // to pages as they are loaded, so no cache may keep a pre-replay copy of a
+  // page. Only zone 0's cache has been used since the VDO was loaded.
+  result = invalidateVDOPageCache(getBlockMapZone(getBlockMap(vdo),
+                                                  0)->pageCache);
+  if (abortRecoveryOnError(result, recovery)) {
+    return;
+  }
+
+  if (getConfiguredOnlineRecovery(vdo) && (recovery->entryCount > 0)) {
+    result = stageOnlineRecovery(recovery);
+    if (abortRecoveryOnError(result, recovery)) {
+      return;
+    }
+
+    logInfo("Deferring block map replay until the device is online");
+    finishCompletion(&recovery->completion, VDO_SUCCESS);
+    return;
+  }
+
   prepareToFinishParent(completion, &recovery->completion);
   recoverBlockMap(vdo, recovery->entryCount, recovery->entries, completion);
 }
@@ -763,59 +1113,212 @@ static int findMissingDecrefs(RecoveryCompletion *recovery)
   return VDO_SUCCESS;
 }
 
-/**********************************************************************/
-void addSlabJournalEntries(VDOCompletion *completion)
+/**
+ * Gather the results of the per-zone slab journal replays and, if they all
+ * succeeded, go on to find the missing decrefs. This callback is launched by
+ * the last zone to finish in finishZoneReplay().
+ *
+ * @param completion  The sub-task completion
+ **/
+static void finishSlabJournalReplay(VDOCompletion *completion)
 {
   RecoveryCompletion *recovery = asRecoveryCompletion(completion->parent);
   VDO                *vdo      = recovery->vdo;
-  RecoveryJournal    *journal  = vdo->recoveryJournal;
   // We want to be on the logical thread so that findPBNsFromBlockMap() later
   // is on the right thread.
   assertOnLogicalZoneThread(vdo, 0, __func__);
 
+  int result = VDO_SUCCESS;
+  for (ZoneCount zone = 0; zone < recovery->replayZoneCount; zone++) {
+    SlabReplayZone *replayZone = &recovery->replayZones[zone];
+    if (result == VDO_SUCCESS) {
+      result = replayZone->completion.result;
+    }
+    recovery->entriesAddedToSlabJournals += replayZone->entriesAdded;
+  }
+
+  ZoneCount zoneCount = recovery->replayZoneCount;
+  freeReplayZones(recovery);
+  if (abortRecoveryOnError(result, recovery)) {
+    return;
+  }
+
+  uint64_t elapsed = nowUsec() - recovery->replayStart;
+  vdo->recoveryStatistics.slabJournalEntries
+    = recovery->entriesAddedToSlabJournals;
+  vdo->recoveryStatistics.slabJournalTime = elapsed;
+  logInfo("Replayed %zu journal entries into slab journals in %" PRIu64
+          " ms using %u zones (%" PRIu64 " entries/second)",
+          recovery->entriesAddedToSlabJournals, elapsed / 1000, zoneCount,
+          ((uint64_t) recovery->entriesAddedToSlabJournals * 1000000)
+          / ((elapsed > 0) ? elapsed : 1));
+  result = findMissingDecrefs(recovery);
+  if (abortRecoveryOnError(result, recovery)) {
+    return;
+  }
+
+  findPBNsFromBlockMap(recovery);
+}
+
+/**
+ * Note that a zone has finished replaying into its slab journals, and if it
+ * is the last one, gather the results back on logical zone 0.
+ *
+ * @param replayZone  The zone which has finished
+ * @param result      The result of the zone's replay
+ **/
+static void finishZoneReplay(SlabReplayZone *replayZone, int result)
+{
+  RecoveryCompletion *recovery
+    = asRecoveryCompletion(replayZone->completion.parent);
+  setCompletionResult(&replayZone->completion, result);
+  if (atomicAdd32(&recovery->zonesReplaying, -1) > 0) {
+    return;
+  }
+
+  launchCallbackWithParent(&recovery->subTaskCompletion,
+                           finishSlabJournalReplay,
+                           getLogicalZoneThread(getThreadConfig(recovery->vdo),
+                                                0),
+                           &recovery->completion);
+}
+
+/**
+ * Add the recovery journal entries for the slabs of one physical zone into
+ * their slab journals, waiting when necessary. This callback is launched on
+ * the zone's thread by addSlabJournalEntries().
+ *
+ * @param completion  The SlabReplayZone's completion
+ **/
+static void replayZoneEntries(VDOCompletion *completion)
+{
+  SlabReplayZone     *replayZone = asSlabReplayZone(completion);
+  RecoveryCompletion *recovery   = asRecoveryCompletion(completion->parent);
+  VDO                *vdo        = recovery->vdo;
+
   // Get ready in case we need to enqueue again.
-  prepareCompletion(completion, addSlabJournalEntries, addSlabJournalEntries,
+  prepareCompletion(completion, replayZoneEntries, replayZoneEntries,
                     completion->callbackThreadID, &recovery->completion);
 
-  while (beforeRecoveryPoint(&recovery->nextRecoveryPoint,
-                             &recovery->tailRecoveryPoint)) {
-    RecoveryJournalEntry entry
-      = getEntry(recovery, &recovery->nextRecoveryPoint);
+  while (replayZone->entriesAdded < replayZone->entryCount) {
+    SlabReplayEntry *entry = &replayZone->entries[replayZone->entriesAdded];
+    Slab            *slab  = getSlab(vdo->depot, entry->pbn);
+    if (!mayAddSlabJournalEntry(slab->journal, entry->operation, completion)) {
+      return;
+    }
+
+    JournalPoint journalPoint = entry->journalPoint;
+    addSlabJournalEntryForRebuild(slab->journal, entry->pbn, entry->operation,
+                                  &journalPoint);
+    replayZone->entriesAdded++;
+  }
+
+  finishZoneReplay(replayZone, VDO_SUCCESS);
+}
+
+/**
+ * Sort the recovery journal entries which must be played into slab journals
+ * by the physical zone of the slab each one references, validating each
+ * entry once. Each zone's entries are kept in journal order. On success, the
+ * recovery's replay position is left at the tail of the journal.
+ *
+ * @param recovery  The recovery completion
+ *
+ * @return VDO_SUCCESS or an error code
+ **/
+static int partitionSlabJournalEntries(RecoveryCompletion *recovery)
+{
+  VDO             *vdo     = recovery->vdo;
+  RecoveryJournal *journal = vdo->recoveryJournal;
+  size_t           zoneEntries[MAX_PHYSICAL_ZONES];
+  memset(zoneEntries, 0, sizeof(zoneEntries));
+
+  // Count the entries for each zone.
+  size_t        entryCount = 0;
+  RecoveryPoint point      = recovery->nextRecoveryPoint;
+  while (beforeRecoveryPoint(&point, &recovery->tailRecoveryPoint)) {
+    RecoveryJournalEntry entry = getEntry(recovery, &point);
     int result = validateRecoveryJournalEntry(vdo, &entry);
     if (result != VDO_SUCCESS) {
       enterReadOnlyMode(journal->readOnlyContext, result);
-      finishCompletion(&recovery->completion, result);
-      return;
+      return result;
     }
 
-    if (entry.mapping.pbn == ZERO_BLOCK) {
-      incrementRecoveryPoint(&recovery->nextRecoveryPoint);
-      advanceJournalPoint(&recovery->nextJournalPoint,
-                          journal->entriesPerBlock);
-      continue;
+    if (entry.mapping.pbn != ZERO_BLOCK) {
+      Slab *slab = getSlab(vdo->depot, entry.mapping.pbn);
+      zoneEntries[slab->allocator->zoneNumber]++;
+      entryCount++;
     }
 
-    SlabJournal *slabJournal = getSlabJournal(vdo->depot, entry.mapping.pbn);
-    if (!mayAddSlabJournalEntry(slabJournal, entry.operation, completion)) {
-      return;
+    incrementRecoveryPoint(&point);
+  }
+
+  int result = ALLOCATE(entryCount, SlabReplayEntry, __func__,
+                        &recovery->slabReplayEntries);
+  if (result != VDO_SUCCESS) {
+    return result;
+  }
+
+  // Give each zone its slice of the array, and turn the counts into the
+  // index of the next free slot in each slice.
+  size_t start = 0;
+  for (ZoneCount zone = 0; zone < recovery->replayZoneCount; zone++) {
+    SlabReplayZone *replayZone = &recovery->replayZones[zone];
+    replayZone->entries    = &recovery->slabReplayEntries[start];
+    replayZone->entryCount = zoneEntries[zone];
+    zoneEntries[zone]      = start;
+    start                 += replayZone->entryCount;
+  }
+
+  while (beforeRecoveryPoint(&recovery->nextRecoveryPoint,
+                             &recovery->tailRecoveryPoint)) {
+    RecoveryJournalEntry entry
+      = getEntry(recovery, &recovery->nextRecoveryPoint);
+    if (entry.mapping.pbn != ZERO_BLOCK) {
+      Slab *slab = getSlab(vdo->depot, entry.mapping.pbn);
+      size_t index = zoneEntries[slab->allocator->zoneNumber]++;
+      recovery->slabReplayEntries[index] = (SlabReplayEntry) {
+        .pbn          = entry.mapping.pbn,
+        .journalPoint = recovery->nextJournalPoint,
+        .operation    = entry.operation,
+      };
     }
 
-    addSlabJournalEntryForRebuild(slabJournal,
-                                  entry.mapping.pbn, entry.operation,
-                                  &recovery->nextJournalPoint);
     incrementRecoveryPoint(&recovery->nextRecoveryPoint);
     advanceJournalPoint(&recovery->nextJournalPoint, journal->entriesPerBlock);
-    recovery->entriesAddedToSlabJournals++;
   }
 
-  logInfo("Replayed %zu journal entries into slab journals",
-          recovery->entriesAddedToSlabJournals);
-  int result = findMissingDecrefs(recovery);
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void addSlabJournalEntries(VDOCompletion *completion)
+{
+  RecoveryCompletion *recovery = asRecoveryCompletion(completion->parent);
+  VDO                *vdo      = recovery->vdo;
+
+  recovery->replayStart = nowUsec();
+  int result = makeReplayZones(recovery);
   if (abortRecoveryOnError(result, recovery)) {
     return;
   }
 
-  findPBNsFromBlockMap(recovery);
+  result = partitionSlabJournalEntries(recovery);
+  if (abortRecoveryOnError(result, recovery)) {
+    return;
+  }
+
+  // The last zone to finish frees the zones, which can not happen until
+  // every zone has been launched, so don't touch them after the last launch.
+  const ThreadConfig *threadConfig = getThreadConfig(vdo);
+  ZoneCount           zoneCount    = recovery->replayZoneCount;
+  atomicStore32(&recovery->zonesReplaying, zoneCount);
+  for (ZoneCount zone = 0; zone < zoneCount; zone++) {
+    launchCallbackWithParent(&recovery->replayZones[zone].completion,
+                             replayZoneEntries,
+                             getPhysicalZoneThread(threadConfig, zone),
+                             &recovery->completion);
+  }
 }
 
 /**
@@ -36,4 +36,43 @@
  **/
 void launchRecovery(VDO *vdo, VDOCompletion *parent);
 
+/**
+ * Start the background replay of a block map recovery which was deferred so
+ * that the VDO could come online sooner. Only reads are served until the
+ * replay is done and the super block has been saved; the layer holds writes
+ * back until then. Does nothing if no replay was deferred. This must be
+ * called on the admin thread.
+ *
+ * @param vdo  The VDO being recovered
+ **/
+void launchOnlineRecovery(VDO *vdo);
+
+/**
+ * Check whether a VDO is completing a recovery while online.
+ *
+ * @param vdo  The VDO
+ *
+ * @return <code>true</code> if a deferred block map replay has been launched
+ *         and has not finished
+ **/
+bool isRecoveringOnline(const VDO *vdo)
+  __attribute__((warn_unused_result));
+
+/**
+ * Wait for any online recovery to finish. This must be called on the admin
+ * thread.
+ *
+ * @param vdo     The VDO
+ * @param parent  The completion to complete when there is no online recovery
+ *                in progress
+ **/
+void waitForOnlineRecovery(VDO *vdo, VDOCompletion *parent);
+
+/**
+ * Free the state of an online recovery and null out the reference to it.
+ *
+ * @param onlineRecoveryPtr  A pointer to the recovery to free
+ **/
+void freeOnlineRecovery(OnlineRecovery **onlineRecoveryPtr);
+
 #endif // VDO_RECOVERY_H
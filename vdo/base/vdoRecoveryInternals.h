@@ -24,6 +24,7 @@
 
 #include "vdoRecovery.h"
 
+#include "atomic.h"
 #include "blockMapRecovery.h"
 #include "intMap.h"
 #include "journalPoint.h"
@@ -40,6 +41,36 @@ typedef struct {
   JournalEntryCount entryCount;     // Entry number
 } RecoveryPoint;
 
+/**
+ * A recovery journal entry which is to be played into a slab journal.
+ **/
+typedef struct {
+  /** The block whose reference count the entry changes */
+  PhysicalBlockNumber pbn;
+  /** The journal point to give to the slab journal entry */
+  JournalPoint        journalPoint;
+  /** The reference count operation */
+  JournalOperation    operation;
+} __attribute__((packed)) SlabReplayEntry;
+
+/**
+ * The progress of the slab journal replay for one physical zone. Each zone
+ * only visits the entries for its own slabs, which are sorted out of the
+ * journal once before any zone starts.
+ **/
+typedef struct {
+  /** The completion header, whose parent is the RecoveryCompletion */
+  VDOCompletion    completion;
+  /** The physical zone being replayed */
+  ZoneCount        zoneNumber;
+  /** The entries for this zone's slabs, in journal order */
+  SlabReplayEntry *entries;
+  /** The number of entries in the entries array */
+  size_t           entryCount;
+  /** The number of entries this zone has played into slab journals */
+  size_t           entriesAdded;
+} SlabReplayZone;
+
 typedef struct {
   /** The completion header */
   VDOCompletion         completion;
@@ -80,6 +111,16 @@ typedef struct {
   JournalPoint          nextJournalPoint;
   /** The number of entries played into slab journals */
   size_t                entriesAddedToSlabJournals;
+  /** The slab journal replay for each physical zone */
+  SlabReplayZone       *replayZones;
+  /** The number of entries in the replayZones array */
+  ZoneCount             replayZoneCount;
+  /** The storage for the entries of every replay zone */
+  SlabReplayEntry      *slabReplayEntries;
+  /** The number of physical zones which have not finished replaying */
+  Atomic32              zonesReplaying;
+  /** The time at which the slab journal replay started, in microseconds */
+  uint64_t              replayStart;
 
   // Decref synthesis fields
 
@@ -131,6 +172,7 @@ void freeRecoveryCompletion(RecoveryCompletion **recoveryPtr);
 
 /**
  * Add recovery journal entries into slab journals, waiting when necessary.
+ * Each physical zone replays the entries for its own slabs on its own thread.
  * This method is exposed only for testing purposes.
  *
  * @param completion  The sub-task completion
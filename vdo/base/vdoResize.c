@@ -29,6 +29,7 @@
 #include "slabDepot.h"
 #include "slabSummary.h"
 #include "vdoInternal.h"
+#include "vdoRecovery.h"
 #include "vdoLayout.h"
 
 /**
@@ -202,7 +203,7 @@ static void growPhysicalCallback(VDOCompletion *completion)
   }
 
   // This check should only be done from a base code thread.
-  if (inRecoveryMode(vdo)) {
+  if (inRecoveryMode(vdo) || isRecoveringOnline(vdo)) {
     finishCompletion(completion->parent, VDO_RETRY_AFTER_REBUILD);
     return;
   }
@@ -27,6 +27,7 @@
 #include "blockMap.h"
 #include "completion.h"
 #include "vdoInternal.h"
+#include "vdoRecovery.h"
 
 /**
  * Extract the VDO from an AdminCompletion, checking that the current operation
@@ -90,6 +91,13 @@ static void growLogicalCallback(VDOCompletion *completion)
     return;
   }
 
+  // The block map can't grow until it has been recovered.
+  if (isRecoveringOnline(vdo)) {
+    abandonBlockMapGrowth(getBlockMap(vdo));
+    finishCompletion(completion->parent, VDO_RETRY_AFTER_REBUILD);
+    return;
+  }
+
   vdo->config.logicalBlocks = getNewEntryCount(getBlockMap(vdo));
   prepareAdminSubTask(vdo, resizeBlockMap, handleSaveError);
   saveVDOComponentsAsync(vdo, completion);
@@ -124,6 +124,30 @@ static void releaseLogicalLock(VDOCompletion *completion)
   vioDoneCallback(completion);
 }
 
+/**
+ * Finish an optimistic read which did not take the logical block lock. If a
+ * writer has locked the block since the read began, the data read may be
+ * stale, so redo the read with the lock held. This callback is registered in
+ * cleanupReadDataVIO().
+ *
+ * @param completion  The DataVIO
+ **/
+static void finishOptimisticRead(VDOCompletion *completion)
+{
+  DataVIO *dataVIO = asDataVIO(completion);
+  assertInLogicalZone(dataVIO);
+  if (isOptimisticReadCurrent(dataVIO)) {
+    vioDoneCallback(completion);
+    return;
+  }
+
+  VIO *vio = dataVIOAsVIO(dataVIO);
+  dataVIO->mayReadOptimistically = false;
+  prepareDataVIO(dataVIO, dataVIO->logical.lbn, vio->operation, false,
+                 vio->callback);
+  invokeCallback(completion);
+}
+
 /**
  * Clean up a DataVIO which has finished processing a read.
  *
@@ -131,6 +155,12 @@ static void releaseLogicalLock(VDOCompletion *completion)
  **/
 void cleanupReadDataVIO(DataVIO *dataVIO)
 {
+  if (dataVIO->logical.optimistic) {
+    launchLogicalCallback(dataVIO, finishOptimisticRead,
+                          THIS_LOCATION("$F;cb=finishOptimisticRead"));
+    return;
+  }
+
   launchLogicalCallback(dataVIO, releaseLogicalLock,
                         THIS_LOCATION("$F;cb=releaseLL"));
 }
@@ -26,8 +26,9 @@
 
 /**
  * Start the asynchronous processing of the DataVIO for a read or
- * read-modify-write request which has acquired a lock on its logical block.
- * The first step is to perform a block map lookup.
+ * read-modify-write request which has acquired a lock on its logical block
+ * (or which is an optimistic read which does not need the lock). The first
+ * step is to perform a block map lookup.
  *
  * @param dataVIO  The DataVIO doing the read
  **/
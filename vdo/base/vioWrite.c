@@ -981,6 +981,10 @@ static void journalUnmappingForWrite(VDOCompletion *completion)
  * LBN->PBN mapping. This callback is registered in finishBlockWrite() in the
  * async path, and is registered in acknowledgeWrite() in the sync path.
  *
+ * <p>Trims and zero block writes read the mapping in
+ * continueWriteWithBlockMapSlot(), and have held the logical lock ever since,
+ * so the mapping they found is still current and is not read again.
+ *
  * @param completion  The completion of the write in progress
  **/
 static void readOldBlockMappingForWrite(VDOCompletion *completion)
@@ -991,6 +995,12 @@ static void readOldBlockMappingForWrite(VDOCompletion *completion)
     return;
   }
 
+  if (isTrimDataVIO(dataVIO) || dataVIO->isZeroBlock) {
+    launchJournalCallback(dataVIO, journalUnmappingForWrite,
+                          THIS_LOCATION("$F;cb=journalUnmapWrite"));
+    return;
+  }
+
   setJournalCallback(dataVIO, journalUnmappingForWrite,
                      THIS_LOCATION("$F;cb=journalUnmapWrite"));
   dataVIO->lastAsyncOperation = GET_MAPPED_BLOCK_FOR_WRITE;
@@ -1146,6 +1156,44 @@ static void continueWriteAfterAllocation(AllocatingVIO *allocatingVIO)
   acknowledgeWrite(dataVIO);
 }
 
+/**
+ * Skip the rest of a trim or zero block write if the block is already mapped
+ * the way the write would map it, since recording the write would only
+ * journal a no-op increment and decrement pair. Otherwise, continue the write
+ * like any other write of the zero block. This callback is registered in
+ * continueWriteWithBlockMapSlot().
+ *
+ * <p>The logical lock is held throughout, so the mapping can not change
+ * before the entries would have been made. The entries which established the
+ * existing mapping were written before that write released the lock, but they
+ * may not have been flushed yet, so a write which must be durable when it
+ * completes is always journaled.
+ *
+ * @param completion  The trim or zero block DataVIO
+ **/
+static void continueZeroWriteWithOldMapping(VDOCompletion *completion)
+{
+  DataVIO *dataVIO = asDataVIO(completion);
+  assertInLogicalZone(dataVIO);
+  if (abortOnError(completion->result, dataVIO, READ_ONLY)) {
+    return;
+  }
+
+  dataVIO->newMapped.pbn = ZERO_BLOCK;
+  if ((dataVIO->mapped.pbn == ZERO_BLOCK)
+      && (dataVIO->mapped.state == dataVIO->newMapped.state)
+      && !vioRequiresFlushAfter(dataVIOAsVIO(dataVIO))) {
+    // Both the increment and the decrement entries are avoided.
+    noteRecoveryJournalEntriesElided(getVDOFromDataVIO(dataVIO)
+                                     ->recoveryJournal, 2);
+    finishDataVIO(dataVIO, VDO_SUCCESS);
+    return;
+  }
+
+  launchJournalCallback(dataVIO, finishBlockWrite,
+                        THIS_LOCATION("$F;cb=finishWrite"));
+}
+
 /**
  * Continue the write path for a VIO now that block map slot resolution is
  * complete. This callback is registered in launchWriteDataVIO().
@@ -1168,17 +1216,25 @@ static void continueWriteWithBlockMapSlot(VDOCompletion *completion)
     }
 
     // This is a trim for a block on a block map page which has not been
-    // allocated, so there's nothing more we need to do.
+    // allocated, so there's nothing more we need to do for it or for any of
+    // the blocks after it on the same page.
+    dataVIO->trimmedBlocks = (BLOCK_MAP_ENTRIES_PER_PAGE
+                              - (dataVIO->logical.lbn
+                                 % BLOCK_MAP_ENTRIES_PER_PAGE));
     finishDataVIO(dataVIO, VDO_SUCCESS);
     return;
   }
 
-  if (dataVIO->isZeroBlock || isTrimDataVIO(dataVIO)) {
+  if (isTrimDataVIO(dataVIO) || dataVIO->isZeroBlock) {
     // We don't need to write any data, so skip allocation and just update
-    // the block map and reference counts (via the journal).
-    dataVIO->newMapped.pbn = ZERO_BLOCK;
-    launchJournalCallback(dataVIO, finishBlockWrite,
-                          THIS_LOCATION("$F;cb=finishWrite"));
+    // the block map and reference counts (via the journal). Check the
+    // existing mapping before making any journal entries, since large
+    // discards often cover blocks which are already unmapped, and zero
+    // blocks are often rewritten over zero blocks.
+    setLogicalCallback(dataVIO, continueZeroWriteWithOldMapping,
+                       THIS_LOCATION("$F;cb=continueZeroWrite"));
+    dataVIO->lastAsyncOperation = GET_MAPPED_BLOCK_FOR_WRITE;
+    getMappedBlockAsync(dataVIO);
     return;
   }
 
@@ -132,6 +132,71 @@ int dequeueMatchingWaiters(WaitQueue   *queue,
   return VDO_SUCCESS;
 }
 
+/**
+ * Merge sort a list of waiters. Only the given number of waiters starting at
+ * the head of the list are sorted; the rest of the list is left alone.
+ *
+ * @param head        The first waiter of the list to sort
+ * @param length      The number of waiters to sort
+ * @param comparator  The method which orders the waiters
+ *
+ * @return The first waiter of the sorted, null-terminated list
+ **/
+static Waiter *sortWaiterList(Waiter           *head,
+                              size_t            length,
+                              WaiterComparator *comparator)
+{
+  if (length == 1) {
+    head->nextWaiter = NULL;
+    return head;
+  }
+
+  size_t  firstLength = length / 2;
+  Waiter *second      = head;
+  for (size_t i = 0; i < firstLength; i++) {
+    second = second->nextWaiter;
+  }
+
+  Waiter *first = sortWaiterList(head, firstLength, comparator);
+  second = sortWaiterList(second, length - firstLength, comparator);
+
+  // Take from the first list on ties so that the sort is stable.
+  Waiter  *merged  = NULL;
+  Waiter **tailPtr = &merged;
+  while ((first != NULL) && (second != NULL)) {
+    if (comparator(second, first) < 0) {
+      *tailPtr = second;
+      second   = second->nextWaiter;
+    } else {
+      *tailPtr = first;
+      first    = first->nextWaiter;
+    }
+    tailPtr = &(*tailPtr)->nextWaiter;
+  }
+
+  *tailPtr = ((first != NULL) ? first : second);
+  return merged;
+}
+
+/**********************************************************************/
+void sortWaiters(WaitQueue *queue, WaiterComparator *comparator)
+{
+  if (queue->queueLength < 2) {
+    return;
+  }
+
+  Waiter *head = sortWaiterList(getFirstWaiter(queue), queue->queueLength,
+                                comparator);
+
+  // Make the sorted list circular again.
+  Waiter *lastWaiter = head;
+  while (lastWaiter->nextWaiter != NULL) {
+    lastWaiter = lastWaiter->nextWaiter;
+  }
+  lastWaiter->nextWaiter = head;
+  queue->lastWaiter      = lastWaiter;
+}
+
 /**********************************************************************/
 Waiter *dequeueNextWaiter(WaitQueue *queue)
 {
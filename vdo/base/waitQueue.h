@@ -63,6 +63,13 @@ typedef void WaiterCallback(Waiter *waiter, void *context);
  **/
 typedef bool WaiterMatch(Waiter *waiter, void *context);
 
+/**
+ * Method type for Waiter ordering methods.
+ * A WaiterComparator returns a negative value, zero, or a positive value as
+ * the first waiter sorts before, with, or after the second.
+ **/
+typedef int WaiterComparator(const Waiter *waiter1, const Waiter *waiter2);
+
 /**
  * The queue entry structure for entries in a WaitQueue.
  **/
@@ -193,6 +200,15 @@ int dequeueMatchingWaiters(WaitQueue   *queue,
                            void        *matchContext,
                            WaitQueue   *matchedQueue);
 
+/**
+ * Sort the waiters in a wait queue. The sort is stable, so waiters which
+ * compare as equal stay in the order in which they were enqueued.
+ *
+ * @param queue       The wait queue to sort
+ * @param comparator  The method which orders the waiters
+ **/
+void sortWaiters(WaitQueue *queue, WaiterComparator *comparator);
+
 /**
  * Remove the first waiter from the head end of a wait queue. The caller will
  * be responsible for waking the waiter by invoking the correct callback
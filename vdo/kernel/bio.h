@@ -32,6 +32,20 @@
 #define USE_BI_ITER 1
 #endif
 
+/**
+ * The position of a bio, saved so that a bio which has been completed by the
+ * storage below VDO can be submitted again.
+ **/
+typedef struct {
+#ifdef USE_BI_ITER
+  struct bvec_iter iter;
+#else
+  sector_t         sector;
+  unsigned int     size;
+  unsigned short   index;
+#endif
+} BioPosition;
+
 /**
  * Copy the bio data to a char array.
  *
@@ -296,6 +310,49 @@ static inline sector_t getBioSector(BIO *bio)
 #endif
 }
 
+/**
+ * Save the position of a bio.
+ *
+ * @param [in]  bio       The bio
+ * @param [out] position  The saved position
+ **/
+static inline void saveBioPosition(BIO *bio, BioPosition *position)
+{
+#ifdef USE_BI_ITER
+  position->iter   = bio->bi_iter;
+#else
+  position->sector = bio->bi_sector;
+  position->size   = bio->bi_size;
+  position->index  = bio->bi_idx;
+#endif
+}
+
+/**
+ * Restore a bio to a saved position and clear any error from its previous
+ * submission.
+ *
+ * @param bio       The bio
+ * @param position  The position to restore
+ **/
+static inline void restoreBioPosition(BIO *bio, const BioPosition *position)
+{
+#ifdef USE_BI_ITER
+  bio->bi_iter   = position->iter;
+#else
+  bio->bi_sector = position->sector;
+  bio->bi_size   = position->size;
+  bio->bi_idx    = position->index;
+#endif
+
+#if LINUX_VERSION_CODE >= KERNEL_VERSION(4,13,0)
+  bio->bi_status = BLK_STS_OK;
+#elif LINUX_VERSION_CODE >= KERNEL_VERSION(4,4,0)
+  bio->bi_error  = 0;
+#else
+  set_bit(BIO_UPTODATE, &bio->bi_flags);
+#endif
+}
+
 /**
  * Tell the kernel we've completed processing of this bio.
  *
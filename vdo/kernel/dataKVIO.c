@@ -25,6 +25,7 @@
 #include "logger.h"
 #include "memoryAlloc.h"
 #include "murmur/MurmurHash3.h"
+#include "timeUtils.h"
 
 #include "dataVIO.h"
 #include "compressedBlock.h"
@@ -152,6 +153,9 @@ static void kvdoAcknowledgeDataKVIO(DataKVIO *dataKVIO)
   if (dataKVIO->isPartial) {
     countBios(&layer->biosAcknowledgedPartial, bio);
   }
+  recordQoSLatency(&layer->qosLatency, dataKVIO->qosClass, isReadBio(bio),
+                   (currentTime(CT_MONOTONIC) - dataKVIO->admissionTime)
+                   / 1000);
 
 
   dataKVIOAddTraceRecord(dataKVIO, THIS_LOCATION(NULL));
@@ -188,9 +192,15 @@ void returnDataKVIOBatchToPool(BatchProcessor *batch, void *closure)
   FreeBufferPointers fbp;
   initFreeBufferPointers(&fbp, layer->dataKVIOPool);
 
+  uint32_t      bulkCount = 0;
   KvdoWorkItem *item;
   while ((item = nextBatchItem(batch)) != NULL) {
-    cleanDataKVIO(workItemAsDataKVIO(item), &fbp);
+    DataKVIO *dataKVIO = workItemAsDataKVIO(item);
+    if (dataKVIO->hasBulkPermit) {
+      dataKVIO->hasBulkPermit = false;
+      bulkCount++;
+    }
+    cleanDataKVIO(dataKVIO, &fbp);
     condReschedBatchProcessor(batch);
     count++;
   }
@@ -199,6 +209,9 @@ void returnDataKVIOBatchToPool(BatchProcessor *batch, void *closure)
     freeBufferPointers(&fbp);
   }
 
+  if (bulkCount > 0) {
+    limiterReleaseMany(&layer->bulkLimiter, bulkCount);
+  }
   completeManyRequests(layer, count);
 }
 
@@ -220,7 +233,7 @@ void kvdoCompleteDataKVIO(VDOCompletion *completion)
   if (useBioAckQueue(layer) && USE_BIO_ACK_QUEUE_FOR_READ
       && (dataKVIO->externalIORequest.bio != NULL)) {
     launchDataKVIOOnBIOAckQueue(dataKVIO, kvdoAcknowledgeThenCompleteDataKVIO,
-                                NULL, BIO_ACK_Q_ACTION_ACK);
+                                NULL, getDataKVIOAckAction(dataKVIO));
   } else {
     addToBatchProcessor(layer->dataKVIOReleaser,
                         workItemFromDataKVIO(dataKVIO));
@@ -272,7 +285,8 @@ static void readDataKVIOReadBlockCallback(DataKVIO *dataKVIO)
   }
 
   launchDataKVIOOnCPUQueue(dataKVIO, copyReadBlockData, NULL,
-                           CPU_Q_ACTION_COMPRESS_BLOCK);
+                           getDataKVIOCPUAction(dataKVIO,
+                                                CPU_Q_ACTION_COMPRESS_BLOCK));
 }
 
 #if LINUX_VERSION_CODE >= KERNEL_VERSION(4,4,0)
@@ -432,19 +446,21 @@ static void completeRead(DataKVIO *dataKVIO, int result)
   readBlock->status = result;
 
   if ((result == VDO_SUCCESS) && isCompressed(readBlock->mappingState)) {
+    CPUQAction action = getDataKVIOCPUAction(dataKVIO,
+                                             CPU_Q_ACTION_COMPRESS_BLOCK);
 
     // launchDataKVIOOnCPUQueue(dataKVIO, uncompressReadBlockWithQAT, NULL,
     //                         CPU_Q_ACTION_COMPRESS_BLOCK);
 
     if (dataKVIO->dataVIO.compressPolicy == COMPRESS_POLICY_QAT) {
       launchDataKVIOOnCPUQueue(dataKVIO, uncompressReadBlockWithQAT, NULL,   
-                          CPU_Q_ACTION_COMPRESS_BLOCK);
+                          action);
     } else if (dataKVIO->dataVIO.compressPolicy == COMPRESS_POLICY_ZLIB) {
       launchDataKVIOOnCPUQueue(dataKVIO, uncompressReadBlockWithZlib, NULL,   
-                          CPU_Q_ACTION_COMPRESS_BLOCK);
+                          action);
     } else {
       launchDataKVIOOnCPUQueue(dataKVIO, uncompressReadBlock, NULL,
-                          CPU_Q_ACTION_COMPRESS_BLOCK);
+                          action);
     }
     
     return;
@@ -516,17 +532,25 @@ void kvdoReadDataVIO(DataVIO *dataVIO)
                   "operation set correctly for data read");
   dataVIOAddTraceRecord(dataVIO, THIS_LOCATION("$F;io=readData"));
 
+  DataKVIO *dataKVIO = dataVIOAsDataKVIO(dataVIO);
   if (isCompressed(dataVIO->mapped.state)) {
     kvdoReadBlock(dataVIO, dataVIO->mapped.pbn, dataVIO->mapped.state,
-                  BIO_Q_ACTION_COMPRESSED_DATA, readDataKVIOReadBlockCallback);
+                  getDataKVIOBioAction(dataKVIO,
+                                       BIO_Q_ACTION_COMPRESSED_DATA),
+                  readDataKVIOReadBlockCallback);
     return;
   }
 
-  KVIO *kvio = dataVIOAsKVIO(dataVIO);
+  KVIO *kvio = dataKVIOAsKVIO(dataKVIO);
   BIO  *bio  = kvio->bio;
+  if (!dataKVIO->isPartial) {
+    // This is the user's bio, which an optimistic read which is being redone
+    // will already have submitted once.
+    restoreBioPosition(bio, &dataKVIO->externalIORequest.position);
+  }
   bio->bi_end_io = resetUserBio;
   setBioSector(bio, blockToSector(kvio->layer, dataVIO->mapped.pbn));
-  submitBio(bio, BIO_Q_ACTION_DATA);
+  submitBio(bio, getDataKVIOBioAction(dataKVIO, BIO_Q_ACTION_DATA));
 }
 
 /**********************************************************************/
@@ -535,6 +559,12 @@ static void kvdoAcknowledgeDataKVIOThenContinue(KvdoWorkItem *item)
   DataKVIO *dataKVIO = workItemAsDataKVIO(item);
   dataKVIOAddTraceRecord(dataKVIO, THIS_LOCATION(NULL));
   kvdoAcknowledgeDataKVIO(dataKVIO);
+  if (dataKVIO->dataVIO.logical.optimistic) {
+    // An optimistic read holds no logical block lock, so the base code has
+    // nothing left to do for it and there is no need to return to its zone.
+    addToBatchProcessor(dataKVIO->kvio.layer->dataKVIOReleaser, item);
+    return;
+  }
   // Even if we're not using bio-ack threads, we may be in the wrong
   // base-code thread.
   kvdoEnqueueDataVIOCallback(dataKVIO);
@@ -560,7 +590,7 @@ void kvdoAcknowledgeDataVIO(DataVIO *dataVIO)
   if (useBioAckQueue(layer)) {
     dataVIOAddTraceRecord(dataVIO, THIS_LOCATION(NULL));
     launchDataKVIOOnBIOAckQueue(dataKVIO, kvdoAcknowledgeDataKVIOThenContinue,
-                                NULL, BIO_ACK_Q_ACTION_ACK);
+                                NULL, getDataKVIOAckAction(dataKVIO));
   } else {
     kvdoAcknowledgeDataKVIOThenContinue(workItemFromDataKVIO(dataKVIO));
   }
@@ -573,11 +603,12 @@ void kvdoWriteDataVIO(DataVIO *dataVIO)
                   "kvdoWriteDataVIO() called on write DataVIO");
   dataVIOAddTraceRecord(dataVIO, THIS_LOCATION("$F;io=writeData;j=normal"));
 
-  KVIO *kvio  = dataVIOAsKVIO(dataVIO);
-  BIO  *bio   = kvio->bio;
+  DataKVIO *dataKVIO = dataVIOAsDataKVIO(dataVIO);
+  KVIO     *kvio     = dataKVIOAsKVIO(dataKVIO);
+  BIO      *bio      = kvio->bio;
   setBioOperationWrite(bio);
   setBioSector(bio, blockToSector(kvio->layer, dataVIO->newMapped.pbn));
-  submitBio(bio, BIO_Q_ACTION_DATA);
+  submitBio(bio, getDataKVIOBioAction(dataKVIO, BIO_Q_ACTION_DATA));
 }
 
 /**********************************************************************/
@@ -810,10 +841,18 @@ static int kvdoCreateKVIOFromBio(KernelLayer  *layer,
     return result;
   }
 
+  saveBioPosition(bio, &externalIORequest.position);
   dataKVIO->externalIORequest = externalIORequest;
+  dataKVIO->qosClass
+    = getBioQoSClass(bio, layer->deviceConfig->defaultQoSClass);
+  dataKVIO->admissionTime = currentTime(CT_MONOTONIC);
   dataKVIO->offset = sectorToBlockOffset(layer, getBioSector(bio));
   dataKVIO->isPartial = ((getBioSize(bio) < VDO_BLOCK_SIZE)
                          || (dataKVIO->offset != 0));
+  dataKVIO->dataVIO.mayReadOptimistically
+    = (isReadBio(bio) && !dataKVIO->isPartial);
+  dataKVIO->dataVIO.skipCompression
+    = (dataKVIO->qosClass == QOS_CLASS_HIGH);
 
   if (dataKVIO->isPartial) {
     countBios(&layer->biosInPartial, bio);
@@ -885,9 +924,17 @@ static void kvdoContinueDiscardKVIO(VDOCompletion *completion)
   DataVIO     *dataVIO  = asDataVIO(completion);
   DataKVIO    *dataKVIO = dataVIOAsDataKVIO(dataVIO);
   KernelLayer *layer    = getLayerFromDataKVIO(dataKVIO);
+
+  // A trim which found its block map page unallocated may skip the rest of
+  // the blocks on that page.
+  BlockCount skipped   = 0;
+  uint64_t   processed = VDO_BLOCK_SIZE - dataKVIO->offset;
+  if (!dataKVIO->isPartial && (dataVIO->trimmedBlocks > 1)) {
+    skipped    = dataVIO->trimmedBlocks - 1;
+    processed += skipped * VDO_BLOCK_SIZE;
+  }
   dataKVIO->remainingDiscard
-    -= min(dataKVIO->remainingDiscard,
-           (DiscardSize) (VDO_BLOCK_SIZE - dataKVIO->offset));
+    -= min((uint64_t) dataKVIO->remainingDiscard, processed);
   if ((completion->result != VDO_SUCCESS)
       || (dataKVIO->remainingDiscard == 0)) {
     if (dataKVIO->hasDiscardPermit) {
@@ -915,10 +962,10 @@ static void kvdoContinueDiscardKVIO(VDOCompletion *completion)
     operation |= VIO_FLUSH_AFTER;
   }
 
-  prepareDataVIO(dataVIO, dataVIO->logical.lbn + 1, operation,
+  prepareDataVIO(dataVIO, dataVIO->logical.lbn + skipped + 1, operation,
                  !dataKVIO->isPartial, kvdoContinueDiscardKVIO);
   enqueueDataKVIO(dataKVIO, launchDataKVIOWork, completion->callback,
-                  REQ_Q_ACTION_MAP_BIO);
+                  getDataKVIOMapAction(dataKVIO));
 }
 
 /**
@@ -941,7 +988,8 @@ static void kvdoCompletePartialRead(VDOCompletion *completion)
 int kvdoLaunchDataKVIOFromBio(KernelLayer *layer,
                               BIO         *bio,
                               uint64_t     arrivalTime,
-                              bool         hasDiscardPermit)
+                              bool         hasDiscardPermit,
+                              bool         hasBulkPermit)
 {
 
   DataKVIO *dataKVIO = NULL;
@@ -951,10 +999,15 @@ int kvdoLaunchDataKVIOFromBio(KernelLayer *layer,
     if (hasDiscardPermit) {
       limiterRelease(&layer->discardLimiter);
     }
+    if (hasBulkPermit) {
+      limiterRelease(&layer->bulkLimiter);
+    }
     limiterRelease(&layer->requestLimiter);
     return mapToSystemError(result);
   }
 
+  dataKVIO->hasBulkPermit = hasBulkPermit;
+
   /*
    * Discards behave very differently than other requests when coming
    * in from device-mapper. We have to be able to handle any size discards
@@ -992,7 +1045,7 @@ int kvdoLaunchDataKVIOFromBio(KernelLayer *layer,
     = sectorToBlock(layer, getBioSector(bio) - layer->startingSectorOffset);
   prepareDataVIO(&dataKVIO->dataVIO, lbn, operation, isTrim, callback);
   enqueueKVIO(kvio, launchDataKVIOWork, vioAsCompletion(kvio->vio)->callback,
-              REQ_Q_ACTION_MAP_BIO);
+              getDataKVIOMapAction(dataKVIO));
   return VDO_SUCCESS;
 }
 
@@ -1018,8 +1071,10 @@ static void kvdoHashDataWork(KvdoWorkItem *item)
 void kvdoHashDataVIO(DataVIO *dataVIO)
 {
   dataVIOAddTraceRecord(dataVIO, THIS_LOCATION(NULL));
-  launchDataKVIOOnCPUQueue(dataVIOAsDataKVIO(dataVIO), kvdoHashDataWork, NULL,
-                           CPU_Q_ACTION_HASH_BLOCK);
+  DataKVIO *dataKVIO = dataVIOAsDataKVIO(dataVIO);
+  launchDataKVIOOnCPUQueue(dataKVIO, kvdoHashDataWork, NULL,
+                           getDataKVIOCPUAction(dataKVIO,
+                                                CPU_Q_ACTION_HASH_BLOCK));
 }
 
 /**********************************************************************/
@@ -41,6 +41,8 @@ typedef struct {
   // This is a copy of the bi_rw field of the BIO which sadly is not just
   // a boolean read-write flag, but also includes other flag bits.
   unsigned long  rw;
+  // The original position of the bio, needed if a read must be redone.
+  BioPosition    position;
 } ExternalIORequest;
 
 /* Dedupe support */
@@ -100,6 +102,11 @@ struct dataKVIO {
   /* discard support */
   bool               hasDiscardPermit;
   DiscardSize        remainingDiscard;
+  /* quality of service support */
+  QoSClass           qosClass;
+  bool               hasBulkPermit;
+  /** The time (in ns) at which the request was admitted */
+  uint64_t           admissionTime;
   /**
    * A copy of user data written, so we can do additional processing
    * (dedupe, compression) after acknowledging the I/O operation and
@@ -190,6 +197,65 @@ static inline KvdoWorkItem *workItemFromDataKVIO(DataKVIO *dataKVIO)
   return &dataKVIOAsKVIO(dataKVIO)->enqueueable.workItem;
 }
 
+/**
+ * Get the request queue action for starting to process a DataKVIO. Only the
+ * launch of a new request is prioritized; once a DataKVIO is running, its
+ * callbacks on the base threads stay in FIFO order with all other work, which
+ * much of the base code relies on.
+ *
+ * @param dataKVIO  The DataKVIO
+ *
+ * @return The action with which to launch the DataKVIO
+ **/
+static inline ReqQAction getDataKVIOMapAction(DataKVIO *dataKVIO)
+{
+  return ((dataKVIO->qosClass == QOS_CLASS_HIGH)
+          ? REQ_Q_ACTION_HIGH_MAP_BIO : REQ_Q_ACTION_MAP_BIO);
+}
+
+/**
+ * Get the CPU queue action for work on behalf of a DataKVIO.
+ *
+ * @param dataKVIO      The DataKVIO
+ * @param normalAction  The action to use for a DataKVIO of the normal class
+ *
+ * @return The action with which to enqueue the work
+ **/
+static inline CPUQAction getDataKVIOCPUAction(DataKVIO   *dataKVIO,
+                                              CPUQAction  normalAction)
+{
+  return ((dataKVIO->qosClass == QOS_CLASS_HIGH)
+          ? CPU_Q_ACTION_HIGH_DATA : normalAction);
+}
+
+/**
+ * Get the bio queue action for submitting a DataKVIO's data I/O.
+ *
+ * @param dataKVIO      The DataKVIO
+ * @param normalAction  The action to use for a DataKVIO of the normal class
+ *
+ * @return The action with which to submit the bio
+ **/
+static inline BioQAction getDataKVIOBioAction(DataKVIO   *dataKVIO,
+                                              BioQAction  normalAction)
+{
+  return ((dataKVIO->qosClass == QOS_CLASS_HIGH)
+          ? BIO_Q_ACTION_HIGH_DATA : normalAction);
+}
+
+/**
+ * Get the bio acknowledgement queue action for a DataKVIO.
+ *
+ * @param dataKVIO  The DataKVIO
+ *
+ * @return The action with which to acknowledge the DataKVIO's bio
+ **/
+static inline BioAckQAction getDataKVIOAckAction(DataKVIO *dataKVIO)
+{
+  return ((dataKVIO->qosClass == QOS_CLASS_HIGH)
+          ? BIO_ACK_Q_ACTION_HIGH_ACK : BIO_ACK_Q_ACTION_ACK);
+}
+
 /**
  * Get the BIO from a DataKVIO.
  *
@@ -316,8 +382,8 @@ static inline bool requestorSetFUA(DataKVIO *dataKVIO)
  * processing the KVIO.
  *
  * If setting up a KVIO fails, a message is logged, and the limiter permits
- * (request and maybe discard) released, but the caller is responsible for
- * disposing of the bio.
+ * (request and maybe discard or bulk) released, but the caller is
+ * responsible for disposing of the bio.
  *
  * @param layer                 The physical layer
  * @param bio                   The bio for which to create KVIO
@@ -325,13 +391,16 @@ static inline bool requestorSetFUA(DataKVIO *dataKVIO)
  *                              entered the device mapbio function
  * @param hasDiscardPermit      Whether we got a permit from the discardLimiter
  *                              of the kernel layer
+ * @param hasBulkPermit         Whether we got a permit from the bulkLimiter
+ *                              of the kernel layer
  *
  * @return VDO_SUCCESS or a system error code
  **/
 int kvdoLaunchDataKVIOFromBio(KernelLayer *layer,
                               BIO         *bio,
                               Jiffies      arrivalTime,
-                              bool         hasDiscardPermit)
+                              bool         hasDiscardPermit,
+                              bool         hasBulkPermit)
   __attribute__((warn_unused_result));
 
 /**
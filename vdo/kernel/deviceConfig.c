@@ -30,6 +30,7 @@
 #include "vdoStringUtils.h"
 
 #include "constants.h"
+#include "slabScrubber.h"
 
 enum {
   // If we bump this, update the arrays below
@@ -398,6 +399,82 @@ static int processOneKeyValuePair(const char   *key,
     config->maxDiscardBlocks = value;
     return VDO_SUCCESS;
   } 
+  if (strcmp(key, "qosClass") == 0) {
+    if (value >= QOS_CLASS_COUNT) {
+      logError("optional parameter error: qosClass must be less than %d",
+               QOS_CLASS_COUNT);
+      return -EINVAL;
+    }
+    config->defaultQoSClass = value;
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "blockMapCachePolicy") == 0) {
+    if (value > PAGE_CACHE_POLICY_2Q) {
+      logError("optional parameter error: blockMapCachePolicy must be"
+               " 0 (lru) or 1 (2q)");
+      return -EINVAL;
+    }
+    config->cachePolicy = value;
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "blockMapWriteback") == 0) {
+    if (value > 1) {
+      logError("optional parameter error: blockMapWriteback must be"
+               " 0 (at expiration) or 1 (background)");
+      return -EINVAL;
+    }
+    config->backgroundWriteback = (value == 1);
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "onlineRecovery") == 0) {
+    if (value > 1) {
+      logError("optional parameter error: onlineRecovery must be"
+               " 0 (off) or 1 (on)");
+      return -EINVAL;
+    }
+    config->onlineRecovery = (value == 1);
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "lazyRefCountLoad") == 0) {
+    if (value > 1) {
+      logError("optional parameter error: lazyRefCountLoad must be"
+               " 0 (off) or 1 (on)");
+      return -EINVAL;
+    }
+    config->lazyRefCountLoad = (value == 1);
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "scrubConcurrency") == 0) {
+    if ((value < 1) || (value > MAX_SCRUBBING_CONCURRENCY)) {
+      logError("optional parameter error: scrubConcurrency must be"
+               " between 1 and %u", MAX_SCRUBBING_CONCURRENCY);
+      return -EINVAL;
+    }
+    config->scrubConcurrency = value;
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "scrubIOBudget") == 0) {
+    config->scrubIOBudget = value;
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "compactColdSlabs") == 0) {
+    if (value > 1) {
+      logError("optional parameter error: compactColdSlabs must be"
+               " 0 (off) or 1 (on)");
+      return -EINVAL;
+    }
+    config->compactColdSlabs = (value == 1);
+    return VDO_SUCCESS;
+  }
+  if (strcmp(key, "numaBindLogicalZones") == 0) {
+    if (value > 1) {
+      logError("optional parameter error: numaBindLogicalZones must be"
+               " 0 (off) or 1 (on)");
+      return -EINVAL;
+    }
+    config->numaBindLogicalZones = (value == 1);
+    return VDO_SUCCESS;
+  }
   // Handles unknown key names
   return processOneThreadConfigSpec(key, value, &config->threadCounts);
 }
@@ -565,7 +642,16 @@ int parseDeviceConfig(int                argc,
     .physicalZones       = 0,
     .hashZones           = 0,
   };
-  config->maxDiscardBlocks = 1;
+  config->maxDiscardBlocks    = 1;
+  config->defaultQoSClass     = QOS_CLASS_NORMAL;
+  config->cachePolicy         = PAGE_CACHE_POLICY_LRU;
+  config->backgroundWriteback = false;
+  config->onlineRecovery      = false;
+  config->lazyRefCountLoad    = false;
+  config->scrubConcurrency    = 1;
+  config->scrubIOBudget       = 0;
+  config->compactColdSlabs    = false;
+  config->numaBindLogicalZones = false;
 
   struct dm_arg_set argSet;
 
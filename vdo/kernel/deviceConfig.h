@@ -24,6 +24,7 @@
 #include <linux/device-mapper.h>
 
 #include "kernelTypes.h"
+#include "qos.h"
 
 // This structure is memcmp'd for equality. Keep it
 // packed and don't add any fields that are not
@@ -53,10 +54,19 @@ typedef struct {
   CompressPolicy     compressPolicy;
   unsigned int       cacheSize;
   unsigned int       blockMapMaximumAge;
+  PageCachePolicy    cachePolicy;
+  bool               backgroundWriteback;
+  bool               onlineRecovery;
+  bool               lazyRefCountLoad;
+  unsigned int       scrubConcurrency;
+  unsigned int       scrubIOBudget;
+  bool               compactColdSlabs;
+  bool               numaBindLogicalZones;
   bool               mdRaid5ModeEnabled;
   char              *poolName;
   ThreadCountConfig  threadCounts;
   BlockCount         maxDiscardBlocks;
+  QoSClass           defaultQoSClass;
 } DeviceConfig;
 
 /**
@@ -593,6 +593,20 @@ static int vdoInitialize(struct dm_target *ti,
   logDebug("Physical blocks        = %" PRIu64, config->physicalBlocks);
   logDebug("Block map cache blocks = %u", config->cacheSize);
   logDebug("Block map maximum age  = %u", config->blockMapMaximumAge);
+  logDebug("Block map cache policy = %s",
+           ((config->cachePolicy == PAGE_CACHE_POLICY_2Q) ? "2q" : "lru"));
+  logDebug("Block map writeback    = %s",
+           (config->backgroundWriteback ? "background" : "at expiration"));
+  logDebug("Online recovery        = %s",
+           (config->onlineRecovery ? "on" : "off"));
+  logDebug("Lazy refcount load     = %s",
+           (config->lazyRefCountLoad ? "on" : "off"));
+  logDebug("Scrub concurrency      = %u", config->scrubConcurrency);
+  logDebug("Scrub I/O budget       = %u", config->scrubIOBudget);
+  logDebug("Compact cold slabs     = %s",
+           (config->compactColdSlabs ? "on" : "off"));
+  logDebug("NUMA zone binding      = %s",
+           (config->numaBindLogicalZones ? "on" : "off"));
   logDebug("MD RAID5 mode          = %s", (config->mdRaid5ModeEnabled
                                            ? "on" : "off"));
   logDebug("Write policy           = %s", getConfigWritePolicyString(config));
@@ -601,11 +615,18 @@ static int vdoInitialize(struct dm_target *ti,
   // The threadConfig will be copied by the VDO if it's successfully
   // created.
   VDOLoadConfig loadConfig = {
-    .cacheSize      = config->cacheSize,
-    .threadConfig   = NULL,
-    .writePolicy    = config->writePolicy,
-    .compressPolicy = config->compressPolicy,
-    .maximumAge     = config->blockMapMaximumAge,
+    .cacheSize           = config->cacheSize,
+    .threadConfig        = NULL,
+    .writePolicy         = config->writePolicy,
+    .compressPolicy      = config->compressPolicy,
+    .maximumAge          = config->blockMapMaximumAge,
+    .cachePolicy         = config->cachePolicy,
+    .backgroundWriteback = config->backgroundWriteback,
+    .onlineRecovery      = config->onlineRecovery,
+    .lazyRefCountLoad    = config->lazyRefCountLoad,
+    .scrubConcurrency    = config->scrubConcurrency,
+    .scrubIOBudget       = config->scrubIOBudget,
+    .compactColdSlabs    = config->compactColdSlabs,
   };
 
   char        *failureReason;
@@ -93,9 +93,13 @@ void completeAsyncBio(BIO *bio, int error)
   countCompletedBios(bio);
   if ((error == 0) && isData(kvio) && isReadVIO(kvio->vio)) {
     DataKVIO *dataKVIO = kvioAsDataKVIO(kvio);
-    if (!isCompressed(dataKVIO->dataVIO.mapped.state)
-        && !dataKVIO->isPartial) {
-      kvdoAcknowledgeDataVIO(&dataKVIO->dataVIO);
+    DataVIO  *dataVIO  = &dataKVIO->dataVIO;
+    // An optimistic read which may be stale must go back to its logical zone
+    // to be redone rather than being acknowledged.
+    if (!isCompressed(dataVIO->mapped.state) && !dataKVIO->isPartial
+        && (!dataVIO->logical.optimistic
+            || isOptimisticReadCurrent(dataVIO))) {
+      kvdoAcknowledgeDataVIO(dataVIO);
       return;
     }
   }
@@ -142,6 +146,9 @@ static const KvdoWorkQueueType bioQueueType = {
     { .name = "bio_high",
       .code = BIO_Q_ACTION_HIGH,
       .priority = 2 },
+    { .name = "bio_high_data",
+      .code = BIO_Q_ACTION_HIGH_DATA,
+      .priority = 1 },
     { .name = "bio_metadata",
       .code = BIO_Q_ACTION_METADATA,
       .priority = 1 },
@@ -60,6 +60,9 @@ static const KvdoWorkQueueType bioAckQType = {
     { .name = "bio_ack",
       .code = BIO_ACK_Q_ACTION_ACK,
       .priority = 0 },
+    { .name = "bio_ack_high",
+      .code = BIO_ACK_Q_ACTION_HIGH_ACK,
+      .priority = 1 },
   },
 };
 
@@ -74,6 +77,9 @@ static const KvdoWorkQueueType cpuQType = {
     { .name = "cpu_hash_block",
       .code = CPU_Q_ACTION_HASH_BLOCK,
       .priority = 0 },
+    { .name = "cpu_high_data",
+      .code = CPU_Q_ACTION_HIGH_DATA,
+      .priority = 1 },
     { .name = "cpu_event_reporter",
       .code = CPU_Q_ACTION_EVENT_REPORTER,
       .priority = 0 },
@@ -156,6 +162,44 @@ void waitForNoRequestsActive(KernelLayer *layer)
   }
 }
 
+/**
+ * Check whether a bio belongs to the bulk QoS class, and so must also hold a
+ * permit from the bulk limiter.
+ *
+ * @param layer  The kernel layer
+ * @param bio    The bio to check
+ *
+ * @return <code>true</code> if the bio is bulk traffic
+ **/
+static inline bool isBulkBio(KernelLayer *layer, BIO *bio)
+{
+  return (getBioQoSClass(bio, layer->deviceConfig->defaultQoSClass)
+          == QOS_CLASS_BULK);
+}
+
+/**
+ * Block a write or discard bio until the VDO will accept writes. While the
+ * block map is recovered in the background, only reads are served; writes
+ * wait here, before they take any permits or locks, so that they can not get
+ * in the way of the reads.
+ *
+ * @param layer  The kernel layer
+ * @param bio    The bio being submitted
+ **/
+static void waitForHeldWrites(KernelLayer *layer, BIO *bio)
+{
+  if (isReadBio(bio)) {
+    return;
+  }
+
+  VDO *vdo = getVDO(&layer->kvdo);
+  // Using the "interruptible" interface means that Linux will not log a
+  // message when we wait for more than 120 seconds.
+  while (wait_event_interruptible(layer->heldWritesWaiters,
+                                  !areVDOWritesHeld(vdo)) != 0) {
+  }
+}
+
 /**
  * Start processing a new data KVIO based on the supplied bio, but from within
  * a VDO thread context, when we're not allowed to block. Using this path at
@@ -165,9 +209,9 @@ void waitForNoRequestsActive(KernelLayer *layer)
  * processing other requests.
  *
  * If a request permit can be acquired immediately, kvdoLaunchDataKVIOFromBio
- * will be called. (If the bio is a discard operation, a permit from the
- * discard limiter will be requested but the call will be made with or without
- * it.) If the request permit is not available, the bio will be saved on a list
+ * will be called. (If the bio is a discard operation or bulk traffic, a permit
+ * from the discard or bulk limiter will be requested but the call will be made
+ * with or without it.) If the request permit is not available, the bio will be saved on a list
  * to be launched later. Either way, this function will not block, and will
  * take responsibility for processing the bio.
  *
@@ -215,8 +259,10 @@ static int launchDataKVIOFromVDOThread(KernelLayer *layer,
 
   bool hasDiscardPermit
     = (isDiscardBio(bio) && limiterPoll(&layer->discardLimiter));
+  bool hasBulkPermit = (isBulkBio(layer, bio)
+                        && limiterPoll(&layer->bulkLimiter));
   int result = kvdoLaunchDataKVIOFromBio(layer, bio, arrivalTime,
-                                         hasDiscardPermit);
+                                         hasDiscardPermit, hasBulkPermit);
   // Succeed or fail, kvdoLaunchDataKVIOFromBio owns the permit(s) now.
   if (result != VDO_SUCCESS) {
     return result;
@@ -274,15 +320,22 @@ int kvdoMapBio(KernelLayer *layer, BIO *bio)
      */
     return launchDataKVIOFromVDOThread(layer, bio, arrivalTime);
   }
+  waitForHeldWrites(layer, bio);
   bool hasDiscardPermit = false;
   if (isDiscardBio(bio)) {
     limiterWaitForOneFree(&layer->discardLimiter);
     hasDiscardPermit = true;
   }
+  // Bulk traffic may only occupy a fraction of the request permits.
+  bool hasBulkPermit = false;
+  if (isBulkBio(layer, bio)) {
+    limiterWaitForOneFree(&layer->bulkLimiter);
+    hasBulkPermit = true;
+  }
   limiterWaitForOneFree(&layer->requestLimiter);
 
   int result = kvdoLaunchDataKVIOFromBio(layer, bio, arrivalTime,
-                                         hasDiscardPermit);
+                                         hasDiscardPermit, hasBulkPermit);
   // Succeed or fail, kvdoLaunchDataKVIOFromBio owns the permit(s) now.
   if (result != VDO_SUCCESS) {
     return result;
@@ -310,8 +363,10 @@ void completeManyRequests(KernelLayer *layer, uint32_t count)
 
     bool hasDiscardPermit
       = (isDiscardBio(bio) && limiterPoll(&layer->discardLimiter));
+    bool hasBulkPermit = (isBulkBio(layer, bio)
+                          && limiterPoll(&layer->bulkLimiter));
     int result = kvdoLaunchDataKVIOFromBio(layer, bio, arrivalTime,
-                                           hasDiscardPermit);
+                                           hasDiscardPermit, hasBulkPermit);
     if (result != VDO_SUCCESS) {
       completeBio(bio, result);
     }
@@ -546,6 +601,19 @@ static void kvdoCompleteSyncOperation(PhysicalLayer *common)
   complete(&layer->callbackSync);
 }
 
+/**
+ * Wake the writes which were held while the VDO recovered its block map.
+ *
+ * <p>Implements HeldWritesReleaser.
+ *
+ * @param common  The kernel layer
+ **/
+static void kvdoReleaseHeldWrites(PhysicalLayer *common)
+{
+  KernelLayer *layer = asKernelLayer(common);
+  wake_up_all(&layer->heldWritesWaiters);
+}
+
 /**
  * Wait for a synchronous operation to complete.
  *
@@ -670,6 +738,8 @@ int makeKernelLayer(uint64_t        startingSector,
   int requestLimit = defaultMaxRequestsActive;
   initializeLimiter(&layer->requestLimiter, requestLimit);
   initializeLimiter(&layer->discardLimiter, requestLimit * 3 / 4);
+  initializeLimiter(&layer->bulkLimiter, requestLimit / 2);
+  init_waitqueue_head(&layer->heldWritesWaiters);
 
   layer->allocationsAllowed   = true;
   layer->instance             = instance;
@@ -686,7 +756,9 @@ int makeKernelLayer(uint64_t        startingSector,
   layer->common.enqueue                  = kvdoEnqueue;
   layer->common.waitForAdminOperation    = waitForSyncOperation;
   layer->common.completeAdminOperation   = kvdoCompleteSyncOperation;
+  layer->common.releaseHeldWrites        = kvdoReleaseHeldWrites;
   layer->common.getCurrentThreadID       = kvdoGetCurrentThreadID;
+  layer->common.getThreadNode            = kvdoGetThreadNode;
   layer->common.zeroDataVIO              = kvdoZeroDataVIO;
   layer->common.compareDataVIOs          = kvdoCompareDataVIOs;
   layer->common.copyData                 = kvdoCopyDataVIO;
@@ -708,6 +780,20 @@ int makeKernelLayer(uint64_t        startingSector,
   mutex_init(&layer->statsMutex);
   bio_list_init(&layer->waitingFlushes);
 
+  result = enableLimiterPermitCache(&layer->requestLimiter);
+  if (result != VDO_SUCCESS) {
+    *reason = "Cannot allocate request permit caches";
+    freeKernelLayer(layer);
+    return result;
+  }
+
+  result = makeQoSLatencyHistograms(&layer->kobj, &layer->qosLatency);
+  if (result != VDO_SUCCESS) {
+    *reason = "Cannot allocate QoS latency histograms";
+    freeKernelLayer(layer);
+    return result;
+  }
+
   result = addLayerToDeviceRegistry(config->poolName, layer);
   if (result != VDO_SUCCESS) {
     *reason = "Cannot add layer to device registry";
@@ -853,7 +939,8 @@ int makeKernelLayer(uint64_t        startingSector,
    */
 
   // Base-code thread, etc
-  result = initializeKVDO(&layer->kvdo, *threadConfigPointer, reason);
+  result = initializeKVDO(&layer->kvdo, *threadConfigPointer,
+                          config->numaBindLogicalZones, reason);
   if (result != VDO_SUCCESS) {
     freeKernelLayer(layer);
     return result;
@@ -939,6 +1026,46 @@ int prepareToModifyKernelLayer(KernelLayer       *layer,
     return VDO_PARAMETER_MISMATCH;
   }
 
+  if (config->cachePolicy != extantConfig->cachePolicy) {
+    *errorPtr = "Block map cache policy cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->backgroundWriteback != extantConfig->backgroundWriteback) {
+    *errorPtr = "Block map writeback mode cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->onlineRecovery != extantConfig->onlineRecovery) {
+    *errorPtr = "Online recovery mode cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->lazyRefCountLoad != extantConfig->lazyRefCountLoad) {
+    *errorPtr = "Lazy reference count loading cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->scrubConcurrency != extantConfig->scrubConcurrency) {
+    *errorPtr = "Scrub concurrency cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->scrubIOBudget != extantConfig->scrubIOBudget) {
+    *errorPtr = "Scrub I/O budget cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->compactColdSlabs != extantConfig->compactColdSlabs) {
+    *errorPtr = "Cold slab compaction cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
+  if (config->numaBindLogicalZones != extantConfig->numaBindLogicalZones) {
+    *errorPtr = "NUMA binding of logical zones cannot change";
+    return VDO_PARAMETER_MISMATCH;
+  }
+
   if (config->mdRaid5ModeEnabled != extantConfig->mdRaid5ModeEnabled) {
     *errorPtr = "mdRaid5Mode cannot change";
     return VDO_PARAMETER_MISMATCH;
@@ -1015,6 +1142,13 @@ int modifyKernelLayer(KernelLayer  *layer,
     setCompressPolicy(layer->kvdo.vdo, config->compressPolicy);
   }
 
+  if (config->defaultQoSClass != extantConfig->defaultQoSClass) {
+    // The new class applies once the new config replaces the extant one.
+    logInfo("Modifying device '%s' default QoS class from %s to %s",
+            config->poolName, getQoSClassName(extantConfig->defaultQoSClass),
+            getQoSClassName(config->defaultQoSClass));
+  }
+
   if (config->owningTarget->len != extantConfig->owningTarget->len) {
     size_t logicalBytes = to_bytes(config->owningTarget->len);
     int result = resizeLogical(layer, logicalBytes / VDO_BLOCK_SIZE);
@@ -1100,6 +1234,8 @@ void freeKernelLayer(KernelLayer *layer)
     FREE(layer->spareKVDOFlush);
     layer->spareKVDOFlush = NULL;
     freeBatchProcessor(&layer->dataKVIOReleaser);
+    uninitializeLimiter(&layer->requestLimiter);
+    freeQoSLatencyHistograms(&layer->qosLatency);
     removeLayerFromDeviceRegistry(layer->deviceConfig->poolName);
     qat_fini();
     zlib_fini();
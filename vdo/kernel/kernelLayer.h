@@ -42,6 +42,7 @@
 #include "kernelVDO.h"
 #include "ktrace.h"
 #include "limiter.h"
+#include "qos.h"
 #include "statistics.h"
 #include "workQueue.h"
 
@@ -122,6 +123,10 @@ struct kernelLayer {
   /** Limit the number of requests that are being processed. */
   Limiter                 requestLimiter;
   Limiter                 discardLimiter;
+  /** Limit the share of requests which bulk-class traffic may occupy. */
+  Limiter                 bulkLimiter;
+  /** Writes waiting for an online recovery to finish. */
+  wait_queue_head_t       heldWritesWaiters;
   KVDO                    kvdo;
   /** Incoming bios we've had to buffer to avoid deadlock. */
   DeadlockQueue           deadlockQueue;
@@ -175,6 +180,7 @@ struct kernelLayer {
   AtomicBioStats          biosPageCache;
   AtomicBioStats          biosJournalCompleted;
   AtomicBioStats          biosPageCacheCompleted;
+  QoSLatencyHistograms    qosLatency;
   // for reporting Albireo timeouts
   PeriodicEventReporter   albireoTimeoutReporter;
   // Debugging
@@ -216,6 +222,7 @@ typedef enum bioQAction {
   BIO_Q_ACTION_DATA,
   BIO_Q_ACTION_FLUSH,
   BIO_Q_ACTION_HIGH,
+  BIO_Q_ACTION_HIGH_DATA,
   BIO_Q_ACTION_METADATA,
   BIO_Q_ACTION_READCACHE,
   BIO_Q_ACTION_VERIFY
@@ -226,10 +233,12 @@ typedef enum cpuQAction {
   CPU_Q_ACTION_COMPRESS_BLOCK,
   CPU_Q_ACTION_EVENT_REPORTER,
   CPU_Q_ACTION_HASH_BLOCK,
+  CPU_Q_ACTION_HIGH_DATA,
 } CPUQAction;
 
 typedef enum bioAckQAction {
   BIO_ACK_Q_ACTION_ACK,
+  BIO_ACK_Q_ACTION_HIGH_ACK,
 } BioAckQAction;
 
 typedef void (*DedupeShutdownCallbackFunction)(KernelLayer *layer);
@@ -45,6 +45,10 @@ typedef struct {
   uint64_t biosUsed;
   /** Maximum number of bios allocated. */
   uint64_t peakBioCount;
+  /** Bytes of large regions in physically contiguous, huge-mapped memory. */
+  uint64_t contiguousBytesUsed;
+  /** Bytes of large regions which fell back to page-mapped memory. */
+  uint64_t fallbackBytesUsed;
 } MemoryUsage;
 
 /** UDS index statistics */
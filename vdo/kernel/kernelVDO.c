@@ -22,6 +22,8 @@
 #include "kernelVDOInternals.h"
 
 #include <linux/delay.h>
+#include <linux/nodemask.h>
+#include <linux/topology.h>
 
 #include "memoryAlloc.h"
 
@@ -69,6 +71,9 @@ static const KvdoWorkQueueType requestQueueType = {
     { .name = "req_flush",
       .code = REQ_Q_ACTION_FLUSH,
       .priority = 2 },
+    { .name = "req_high_map_bio",
+      .code = REQ_Q_ACTION_HIGH_MAP_BIO,
+      .priority = 1 },
     { .name = "req_map_bio",
       .code = REQ_Q_ACTION_MAP_BIO,
       .priority = 0 },
@@ -81,9 +86,45 @@ static const KvdoWorkQueueType requestQueueType = {
   },
 };
 
+/**
+ * Spread the logical zone threads round-robin across the NUMA nodes which
+ * have CPUs, so that each zone's block map cache can be allocated on the node
+ * which uses it. Memory-only nodes could not run the threads, so they are
+ * skipped. Nothing is bound if fewer than two nodes have CPUs.
+ *
+ * @param kvdo          The KVDO whose threads have been created
+ * @param threadConfig  The thread configuration of the VDO
+ **/
+static void bindLogicalZoneThreads(KVDO *kvdo, const ThreadConfig *threadConfig)
+{
+  nodemask_t cpuNodes = NODE_MASK_NONE;
+  int        node;
+  for_each_node_state(node, N_CPU) {
+    if (!cpumask_empty(cpumask_of_node(node))) {
+      node_set(node, cpuNodes);
+    }
+  }
+
+  if (nodes_weight(cpuNodes) < 2) {
+    return;
+  }
+
+  node = first_node(cpuNodes);
+  for (ZoneCount zone = 0; zone < threadConfig->logicalZoneCount; zone++) {
+    KVDOThread *thread = &kvdo->threads[threadConfig->logicalThreads[zone]];
+    thread->node = node;
+    bindWorkQueueToNode(thread->requestQueue, node);
+    node = next_node(node, cpuNodes);
+    if (node == MAX_NUMNODES) {
+      node = first_node(cpuNodes);
+    }
+  }
+}
+
 /**********************************************************************/
 int initializeKVDO(KVDO                *kvdo,
                    const ThreadConfig  *threadConfig,
+                   bool                 bindZones,
                    char               **reason)
 {
   unsigned int baseThreads = threadConfig->baseThreadCount;
@@ -124,6 +165,14 @@ int initializeKVDO(KVDO                *kvdo,
     }
 
   }
+
+  for (ThreadID id = 0; id < kvdo->initializedThreadCount; id++) {
+    kvdo->threads[id].node = ANY_MEMORY_NODE;
+  }
+
+  if (bindZones) {
+    bindLogicalZoneThreads(kvdo, threadConfig);
+  }
   return VDO_SUCCESS;
 }
 
@@ -508,6 +557,16 @@ void kvdoEnqueue(Enqueueable *enqueueable)
                         &kvdoEnqueueable->workItem);
 }
 
+/**********************************************************************/
+int kvdoGetThreadNode(PhysicalLayer *common, ThreadID threadID)
+{
+  KVDO *kvdo = &asKernelLayer(common)->kvdo;
+  if (threadID >= kvdo->initializedThreadCount) {
+    return ANY_MEMORY_NODE;
+  }
+  return kvdo->threads[threadID].node;
+}
+
 /**********************************************************************/
 ThreadID kvdoGetCurrentThreadID(void)
 {
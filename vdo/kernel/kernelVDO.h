@@ -32,6 +32,8 @@ typedef struct {
   ThreadID           threadID;
   KvdoWorkQueue     *requestQueue;
   RegisteredThread   allocatingThread;
+  /** The NUMA node the thread is bound to, or ANY_MEMORY_NODE */
+  int                node;
 } KVDOThread;
 
 struct kvdo {
@@ -47,6 +49,7 @@ struct kvdo {
 typedef enum reqQAction {
   REQ_Q_ACTION_COMPLETION,
   REQ_Q_ACTION_FLUSH,
+  REQ_Q_ACTION_HIGH_MAP_BIO,
   REQ_Q_ACTION_MAP_BIO,
   REQ_Q_ACTION_SYNC,
   REQ_Q_ACTION_VIO_CALLBACK
@@ -57,12 +60,15 @@ typedef enum reqQAction {
  *
  * @param [in]  kvdo          The KVDO to be initialized
  * @param [in]  threadConfig  The base-code thread configuration
+ * @param [in]  bindZones     Whether to bind the logical zone threads to
+ *                            NUMA nodes
  * @param [out] reason        The reason for failure
  *
  * @return  VDO_SUCCESS or an error code
  **/
 int initializeKVDO(KVDO                *kvdo,
                    const ThreadConfig  *threadConfig,
+                   bool                 bindZones,
                    char               **reason);
 
 /**
@@ -279,6 +285,17 @@ void kvdoEnqueue(Enqueueable *enqueueable);
  **/
 ThreadID kvdoGetCurrentThreadID(void);
 
+/**
+ * Get the NUMA node to which a base-code thread is bound. Implements
+ * ThreadNodeGetter.
+ *
+ * @param common    The physical layer
+ * @param threadID  The ID of the thread
+ *
+ * @return The node of the thread, or ANY_MEMORY_NODE if it is not bound
+ **/
+int kvdoGetThreadNode(PhysicalLayer *common, ThreadID threadID);
+
 /**
  * Do one-time initialization of kernelVDO interface.
  **/
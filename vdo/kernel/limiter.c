@@ -23,13 +23,43 @@
 
 #include <linux/sched.h>
 
+#include "statusCodes.h"
+
+enum {
+  /** The largest number of permits moved into a CPU's cache at once */
+  MAXIMUM_PERMIT_BATCH = 32,
+  /** The smallest batch for which per-CPU caching is worthwhile */
+  MINIMUM_PERMIT_BATCH = 2,
+};
+
+/**
+ * Get the number of permits which are actually in use: those the limiter has
+ * handed out, less those sitting in a per-CPU cache. A permit taken from a
+ * cache is counted as held before it leaves the cache, and permits going back
+ * to the limiter leave the cached count under the lock, so this never counts
+ * a held permit as idle.
+ *
+ * The limiter's lock must already be locked.
+ *
+ * @param limiter  The limiter
+ *
+ * @return The number of permits in use
+ **/
+static uint32_t getHeldPermitsLocked(Limiter *limiter)
+{
+  // A failed attempt to take a cached permit may briefly make this negative.
+  int cached = max(atomic_read(&limiter->cachedPermits), 0);
+  return ((limiter->active > (uint32_t) cached)
+          ? (limiter->active - cached) : 0);
+}
+
 /**********************************************************************/
 void getLimiterValuesAtomically(Limiter  *limiter,
                                 uint32_t *active,
                                 uint32_t *maximum)
 {
   spin_lock(&limiter->lock);
-  *active  = limiter->active;
+  *active  = getHeldPermitsLocked(limiter);
   *maximum = limiter->maximum;
   spin_unlock(&limiter->lock);
 }
@@ -37,36 +67,213 @@ void getLimiterValuesAtomically(Limiter  *limiter,
 /**********************************************************************/
 void initializeLimiter(Limiter *limiter, uint32_t limit)
 {
-  limiter->active  = 0;
-  limiter->limit   = limit;
-  limiter->maximum = 0;
+  limiter->active      = 0;
+  limiter->limit       = limit;
+  limiter->maximum     = 0;
+  limiter->permitCache = NULL;
+  limiter->batchSize   = 0;
+  limiter->reserve     = 0;
+  atomic_set(&limiter->cachedPermits, 0);
+  atomic_set(&limiter->drainers, 0);
   init_waitqueue_head(&limiter->waiterQueue);
   spin_lock_init(&limiter->lock);
 }
 
+/**********************************************************************/
+int enableLimiterPermitCache(Limiter *limiter)
+{
+  // A cache may hold up to two batches, so never let more than a quarter of
+  // the permits sit idle in caches.
+  uint32_t cpus      = num_possible_cpus();
+  uint32_t batchSize = min((uint32_t) MAXIMUM_PERMIT_BATCH,
+                           limiter->limit / (8 * cpus));
+  if (batchSize < MINIMUM_PERMIT_BATCH) {
+    return VDO_SUCCESS;
+  }
+
+  limiter->permitCache = alloc_percpu(atomic_t);
+  if (limiter->permitCache == NULL) {
+    return -ENOMEM;
+  }
+
+  int cpu;
+  for_each_possible_cpu(cpu) {
+    atomic_set(per_cpu_ptr(limiter->permitCache, cpu), 0);
+  }
+  limiter->batchSize = batchSize;
+  limiter->reserve   = batchSize * cpus;
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void uninitializeLimiter(Limiter *limiter)
+{
+  if (limiter->permitCache != NULL) {
+    free_percpu(limiter->permitCache);
+    limiter->permitCache = NULL;
+  }
+}
+
 /**********************************************************************/
 bool limiterIsIdle(Limiter *limiter)
 {
   spin_lock(&limiter->lock);
-  bool idle = limiter->active == 0;
+  bool idle = (getHeldPermitsLocked(limiter) == 0);
   spin_unlock(&limiter->lock);
   return idle;
 }
 
-/**********************************************************************/
-void limiterReleaseMany(Limiter *limiter, uint32_t count)
+/**
+ * Remove all but some number of permits from a per-CPU cache.
+ *
+ * @param cache  The cache
+ * @param keep   The number of permits to leave in the cache
+ *
+ * @return The number of permits removed
+ **/
+static uint32_t takeCachedPermits(atomic_t *cache, uint32_t keep)
+{
+  int cached = atomic_read(cache);
+  while (cached > (int) keep) {
+    int old = atomic_cmpxchg(cache, cached, keep);
+    if (old == cached) {
+      return cached - keep;
+    }
+    cached = old;
+  }
+  return 0;
+}
+
+/**
+ * Return permits directly to the limiter, waking any waiters.
+ *
+ * @param limiter  The limiter
+ * @param count    The number of permits to return
+ * @param cached   Whether the permits were taken from a per-CPU cache
+ **/
+static void returnPermits(Limiter *limiter, uint32_t count, bool cached)
 {
   spin_lock(&limiter->lock);
   limiter->active -= count;
+  if (cached) {
+    atomic_sub(count, &limiter->cachedPermits);
+  }
   spin_unlock(&limiter->lock);
   if (waitqueue_active(&limiter->waiterQueue)) {
     wake_up_nr(&limiter->waiterQueue, count);
   }
 }
 
+/**
+ * Put permits into the current CPU's cache. If the cache has grown too
+ * large, or if some thread is draining the caches, the surplus is returned
+ * to the limiter instead.
+ *
+ * The add to the cache and the subsequent check of the drainer count are
+ * both fully ordered, as are the increment of the drainer count and the
+ * subsequent sweep in startDraining(), so either the drainer finds these
+ * permits in the cache or this thread sees the drainer.
+ *
+ * @param limiter  The limiter, which must have caching enabled
+ * @param count    The number of permits to cache, which must already be
+ *                 included in the limiter's count of cached permits
+ **/
+static void cachePermits(Limiter *limiter, uint32_t count)
+{
+  atomic_t *cache  = get_cpu_ptr(limiter->permitCache);
+  int       cached = atomic_add_return(count, cache);
+  uint32_t  excess = 0;
+  if (atomic_read(&limiter->drainers) > 0) {
+    excess = takeCachedPermits(cache, 0);
+  } else if (cached > (int) (2 * limiter->batchSize)) {
+    excess = takeCachedPermits(cache, limiter->batchSize);
+  }
+  put_cpu_ptr(limiter->permitCache);
+
+  if (excess > 0) {
+    returnPermits(limiter, excess, true);
+  }
+}
+
+/**
+ * Try to take one permit from the current CPU's cache.
+ *
+ * @param limiter  The limiter
+ *
+ * @return  true iff a cached permit was taken
+ **/
+static bool takeCachedPermit(Limiter *limiter)
+{
+  if (limiter->permitCache == NULL) {
+    return false;
+  }
+
+  // Count the permit as held before it leaves the cache, so that it is never
+  // missed by limiterIsIdle().
+  atomic_dec(&limiter->cachedPermits);
+  atomic_t *cache = get_cpu_ptr(limiter->permitCache);
+  bool taken = (atomic_dec_if_positive(cache) >= 0);
+  put_cpu_ptr(limiter->permitCache);
+  if (!taken) {
+    atomic_inc(&limiter->cachedPermits);
+  }
+  return taken;
+}
+
+/**
+ * Note that this thread needs every outstanding permit to come back to the
+ * limiter, and sweep all the per-CPU caches. Until the matching call to
+ * stopDraining(), released permits bypass the caches and caches are not
+ * refilled.
+ *
+ * @param limiter  The limiter
+ **/
+static void startDraining(Limiter *limiter)
+{
+  if (limiter->permitCache == NULL) {
+    return;
+  }
+
+  // atomic_inc_return() implies a full memory barrier.
+  atomic_inc_return(&limiter->drainers);
+  uint32_t drained = 0;
+  int cpu;
+  for_each_possible_cpu(cpu) {
+    drained += takeCachedPermits(per_cpu_ptr(limiter->permitCache, cpu), 0);
+  }
+  if (drained > 0) {
+    returnPermits(limiter, drained, true);
+  }
+}
+
+/**
+ * Allow the per-CPU caches to be used again.
+ *
+ * @param limiter  The limiter
+ **/
+static void stopDraining(Limiter *limiter)
+{
+  if (limiter->permitCache != NULL) {
+    atomic_dec(&limiter->drainers);
+  }
+}
+
+/**********************************************************************/
+void limiterReleaseMany(Limiter *limiter, uint32_t count)
+{
+  if (limiter->permitCache != NULL) {
+    atomic_add(count, &limiter->cachedPermits);
+    cachePermits(limiter, count);
+    return;
+  }
+
+  returnPermits(limiter, count, false);
+}
+
 /**********************************************************************/
 void limiterWaitForIdle(Limiter *limiter)
 {
+  startDraining(limiter);
   spin_lock(&limiter->lock);
   while (limiter->active > 0) {
     DEFINE_WAIT(wait);
@@ -78,35 +285,83 @@ void limiterWaitForIdle(Limiter *limiter)
     finish_wait(&limiter->waiterQueue, &wait);
   };
   spin_unlock(&limiter->lock);
+  stopDraining(limiter);
 }
 
 /**
- * Take one permit from the limiter, if one is available, and update
- * the maximum active count if appropriate.
+ * Take permits from the limiter, if any are available, and update the
+ * maximum active count if appropriate. Normally only one permit is taken,
+ * but if caching is enabled, no thread is draining the caches, and the
+ * limiter is not close to exhaustion, a whole batch is taken so that the
+ * surplus can be cached. The surplus is counted as cached at once. The
+ * maximum counts only the permits which are not in a cache. It is only
+ * sampled when permits are taken from the limiter itself, not from a cache,
+ * so it may slightly understate the true peak.
  *
  * The limiter's lock must already be locked.
  *
  * @param limiter  The limiter to update
  *
- * @return  true iff the permit was acquired
+ * @return  the number of permits acquired
  **/
-static bool takePermitLocked(Limiter *limiter)
+static uint32_t takePermitsLocked(Limiter *limiter)
 {
   if (limiter->active >= limiter->limit) {
-    return false;
+    return 0;
+  }
+
+  uint32_t count = 1;
+  if ((limiter->permitCache != NULL)
+      && (atomic_read(&limiter->drainers) == 0)
+      && ((limiter->limit - limiter->active)
+          >= limiter->reserve + limiter->batchSize)) {
+    count = limiter->batchSize;
+  }
+
+  limiter->active += count;
+  if (count > 1) {
+    atomic_add(count - 1, &limiter->cachedPermits);
   }
-  limiter->active += 1;
-  if (limiter->active > limiter->maximum) {
-    limiter->maximum = limiter->active;
+
+  uint32_t held = getHeldPermitsLocked(limiter);
+  if (held > limiter->maximum) {
+    limiter->maximum = held;
+  }
+  return count;
+}
+
+/**
+ * Cache any permits taken from the limiter beyond the one being used.
+ *
+ * @param limiter  The limiter
+ * @param count    The number of permits taken
+ **/
+static void cacheSurplusPermits(Limiter *limiter, uint32_t count)
+{
+  if (count > 1) {
+    cachePermits(limiter, count - 1);
   }
-  return true;
 }
 
 /**********************************************************************/
 void limiterWaitForOneFree(Limiter *limiter)
 {
+  if (takeCachedPermit(limiter)) {
+    return;
+  }
+
   spin_lock(&limiter->lock);
-  while (!takePermitLocked(limiter)) {
+  uint32_t count = takePermitsLocked(limiter);
+  spin_unlock(&limiter->lock);
+  if (count > 0) {
+    cacheSurplusPermits(limiter, count);
+    return;
+  }
+
+  // Pull back any permits stranded in other CPUs' caches before sleeping.
+  startDraining(limiter);
+  spin_lock(&limiter->lock);
+  while (takePermitsLocked(limiter) == 0) {
     DEFINE_WAIT(wait);
     prepare_to_wait_exclusive(&limiter->waiterQueue, &wait,
                               TASK_UNINTERRUPTIBLE);
@@ -116,13 +371,27 @@ void limiterWaitForOneFree(Limiter *limiter)
     finish_wait(&limiter->waiterQueue, &wait);
   };
   spin_unlock(&limiter->lock);
+  stopDraining(limiter);
 }
 
 /**********************************************************************/
 bool limiterPoll(Limiter *limiter)
 {
+  if (takeCachedPermit(limiter)) {
+    return true;
+  }
+
   spin_lock(&limiter->lock);
-  bool acquired = takePermitLocked(limiter);
+  uint32_t count = takePermitsLocked(limiter);
   spin_unlock(&limiter->lock);
-  return acquired;
+  if ((count == 0) && (limiter->permitCache != NULL)) {
+    // Other CPUs may be holding permits; sweeping the caches doesn't block.
+    startDraining(limiter);
+    spin_lock(&limiter->lock);
+    count = takePermitsLocked(limiter);
+    spin_unlock(&limiter->lock);
+    stopDraining(limiter);
+  }
+  cacheSurplusPermits(limiter, count);
+  return (count > 0);
 }
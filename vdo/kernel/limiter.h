@@ -22,12 +22,22 @@
 #ifndef LIMITER_H
 #define LIMITER_H
 
+#include <linux/atomic.h>
+#include <linux/percpu.h>
 #include <linux/wait.h>
 
 /*
  * A Limiter is a fancy counter used to limit resource usage.  We have a
  * limit to number of resources that we are willing to use, and a Limiter
  * holds us to that limit.
+ *
+ * A Limiter may optionally keep a per-CPU cache of permits.  Permits are moved
+ * between the limiter and a CPU's cache in batches, so that most acquisitions
+ * and releases only touch a counter local to the current CPU.  Cached permits
+ * are counted as active by the limiter itself.  When the limiter is close to
+ * exhaustion, or when some thread has to wait (for a permit or for the
+ * limiter to become idle), the caches are drained and all permits flow
+ * through the limiter directly.
  */
 
 typedef struct limiter {
@@ -35,12 +45,23 @@ typedef struct limiter {
   spinlock_t        lock;
   // The queue of threads waiting for a resource to become available
   wait_queue_head_t waiterQueue;
-  // The number of resources in use
+  // The number of resources in use, including permits in per-CPU caches
   uint32_t          active;
-  // The maximum number number of resources that have ever been in use
+  // The maximum number of resources that have ever been in use, not counting
+  // permits in per-CPU caches
   uint32_t          maximum;
   // The limit to the number of resources that are allowed to be used
   uint32_t          limit;
+  // The per-CPU permit caches, or NULL if caching is not enabled
+  atomic_t __percpu *permitCache;
+  // The number of permits in per-CPU caches or on their way into one
+  atomic_t          cachedPermits;
+  // The number of permits moved into a per-CPU cache at a time
+  uint32_t          batchSize;
+  // The number of free permits below which caches are not refilled
+  uint32_t          reserve;
+  // The number of threads which need all cached permits to be returned
+  atomic_t          drainers;
 } Limiter;
 
 /**
@@ -62,6 +83,25 @@ void getLimiterValuesAtomically(Limiter  *limiter,
  **/
 void initializeLimiter(Limiter *limiter, uint32_t limit);
 
+/**
+ * Enable per-CPU permit caching for a Limiter. The limit of a limiter with
+ * caching enabled must not be changed. If the limit is too small to usefully
+ * spread across the CPUs, caching is silently left disabled.
+ *
+ * @param limiter  The limiter
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+int enableLimiterPermitCache(Limiter *limiter)
+  __attribute__((warn_unused_result));
+
+/**
+ * Free any resources allocated for a Limiter. No permits may be in use.
+ *
+ * @param limiter  The limiter
+ **/
+void uninitializeLimiter(Limiter *limiter);
+
 /**
  * Determine whether there are any active resources
  *
@@ -31,6 +31,8 @@ MemoryUsage getMemoryUsage()
   MemoryUsage memoryUsage;
   getMemoryStats(&memoryUsage.bytesUsed, &memoryUsage.peakBytesUsed,
                  &memoryUsage.biosUsed, &memoryUsage.peakBioCount);
+  getLargeMemoryStats(&memoryUsage.contiguousBytesUsed,
+                      &memoryUsage.fallbackBytesUsed);
   return memoryUsage;
 }
 
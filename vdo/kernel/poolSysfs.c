@@ -111,7 +111,9 @@ static ssize_t poolInstanceShow(KernelLayer *layer, char *buf)
 /**********************************************************************/
 static ssize_t poolRequestsActiveShow(KernelLayer *layer, char *buf)
 {
-  return sprintf(buf, "%" PRIu32 "\n", layer->requestLimiter.active);
+  uint32_t active, maximum;
+  getLimiterValuesAtomically(&layer->requestLimiter, &active, &maximum);
+  return sprintf(buf, "%" PRIu32 "\n", active);
 }
 
 /**********************************************************************/
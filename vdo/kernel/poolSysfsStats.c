@@ -372,6 +372,40 @@ static PoolStatsAttribute poolStatsAllocatorSlabsReopenedAttr = {
   .show  = poolStatsAllocatorSlabsReopenedShow,
 };
 
+/**********************************************************************/
+/** The number of allocations which continued a sequential logical run */
+static ssize_t poolStatsAllocatorSequentialAllocationsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.allocator.sequentialAllocations);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsAllocatorSequentialAllocationsAttr = {
+  .attr  = { .name = "allocator_sequential_allocations", .mode = 0444, },
+  .show  = poolStatsAllocatorSequentialAllocationsShow,
+};
+
+/**********************************************************************/
+/** The number of those allocations which were physically contiguous */
+static ssize_t poolStatsAllocatorContiguousAllocationsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.allocator.contiguousAllocations);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsAllocatorContiguousAllocationsAttr = {
+  .attr  = { .name = "allocator_contiguous_allocations", .mode = 0444, },
+  .show  = poolStatsAllocatorContiguousAllocationsShow,
+};
+
 /**********************************************************************/
 /** Number of times the on-disk journal was full */
 static ssize_t poolStatsJournalDiskFullShow(KernelLayer *layer, char *buf)
@@ -508,6 +542,269 @@ static PoolStatsAttribute poolStatsJournalBlocksCommittedAttr = {
   .show  = poolStatsJournalBlocksCommittedShow,
 };
 
+/**********************************************************************/
+/** Number of partial block commits delayed to gather more entries */
+static ssize_t poolStatsJournalGroupCommitsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.journal.groupCommits);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsJournalGroupCommitsAttr = {
+  .attr  = { .name = "journal_group_commits", .mode = 0444, },
+  .show  = poolStatsJournalGroupCommitsShow,
+};
+
+/**********************************************************************/
+/** Number of entries not made because a write would not change a mapping */
+static ssize_t poolStatsJournalEntriesElidedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.journal.entriesElided);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsJournalEntriesElidedAttr = {
+  .attr  = { .name = "journal_entries_elided", .mode = 0444, },
+  .show  = poolStatsJournalEntriesElidedShow,
+};
+
+/**********************************************************************/
+/** Number of times the journal heads were advanced */
+static ssize_t poolStatsJournalReapsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.journal.reaps);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsJournalReapsAttr = {
+  .attr  = { .name = "journal_reaps", .mode = 0444, },
+  .show  = poolStatsJournalReapsShow,
+};
+
+/**********************************************************************/
+/** Number of flushes issued before advancing the journal heads */
+static ssize_t poolStatsJournalReapFlushesShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.journal.reapFlushes);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsJournalReapFlushesAttr = {
+  .attr  = { .name = "journal_reap_flushes", .mode = 0444, },
+  .show  = poolStatsJournalReapFlushesShow,
+};
+
+/**********************************************************************/
+/** Commits by entry count; bucket i counts [2^i, 2^(i+1)), from 1 */
+static ssize_t poolStatsJournalEntriesPerCommitShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval = 0;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  for (unsigned int i = 0; i < JOURNAL_HISTOGRAM_BUCKETS; i++) {
+    retval += sprintf(buf + retval, "%s%" PRIu64, ((i == 0) ? "" : " "),
+                      layer->vdoStatsStorage.journal.entriesPerCommit[i]);
+  }
+  retval += sprintf(buf + retval, "\n");
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsJournalEntriesPerCommitAttr = {
+  .attr  = { .name = "journal_entries_per_commit", .mode = 0444, },
+  .show  = poolStatsJournalEntriesPerCommitShow,
+};
+
+/**********************************************************************/
+/** Commits by latency; bucket i counts [2^i, 2^(i+1)) microseconds */
+static ssize_t poolStatsJournalCommitLatencyShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval = 0;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  for (unsigned int i = 0; i < JOURNAL_HISTOGRAM_BUCKETS; i++) {
+    retval += sprintf(buf + retval, "%s%" PRIu64, ((i == 0) ? "" : " "),
+                      layer->vdoStatsStorage.journal.commitLatency[i]);
+  }
+  retval += sprintf(buf + retval, "\n");
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsJournalCommitLatencyAttr = {
+  .attr  = { .name = "journal_commit_latency", .mode = 0444, },
+  .show  = poolStatsJournalCommitLatencyShow,
+};
+
+/**********************************************************************/
+/** Number of journal entries replayed into slab journals */
+static ssize_t poolStatsRecoverySlabJournalEntriesShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.recovery.slabJournalEntries);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRecoverySlabJournalEntriesAttr = {
+  .attr  = { .name = "recovery_slab_journal_entries", .mode = 0444, },
+  .show  = poolStatsRecoverySlabJournalEntriesShow,
+};
+
+/**********************************************************************/
+/** Microseconds spent replaying entries into slab journals */
+static ssize_t poolStatsRecoverySlabJournalTimeShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.recovery.slabJournalTime);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRecoverySlabJournalTimeAttr = {
+  .attr  = { .name = "recovery_slab_journal_usec", .mode = 0444, },
+  .show  = poolStatsRecoverySlabJournalTimeShow,
+};
+
+/**********************************************************************/
+/** Number of journal entries replayed into the block map */
+static ssize_t poolStatsRecoveryBlockMapEntriesShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.recovery.blockMapEntries);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRecoveryBlockMapEntriesAttr = {
+  .attr  = { .name = "recovery_block_map_entries", .mode = 0444, },
+  .show  = poolStatsRecoveryBlockMapEntriesShow,
+};
+
+/**********************************************************************/
+/** Microseconds spent replaying entries into the block map */
+static ssize_t poolStatsRecoveryBlockMapTimeShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.recovery.blockMapTime);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRecoveryBlockMapTimeAttr = {
+  .attr  = { .name = "recovery_block_map_usec", .mode = 0444, },
+  .show  = poolStatsRecoveryBlockMapTimeShow,
+};
+
+/**********************************************************************/
+/** The number of slabs which are unrecovered or being scrubbed */
+static ssize_t poolStatsScrubbingSlabsRemainingShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.scrubbing.slabsRemaining);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsScrubbingSlabsRemainingAttr = {
+  .attr  = { .name = "scrubbing_slabs_remaining", .mode = 0444, },
+  .show  = poolStatsScrubbingSlabsRemainingShow,
+};
+
+/**********************************************************************/
+/** The number of slabs being scrubbed right now */
+static ssize_t poolStatsScrubbingSlabsInProgressShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.scrubbing.slabsInProgress);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsScrubbingSlabsInProgressAttr = {
+  .attr  = { .name = "scrubbing_slabs_in_progress", .mode = 0444, },
+  .show  = poolStatsScrubbingSlabsInProgressShow,
+};
+
+/**********************************************************************/
+/** The number of slabs scrubbed since the VDO was loaded */
+static ssize_t poolStatsScrubbingSlabsScrubbedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.scrubbing.slabsScrubbed);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsScrubbingSlabsScrubbedAttr = {
+  .attr  = { .name = "scrubbing_slabs_scrubbed", .mode = 0444, },
+  .show  = poolStatsScrubbingSlabsScrubbedShow,
+};
+
+/**********************************************************************/
+/** The average scrubbing rate since scrubbing started, in slabs per minute */
+static ssize_t poolStatsScrubbingSlabsPerMinuteShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.scrubbing.slabsPerMinute);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsScrubbingSlabsPerMinuteAttr = {
+  .attr  = { .name = "scrubbing_slabs_per_minute", .mode = 0444, },
+  .show  = poolStatsScrubbingSlabsPerMinuteShow,
+};
+
+/**********************************************************************/
+/** The estimated time until every slab is scrubbed, in seconds */
+static ssize_t poolStatsScrubbingSecondsRemainingShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.scrubbing.secondsRemaining);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsScrubbingSecondsRemainingAttr = {
+  .attr  = { .name = "scrubbing_seconds_remaining", .mode = 0444, },
+  .show  = poolStatsScrubbingSecondsRemainingShow,
+};
+
 /**********************************************************************/
 /** Number of times the on-disk journal was full */
 static ssize_t poolStatsSlabJournalDiskFullCountShow(KernelLayer *layer, char *buf)
@@ -593,6 +890,91 @@ static PoolStatsAttribute poolStatsSlabJournalTailBusyCountAttr = {
   .show  = poolStatsSlabJournalTailBusyCountShow,
 };
 
+/**********************************************************************/
+/** Number of batches of reference count updates applied */
+static ssize_t poolStatsSlabJournalUpdateBatchesShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabJournal.updateBatches);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabJournalUpdateBatchesAttr = {
+  .attr  = { .name = "slab_journal_update_batches", .mode = 0444, },
+  .show  = poolStatsSlabJournalUpdateBatchesShow,
+};
+
+/**********************************************************************/
+/** Number of reference count updates applied in those batches */
+static ssize_t poolStatsSlabJournalUpdatesAppliedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabJournal.updatesApplied);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabJournalUpdatesAppliedAttr = {
+  .attr  = { .name = "slab_journal_updates_applied", .mode = 0444, },
+  .show  = poolStatsSlabJournalUpdatesAppliedShow,
+};
+
+/**********************************************************************/
+/** Time spent applying those updates, in nanoseconds */
+static ssize_t poolStatsSlabJournalUpdateNanosecondsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabJournal.updateNanoseconds);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabJournalUpdateNanosecondsAttr = {
+  .attr  = { .name = "slab_journal_update_nanoseconds", .mode = 0444, },
+  .show  = poolStatsSlabJournalUpdateNanosecondsShow,
+};
+
+/**********************************************************************/
+/** Average number of reference count updates per batch */
+static ssize_t poolStatsSlabJournalUpdatesPerBatchShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabJournal.updatesPerBatch);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabJournalUpdatesPerBatchAttr = {
+  .attr  = { .name = "slab_journal_updates_per_batch", .mode = 0444, },
+  .show  = poolStatsSlabJournalUpdatesPerBatchShow,
+};
+
+/**********************************************************************/
+/** Average time to apply a reference count update, in nanoseconds */
+static ssize_t poolStatsSlabJournalNanosecondsPerUpdateShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabJournal.nanosecondsPerUpdate);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabJournalNanosecondsPerUpdateAttr = {
+  .attr  = { .name = "slab_journal_nanoseconds_per_update", .mode = 0444, },
+  .show  = poolStatsSlabJournalNanosecondsPerUpdateShow,
+};
+
 /**********************************************************************/
 /** Number of blocks written */
 static ssize_t poolStatsSlabSummaryBlocksWrittenShow(KernelLayer *layer, char *buf)
@@ -610,6 +992,40 @@ static PoolStatsAttribute poolStatsSlabSummaryBlocksWrittenAttr = {
   .show  = poolStatsSlabSummaryBlocksWrittenShow,
 };
 
+/**********************************************************************/
+/** Number of entry updates made */
+static ssize_t poolStatsSlabSummaryEntryUpdatesShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabSummary.entryUpdates);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabSummaryEntryUpdatesAttr = {
+  .attr  = { .name = "slab_summary_entry_updates", .mode = 0444, },
+  .show  = poolStatsSlabSummaryEntryUpdatesShow,
+};
+
+/**********************************************************************/
+/** Number of entry updates which shared a block write with another */
+static ssize_t poolStatsSlabSummaryUpdatesCoalescedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.slabSummary.updatesCoalesced);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsSlabSummaryUpdatesCoalescedAttr = {
+  .attr  = { .name = "slab_summary_updates_coalesced", .mode = 0444, },
+  .show  = poolStatsSlabSummaryUpdatesCoalescedShow,
+};
+
 /**********************************************************************/
 /** Number of reference blocks written */
 static ssize_t poolStatsRefCountsBlocksWrittenShow(KernelLayer *layer, char *buf)
@@ -627,6 +1043,74 @@ static PoolStatsAttribute poolStatsRefCountsBlocksWrittenAttr = {
   .show  = poolStatsRefCountsBlocksWrittenShow,
 };
 
+/**********************************************************************/
+/** Number of slabs whose counters are currently compact */
+static ssize_t poolStatsRefCountsCompactSlabsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.refCounts.compactSlabs);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRefCountsCompactSlabsAttr = {
+  .attr  = { .name = "ref_counts_compact_slabs", .mode = 0444, },
+  .show  = poolStatsRefCountsCompactSlabsShow,
+};
+
+/**********************************************************************/
+/** Bytes of counter memory currently released by compaction */
+static ssize_t poolStatsRefCountsMemorySavedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.refCounts.memorySaved);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRefCountsMemorySavedAttr = {
+  .attr  = { .name = "ref_counts_memory_saved", .mode = 0444, },
+  .show  = poolStatsRefCountsMemorySavedShow,
+};
+
+/**********************************************************************/
+/** Number of times compact counters have been expanded */
+static ssize_t poolStatsRefCountsSlabsExpandedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.refCounts.slabsExpanded);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRefCountsSlabsExpandedAttr = {
+  .attr  = { .name = "ref_counts_slabs_expanded", .mode = 0444, },
+  .show  = poolStatsRefCountsSlabsExpandedShow,
+};
+
+/**********************************************************************/
+/** Number of runs of adjacent reference blocks written together */
+static ssize_t poolStatsRefCountsWriteRunsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.refCounts.writeRuns);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsRefCountsWriteRunsAttr = {
+  .attr  = { .name = "ref_counts_write_runs", .mode = 0444, },
+  .show  = poolStatsRefCountsWriteRunsShow,
+};
+
 /**********************************************************************/
 /** number of dirty (resident) pages */
 static ssize_t poolStatsBlockMapDirtyPagesShow(KernelLayer *layer, char *buf)
@@ -865,6 +1349,74 @@ static PoolStatsAttribute poolStatsBlockMapFoundInCacheAttr = {
   .show  = poolStatsBlockMapFoundInCacheShow,
 };
 
+/**********************************************************************/
+/** number of fetches of pages recently evicted from probation */
+static ssize_t poolStatsBlockMapGhostHitsShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.ghostHits);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapGhostHitsAttr = {
+  .attr  = { .name = "block_map_ghost_hits", .mode = 0444, },
+  .show  = poolStatsBlockMapGhostHitsShow,
+};
+
+/**********************************************************************/
+/** number of leaf page prefetches issued */
+static ssize_t poolStatsBlockMapPrefetchIssuedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.prefetchIssued);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapPrefetchIssuedAttr = {
+  .attr  = { .name = "block_map_prefetch_issued", .mode = 0444, },
+  .show  = poolStatsBlockMapPrefetchIssuedShow,
+};
+
+/**********************************************************************/
+/** number of prefetched pages which were later requested */
+static ssize_t poolStatsBlockMapPrefetchUsedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.prefetchUsed);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapPrefetchUsedAttr = {
+  .attr  = { .name = "block_map_prefetch_used", .mode = 0444, },
+  .show  = poolStatsBlockMapPrefetchUsedShow,
+};
+
+/**********************************************************************/
+/** number of prefetched pages discarded without being requested */
+static ssize_t poolStatsBlockMapPrefetchWastedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.prefetchWasted);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapPrefetchWastedAttr = {
+  .attr  = { .name = "block_map_prefetch_wasted", .mode = 0444, },
+  .show  = poolStatsBlockMapPrefetchWastedShow,
+};
+
 /**********************************************************************/
 /** number of gets requiring discard */
 static ssize_t poolStatsBlockMapDiscardRequiredShow(KernelLayer *layer, char *buf)
@@ -967,6 +1519,57 @@ static PoolStatsAttribute poolStatsBlockMapFlushCountAttr = {
   .show  = poolStatsBlockMapFlushCountShow,
 };
 
+/**********************************************************************/
+/** number of pages written early by background writeback */
+static ssize_t poolStatsBlockMapWritebackPagesShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.writebackPages);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapWritebackPagesAttr = {
+  .attr  = { .name = "block_map_writeback_pages", .mode = 0444, },
+  .show  = poolStatsBlockMapWritebackPagesShow,
+};
+
+/**********************************************************************/
+/** the current limit on background writes in flight */
+static ssize_t poolStatsBlockMapWritebackLimitShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.writebackLimit);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapWritebackLimitAttr = {
+  .attr  = { .name = "block_map_writeback_limit", .mode = 0444, },
+  .show  = poolStatsBlockMapWritebackLimitShow,
+};
+
+/**********************************************************************/
+/** the most pages written in a single batch */
+static ssize_t poolStatsBlockMapLargestWriteBatchShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKVDOStatistics(&layer->kvdo, &layer->vdoStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->vdoStatsStorage.blockMap.largestWriteBatch);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsBlockMapLargestWriteBatchAttr = {
+  .attr  = { .name = "block_map_largest_write_batch", .mode = 0444, },
+  .show  = poolStatsBlockMapLargestWriteBatchShow,
+};
+
 /**********************************************************************/
 /** Number of times the UDS advice proved correct */
 static ssize_t poolStatsHashLockDedupeAdviceValidShow(KernelLayer *layer, char *buf)
@@ -2361,6 +2964,40 @@ static PoolStatsAttribute poolStatsMemoryUsagePeakBioCountAttr = {
   .show  = poolStatsMemoryUsagePeakBioCountShow,
 };
 
+/**********************************************************************/
+/** Bytes of large regions in physically contiguous, huge-mapped memory. */
+static ssize_t poolStatsMemoryUsageContiguousBytesUsedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKernelStats(layer, &layer->kernelStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->kernelStatsStorage.memoryUsage.contiguousBytesUsed);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsMemoryUsageContiguousBytesUsedAttr = {
+  .attr  = { .name = "memory_usage_contiguous_bytes_used", .mode = 0444, },
+  .show  = poolStatsMemoryUsageContiguousBytesUsedShow,
+};
+
+/**********************************************************************/
+/** Bytes of large regions which fell back to page-mapped memory. */
+static ssize_t poolStatsMemoryUsageFallbackBytesUsedShow(KernelLayer *layer, char *buf)
+{
+  ssize_t retval;
+  mutex_lock(&layer->statsMutex);
+  getKernelStats(layer, &layer->kernelStatsStorage);
+  retval = sprintf(buf, "%" PRIu64 "\n", layer->kernelStatsStorage.memoryUsage.fallbackBytesUsed);
+  mutex_unlock(&layer->statsMutex);
+  return retval;
+}
+
+static PoolStatsAttribute poolStatsMemoryUsageFallbackBytesUsedAttr = {
+  .attr  = { .name = "memory_usage_fallback_bytes_used", .mode = 0444, },
+  .show  = poolStatsMemoryUsageFallbackBytesUsedShow,
+};
+
 /**********************************************************************/
 /** Number of chunk names stored in the index */
 static ssize_t poolStatsIndexEntriesIndexedShow(KernelLayer *layer, char *buf)
@@ -2534,6 +3171,8 @@ struct attribute *poolStatsAttrs[] = {
   &poolStatsAllocatorSlabCountAttr.attr,
   &poolStatsAllocatorSlabsOpenedAttr.attr,
   &poolStatsAllocatorSlabsReopenedAttr.attr,
+  &poolStatsAllocatorSequentialAllocationsAttr.attr,
+  &poolStatsAllocatorContiguousAllocationsAttr.attr,
   &poolStatsJournalDiskFullAttr.attr,
   &poolStatsJournalSlabJournalCommitsRequestedAttr.attr,
   &poolStatsJournalEntriesStartedAttr.attr,
@@ -2542,13 +3181,39 @@ struct attribute *poolStatsAttrs[] = {
   &poolStatsJournalBlocksStartedAttr.attr,
   &poolStatsJournalBlocksWrittenAttr.attr,
   &poolStatsJournalBlocksCommittedAttr.attr,
+  &poolStatsJournalGroupCommitsAttr.attr,
+  &poolStatsJournalEntriesElidedAttr.attr,
+  &poolStatsJournalReapsAttr.attr,
+  &poolStatsJournalReapFlushesAttr.attr,
+  &poolStatsJournalEntriesPerCommitAttr.attr,
+  &poolStatsJournalCommitLatencyAttr.attr,
+  &poolStatsRecoverySlabJournalEntriesAttr.attr,
+  &poolStatsRecoverySlabJournalTimeAttr.attr,
+  &poolStatsRecoveryBlockMapEntriesAttr.attr,
+  &poolStatsRecoveryBlockMapTimeAttr.attr,
+  &poolStatsScrubbingSlabsRemainingAttr.attr,
+  &poolStatsScrubbingSlabsInProgressAttr.attr,
+  &poolStatsScrubbingSlabsScrubbedAttr.attr,
+  &poolStatsScrubbingSlabsPerMinuteAttr.attr,
+  &poolStatsScrubbingSecondsRemainingAttr.attr,
   &poolStatsSlabJournalDiskFullCountAttr.attr,
   &poolStatsSlabJournalFlushCountAttr.attr,
   &poolStatsSlabJournalBlockedCountAttr.attr,
   &poolStatsSlabJournalBlocksWrittenAttr.attr,
   &poolStatsSlabJournalTailBusyCountAttr.attr,
+  &poolStatsSlabJournalUpdateBatchesAttr.attr,
+  &poolStatsSlabJournalUpdatesAppliedAttr.attr,
+  &poolStatsSlabJournalUpdateNanosecondsAttr.attr,
+  &poolStatsSlabJournalUpdatesPerBatchAttr.attr,
+  &poolStatsSlabJournalNanosecondsPerUpdateAttr.attr,
   &poolStatsSlabSummaryBlocksWrittenAttr.attr,
+  &poolStatsSlabSummaryEntryUpdatesAttr.attr,
+  &poolStatsSlabSummaryUpdatesCoalescedAttr.attr,
   &poolStatsRefCountsBlocksWrittenAttr.attr,
+  &poolStatsRefCountsCompactSlabsAttr.attr,
+  &poolStatsRefCountsMemorySavedAttr.attr,
+  &poolStatsRefCountsSlabsExpandedAttr.attr,
+  &poolStatsRefCountsWriteRunsAttr.attr,
   &poolStatsBlockMapDirtyPagesAttr.attr,
   &poolStatsBlockMapCleanPagesAttr.attr,
   &poolStatsBlockMapFreePagesAttr.attr,
@@ -2563,12 +3228,19 @@ struct attribute *poolStatsAttrs[] = {
   &poolStatsBlockMapReclaimedAttr.attr,
   &poolStatsBlockMapReadOutgoingAttr.attr,
   &poolStatsBlockMapFoundInCacheAttr.attr,
+  &poolStatsBlockMapGhostHitsAttr.attr,
+  &poolStatsBlockMapPrefetchIssuedAttr.attr,
+  &poolStatsBlockMapPrefetchUsedAttr.attr,
+  &poolStatsBlockMapPrefetchWastedAttr.attr,
   &poolStatsBlockMapDiscardRequiredAttr.attr,
   &poolStatsBlockMapWaitForPageAttr.attr,
   &poolStatsBlockMapFetchRequiredAttr.attr,
   &poolStatsBlockMapPagesLoadedAttr.attr,
   &poolStatsBlockMapPagesSavedAttr.attr,
   &poolStatsBlockMapFlushCountAttr.attr,
+  &poolStatsBlockMapWritebackPagesAttr.attr,
+  &poolStatsBlockMapWritebackLimitAttr.attr,
+  &poolStatsBlockMapLargestWriteBatchAttr.attr,
   &poolStatsHashLockDedupeAdviceValidAttr.attr,
   &poolStatsHashLockDedupeAdviceStaleAttr.attr,
   &poolStatsHashLockConcurrentDataMatchesAttr.attr,
@@ -2651,6 +3323,8 @@ struct attribute *poolStatsAttrs[] = {
   &poolStatsMemoryUsagePeakBytesUsedAttr.attr,
   &poolStatsMemoryUsageBiosUsedAttr.attr,
   &poolStatsMemoryUsagePeakBioCountAttr.attr,
+  &poolStatsMemoryUsageContiguousBytesUsedAttr.attr,
+  &poolStatsMemoryUsageFallbackBytesUsedAttr.attr,
   &poolStatsIndexEntriesIndexedAttr.attr,
   &poolStatsIndexPostsFoundAttr.attr,
   &poolStatsIndexPostsNotFoundAttr.attr,
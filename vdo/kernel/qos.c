@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA. 
+ */
+
+#include "qos.h"
+
+#include <linux/bio.h>
+#include <linux/ioprio.h>
+
+#include "statusCodes.h"
+
+static const char *QOS_CLASS_NAMES[QOS_CLASS_COUNT] = {
+  "bulk",
+  "normal",
+  "high",
+};
+
+static const char *READ_HISTOGRAM_NAMES[QOS_CLASS_COUNT] = {
+  "read_latency_bulk",
+  "read_latency_normal",
+  "read_latency_high",
+};
+
+static const char *READ_HISTOGRAM_LABELS[QOS_CLASS_COUNT] = {
+  "Bulk Read Latency",
+  "Normal Read Latency",
+  "High Priority Read Latency",
+};
+
+static const char *WRITE_HISTOGRAM_NAMES[QOS_CLASS_COUNT] = {
+  "write_latency_bulk",
+  "write_latency_normal",
+  "write_latency_high",
+};
+
+static const char *WRITE_HISTOGRAM_LABELS[QOS_CLASS_COUNT] = {
+  "Bulk Write Latency",
+  "Normal Write Latency",
+  "High Priority Write Latency",
+};
+
+/**********************************************************************/
+QoSClass getBioQoSClass(BIO *bio, QoSClass defaultClass)
+{
+  switch (IOPRIO_PRIO_CLASS(bio_prio(bio))) {
+  case IOPRIO_CLASS_RT:
+    return QOS_CLASS_HIGH;
+
+  case IOPRIO_CLASS_BE:
+    return QOS_CLASS_NORMAL;
+
+  case IOPRIO_CLASS_IDLE:
+    return QOS_CLASS_BULK;
+
+  default:
+    return defaultClass;
+  }
+}
+
+/**********************************************************************/
+const char *getQoSClassName(QoSClass qosClass)
+{
+  return QOS_CLASS_NAMES[qosClass];
+}
+
+/**********************************************************************/
+int makeQoSLatencyHistograms(struct kobject       *parent,
+                             QoSLatencyHistograms *histograms)
+{
+  for (QoSClass qosClass = 0; qosClass < QOS_CLASS_COUNT; qosClass++) {
+    histograms->read[qosClass]
+      = makeLogarithmicHistogram(parent, READ_HISTOGRAM_NAMES[qosClass],
+                                 READ_HISTOGRAM_LABELS[qosClass], "reads",
+                                 "latency", "microseconds", 7);
+    if (histograms->read[qosClass] == NULL) {
+      return -ENOMEM;
+    }
+
+    histograms->write[qosClass]
+      = makeLogarithmicHistogram(parent, WRITE_HISTOGRAM_NAMES[qosClass],
+                                 WRITE_HISTOGRAM_LABELS[qosClass], "writes",
+                                 "latency", "microseconds", 7);
+    if (histograms->write[qosClass] == NULL) {
+      return -ENOMEM;
+    }
+  }
+
+  return VDO_SUCCESS;
+}
+
+/**********************************************************************/
+void freeQoSLatencyHistograms(QoSLatencyHistograms *histograms)
+{
+  for (QoSClass qosClass = 0; qosClass < QOS_CLASS_COUNT; qosClass++) {
+    freeHistogram(&histograms->read[qosClass]);
+    freeHistogram(&histograms->write[qosClass]);
+  }
+}
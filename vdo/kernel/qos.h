@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2018 Red Hat, Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA. 
+ */
+
+#ifndef QOS_H
+#define QOS_H
+
+#include <linux/kobject.h>
+
+#include "histogram.h"
+#include "kernelTypes.h"
+
+/**
+ * The quality-of-service classes for user I/O. A bio's class determines the
+ * priority at which its DataKVIO is processed in each work queue, whether the
+ * bio competes for the reduced pool of request permits reserved for bulk
+ * traffic, and which latency histogram records its completion. High priority
+ * writes are never compressed, so that they do not wait in a packer bin for
+ * other fragments to arrive.
+ *
+ * The numeric values are those accepted by the "qosClass" optional table
+ * parameter, which sets the class of bios which carry no I/O priority.
+ **/
+typedef enum {
+  /** Background traffic (e.g. IOPRIO_CLASS_IDLE) */
+  QOS_CLASS_BULK = 0,
+  /** Ordinary traffic (e.g. IOPRIO_CLASS_BE) */
+  QOS_CLASS_NORMAL,
+  /** Latency-sensitive traffic (e.g. IOPRIO_CLASS_RT) */
+  QOS_CLASS_HIGH,
+  QOS_CLASS_COUNT,
+} QoSClass;
+
+/** Per-class histograms of user I/O latency, measured from admission. */
+typedef struct {
+  Histogram *read[QOS_CLASS_COUNT];
+  Histogram *write[QOS_CLASS_COUNT];
+} QoSLatencyHistograms;
+
+/**
+ * Determine the QoS class of a bio from its I/O priority.
+ *
+ * @param bio           The bio
+ * @param defaultClass  The class to use if the bio has no I/O priority
+ *
+ * @return The class of the bio
+ **/
+QoSClass getBioQoSClass(BIO *bio, QoSClass defaultClass)
+  __attribute__((warn_unused_result));
+
+/**
+ * Get the name of a QoS class.
+ *
+ * @param qosClass  The class
+ *
+ * @return The name of the class
+ **/
+const char *getQoSClassName(QoSClass qosClass)
+  __attribute__((warn_unused_result));
+
+/**
+ * Create the per-class latency histograms.
+ *
+ * @param parent      The sysfs node under which to place the histograms
+ * @param histograms  The histograms to initialize
+ *
+ * @return VDO_SUCCESS or an error
+ **/
+int makeQoSLatencyHistograms(struct kobject       *parent,
+                             QoSLatencyHistograms *histograms)
+  __attribute__((warn_unused_result));
+
+/**
+ * Free the per-class latency histograms.
+ *
+ * @param histograms  The histograms to free
+ **/
+void freeQoSLatencyHistograms(QoSLatencyHistograms *histograms);
+
+/**
+ * Record the latency of a completed user I/O.
+ *
+ * @param histograms  The latency histograms
+ * @param qosClass    The class of the I/O
+ * @param isRead      Whether the I/O was a read
+ * @param latency     The latency of the I/O, in microseconds
+ **/
+static inline void recordQoSLatency(QoSLatencyHistograms *histograms,
+                                    QoSClass              qosClass,
+                                    bool                  isRead,
+                                    uint64_t              latency)
+{
+  enterHistogramSample((isRead
+                        ? histograms->read[qosClass]
+                        : histograms->write[qosClass]), latency);
+}
+
+#endif // QOS_H
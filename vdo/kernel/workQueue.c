@@ -23,6 +23,7 @@
 
 #include <linux/delay.h>
 #include <linux/kthread.h>
+#include <linux/topology.h>
 #include <linux/version.h>
 
 #include "atomic.h"
@@ -932,6 +933,35 @@ void finishWorkQueue(KvdoWorkQueue *queue)
   }
 }
 
+/**
+ * Restrict the thread of a simple work queue to the CPUs of a NUMA node.
+ *
+ * @param queue  The work queue
+ * @param node   The NUMA node
+ **/
+static void bindSimpleWorkQueueToNode(SimpleWorkQueue *queue, int node)
+{
+  int result = set_cpus_allowed_ptr(queue->thread, cpumask_of_node(node));
+  if (result != 0) {
+    logWarning("Cannot bind work queue %s to NUMA node %d: %d",
+               queue->common.name, node, result);
+  }
+}
+
+/**********************************************************************/
+void bindWorkQueueToNode(KvdoWorkQueue *queue, int node)
+{
+  if (!queue->roundRobinMode) {
+    bindSimpleWorkQueueToNode(asSimpleWorkQueue(queue), node);
+    return;
+  }
+
+  RoundRobinWorkQueue *roundRobinQueue = asRoundRobinWorkQueue(queue);
+  for (unsigned int i = 0; i < roundRobinQueue->numServiceQueues; i++) {
+    bindSimpleWorkQueueToNode(roundRobinQueue->serviceQueues[i], node);
+  }
+}
+
 /**
  * Tear down a simple work queue, and decrement the kobject reference
  * count on it.
@@ -222,6 +222,14 @@ void enqueueWorkQueueDelayed(KvdoWorkQueue *queue,
  **/
 void finishWorkQueue(KvdoWorkQueue *queue);
 
+/**
+ * Restrict the threads of a work queue to the CPUs of a NUMA node.
+ *
+ * @param queue  The work queue
+ * @param node   The NUMA node
+ **/
+void bindWorkQueueToNode(KvdoWorkQueue *queue, int node);
+
 /**
  * Free a work queue and null out the reference to it.
  *